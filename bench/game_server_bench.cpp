@@ -0,0 +1,218 @@
+// Headless benchmark of the game tick: fills a map with N dogs and M loot items, runs
+// Game::UpdateTime and reports the time and the heap allocations per tick for every N.
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../src/alloc_counter.h"
+#include "../src/fast_random.h"
+#include "../src/json_loader.h"
+#include "../src/map_generator.h"
+#include "../src/model.h"
+
+using namespace std::literals;
+
+namespace {
+
+struct BenchArgs {
+    std::string config_file_path;
+    std::string map_id;
+    std::vector<size_t> dogs_counts;
+    size_t loot_count = 1000;
+    int ticks = 200;
+    int warmup_ticks = 50;
+    double tick_period = 50.;
+    // share of dogs changing their direction every tick
+    double move_share = 0.05;
+    unsigned tick_threads = 0;
+    size_t parallel_session_players = 0;
+    bool kinetic_events = false;
+    uint64_t seed = 1;
+    // generated map, used without a config
+    std::string layout = "grid"s;
+    int map_size = 320;
+    int block_size = 10;
+};
+
+std::vector<size_t> ParseCounts(const std::string& list) {
+    std::vector<size_t> counts;
+    std::istringstream stream{list};
+    std::string count;
+    while (std::getline(stream, count, ',')) {
+        counts.push_back(std::stoul(count));
+    }
+    if (counts.empty()) {
+        throw std::runtime_error("No dog counts given"s);
+    }
+    return counts;
+}
+
+[[nodiscard]] std::optional<BenchArgs> ParseCommandLine(int argc, const char* const argv[]) {
+    namespace po = boost::program_options;
+
+    po::options_description desc{"Allowed options"s};
+
+    BenchArgs args;
+    std::string dogs = "100,1000,10000"s;
+    desc.add_options()
+        ("help,h", "produce help message")
+        ("config-file,c", po::value(&args.config_file_path)->value_name("file"s), "take the map from the config instead of a generated one")
+        ("map", po::value(&args.map_id)->value_name("id"s), "map of the config, the first one by default")
+        ("layout,l", po::value(&args.layout)->value_name("layout"s), "layout of the generated map: grid, streets or city")
+        ("map-size", po::value(&args.map_size)->value_name("units"s), "side of the generated map")
+        ("block-size", po::value(&args.block_size)->value_name("units"s), "block size of the generated map")
+        ("dogs,n", po::value(&dogs)->value_name("list"s), "comma separated numbers of dogs, one run per number")
+        ("loot,m", po::value(&args.loot_count)->value_name("items"s), "loot items put on the map before the run")
+        ("ticks", po::value(&args.ticks)->value_name("ticks"s), "measured ticks per run")
+        ("warmup-ticks", po::value(&args.warmup_ticks)->value_name("ticks"s), "ticks made before the measurement")
+        ("tick-period,t", po::value(&args.tick_period)->value_name("milliseconds"s), "game time of a tick")
+        ("move-share", po::value(&args.move_share)->value_name("share"s), "share of dogs turning every tick")
+        ("tick-threads", po::value(&args.tick_threads)->value_name("threads"s), "update game sessions in parallel on the given number of threads")
+        ("parallel-session-players", po::value(&args.parallel_session_players)->value_name("players"s), "split sessions with at least the given number of players between the tick threads")
+        ("kinetic-events", "move dogs by predicted events instead of every tick")
+        ("seed", po::value(&args.seed)->value_name("seed"s), "random seed of the game and the moves");
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.contains("help"s)) {
+        std::cout << desc;
+        return std::nullopt;
+    }
+    if (vm.contains("kinetic-events"s)) {
+        args.kinetic_events = true;
+    }
+    args.dogs_counts = ParseCounts(dogs);
+    return args;
+}
+
+model::Game MakeGeneratedGame(const BenchArgs& args) {
+    map_gen::MapOptions map;
+    map.layout = map_gen::ParseLayout(args.layout);
+    map.width = args.map_size;
+    map.height = args.map_size;
+    map.block_size = args.block_size;
+    map.streets_count = static_cast<size_t>(args.map_size / args.block_size) * 20;
+    map.seed = args.seed;
+    return json_loader::LoadGameFromJson(map_gen::MakeConfigJson({map}));
+}
+
+struct RunResult {
+    size_t dogs = 0;
+    size_t sessions = 0;
+    double ns_per_tick = 0.;
+    double allocations_per_tick = 0.;
+};
+
+RunResult Run(const BenchArgs& args, size_t dogs_count) {
+    model::Game game = args.config_file_path.empty() ? MakeGeneratedGame(args)
+                                                     : json_loader::LoadGame(args.config_file_path);
+    game.SetRandomSeed(args.seed);
+    game.SetPlayersStartPointRandomizing(true);
+    game.SetTickThreads(args.tick_threads);
+    game.SetParallelSessionSize(args.parallel_session_players);
+    game.SetKineticMode(args.kinetic_events);
+
+    const model::Map* map = args.map_id.empty() ? &game.GetMaps().front() : game.FindMap(model::Map::Id{args.map_id});
+    if (!map) {
+        throw std::runtime_error("Map "s + args.map_id + " is not in the config"s);
+    }
+
+    std::vector<std::shared_ptr<app::Player>> players;
+    players.reserve(dogs_count);
+    for (size_t i = 0; i < dogs_count; ++i) {
+        players.push_back(game.JoinGame("dog"s + std::to_string(i), map));
+    }
+
+    // loot is shared between the sessions of the map
+    util::FastRandom random{args.seed};
+    auto sessions = game.RetrieveLootForBackup();
+    int loot_id = 0;
+    for (auto& [session_id, loot] : sessions) {
+        const size_t session_loot = args.loot_count / sessions.size();
+        for (size_t i = 0; i < session_loot; ++i, ++loot_id) {
+            const int type = map->GetRandomLootType(random);
+            loot[loot_id] = model::LostObject{model::Item{loot_id, type, map->GetLootValue(type)},
+                                              map->GetRandomRoadPoint(random)};
+        }
+    }
+    game.RestoreLootForAllSessions(sessions);
+
+    const char* directions[] = {"U", "D", "L", "R"};
+    auto make_moves = [&] {
+        for (auto& player : players) {
+            if (random.NextDouble() < args.move_share) {
+                player->Move(directions[random.NextIndex(4)]);
+            }
+        }
+    };
+
+    for (int i = 0; i < args.warmup_ticks; ++i) {
+        make_moves();
+        game.UpdateTime(args.tick_period);
+    }
+
+    // only the ticks are measured, not the moves between them
+    std::chrono::nanoseconds tick_time{};
+    size_t allocations = 0;
+    for (int i = 0; i < args.ticks; ++i) {
+        make_moves();
+        util::StartCountingAllocations();
+        const auto start = std::chrono::steady_clock::now();
+        game.UpdateTime(args.tick_period);
+        tick_time += std::chrono::steady_clock::now() - start;
+        allocations += util::StopCountingAllocations();
+    }
+
+    RunResult result;
+    result.dogs = dogs_count;
+    result.sessions = sessions.size();
+    result.ns_per_tick = static_cast<double>(tick_time.count()) / args.ticks;
+    result.allocations_per_tick = static_cast<double>(allocations) / args.ticks;
+    return result;
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+    try {
+        auto args = ParseCommandLine(argc, argv);
+        if (!args) {
+            return EXIT_SUCCESS;
+        }
+
+        std::cout << std::setw(10) << "dogs"s << std::setw(10) << "sessions"s << std::setw(16) << "ns/tick"s
+                  << std::setw(14) << "ns/dog"s << std::setw(14) << "allocs/tick"s << std::setw(10) << "scaling"s << '\n';
+        std::optional<RunResult> previous;
+        for (size_t dogs_count : args->dogs_counts) {
+            const RunResult result = Run(*args, dogs_count);
+            std::cout << std::setw(10) << result.dogs << std::setw(10) << result.sessions << std::fixed
+                      << std::setprecision(0) << std::setw(16) << result.ns_per_tick << std::setprecision(1)
+                      << std::setw(14) << result.ns_per_tick / std::max<size_t>(result.dogs, 1) << std::setw(14)
+                      << result.allocations_per_tick;
+            // growth of the tick time against the growth of the number of dogs, 1 is linear
+            if (previous && previous->ns_per_tick > 0. && previous->dogs > 0) {
+                std::cout << std::setprecision(2) << std::setw(10)
+                          << std::log(result.ns_per_tick / previous->ns_per_tick) /
+                                 std::log(static_cast<double>(result.dogs) / previous->dogs);
+            }
+            std::cout << std::endl;
+            previous = result;
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,55 @@
+#include "alias_table.h"
+
+#include <numeric>
+#include <stdexcept>
+
+namespace util {
+
+using namespace std::literals;
+
+AliasTable::AliasTable(const std::vector<double>& weights)
+    : probability_(weights.size(), 1.)
+    , alias_(weights.size()) {
+    double total = 0.;
+    for (double weight : weights) {
+        if (weight < 0.) {
+            throw std::invalid_argument("Alias table weights must be non-negative"s);
+        }
+        total += weight;
+    }
+    std::iota(alias_.begin(), alias_.end(), 0u);
+    if (total == 0.) {
+        return;
+    }
+
+    // columns are filled up to the mean weight, a small column takes the rest from a large one
+    const double count = static_cast<double>(weights.size());
+    std::vector<double> scaled(weights.size());
+    std::vector<uint32_t> small;
+    std::vector<uint32_t> large;
+    for (uint32_t i = 0; i < weights.size(); ++i) {
+        scaled[i] = weights[i] * count / total;
+        (scaled[i] < 1. ? small : large).push_back(i);
+    }
+    while (!small.empty() && !large.empty()) {
+        const uint32_t less = small.back();
+        small.pop_back();
+        const uint32_t more = large.back();
+        probability_[less] = scaled[less];
+        alias_[less] = more;
+        scaled[more] -= 1. - scaled[less];
+        if (scaled[more] < 1.) {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+    // what is left is full up to rounding errors
+    for (uint32_t i : small) {
+        probability_[i] = 1.;
+    }
+    for (uint32_t i : large) {
+        probability_[i] = 1.;
+    }
+}
+
+}  // namespace util
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace util {
+
+// Walker's alias table: picks an index with the probability proportional to its weight
+// in O(1) from a single uniform number. Building the table is O(n).
+class AliasTable {
+public:
+    AliasTable() = default;
+    // weights must be non-negative; if all of them are zero, the indices are equally likely
+    explicit AliasTable(const std::vector<double>& weights);
+
+    bool Empty() const noexcept {
+        return probability_.empty();
+    }
+
+    size_t Size() const noexcept {
+        return probability_.size();
+    }
+
+    // uniform is in [0, 1)
+    size_t Sample(double uniform) const {
+        const double scaled = uniform * static_cast<double>(probability_.size());
+        size_t index = static_cast<size_t>(scaled);
+        // rounding may bring uniform close to 1 up to the size
+        if (index >= probability_.size()) {
+            index = probability_.size() - 1;
+        }
+        return scaled - static_cast<double>(index) < probability_[index] ? index : alias_[index];
+    }
+
+private:
+    // chance to keep the column's own index rather than its alias
+    std::vector<double> probability_;
+    std::vector<uint32_t> alias_;
+};
+
+}  // namespace util
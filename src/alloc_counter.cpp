@@ -0,0 +1,44 @@
+#include "alloc_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<bool> count_allocations{false};
+std::atomic<size_t> allocations_count{0};
+
+}  // namespace
+
+namespace util {
+
+void StartCountingAllocations() {
+    allocations_count = 0;
+    count_allocations = true;
+}
+
+size_t StopCountingAllocations() {
+    count_allocations = false;
+    return allocations_count;
+}
+
+}  // namespace util
+
+void* operator new(std::size_t size) {
+    if (count_allocations.load(std::memory_order_relaxed)) {
+        allocations_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (void* memory = std::malloc(size != 0 ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+
+// Counter of the heap allocations made through the global operator new.
+// alloc_counter.cpp replaces the global operator new and delete of the program, so it is linked
+// only into the programs which measure allocations: the benchmark and the tests.
+namespace util {
+
+// starts counting the allocations of all threads from zero
+void StartCountingAllocations();
+// stops counting and returns the number of allocations since StartCountingAllocations
+size_t StopCountingAllocations();
+
+}  // namespace util
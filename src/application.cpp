@@ -1,8 +1,27 @@
 #include "application.h"
 
+#include "logger.h"
+#include "snapshot.h"
+
 namespace app {
 
+Application::Application(model::Game& game, std::optional<std::string> path, std::shared_ptr<postgres::DBManager> db)
+    : game_(game)
+    , state_save_file_path_(path)
+    , db_(db) {
+    if (state_save_file_path_) {
+        state_saver_ = std::make_unique<serialization::SnapshotSaver>(*state_save_file_path_, [](const std::exception& ex) {
+            boost::json::object error_data;
+            error_data.insert({{LoggerJSONKeys::exception, ex.what()}});
+            error_data.insert({{LoggerJSONKeys::where, "save state"s}});
+            BOOST_LOG_TRIVIAL(info) << logging::add_value(additional_data, error_data)
+                                    << LoggerMessages::error;
+        });
+    }
+}
+
 std::string Application::GetPlayersJSONInfo (std::shared_ptr<app::Player> player_ptr) {
+    std::shared_lock lock{game_mutex_};
     auto players = player_ptr->GetSession()->GetPlayers();
     json::object root;
     for (auto& player : players) {
@@ -14,6 +33,7 @@ std::string Application::GetPlayersJSONInfo (std::shared_ptr<app::Player> player
 }
 
 std::string Application::GetStateJSONInfo(std::shared_ptr<app::Player> player_ptr) {
+    std::shared_lock lock{game_mutex_};
     auto players = player_ptr->GetSession()->GetPlayers();
     json::object root;
     json::object players_dict;
@@ -140,11 +160,24 @@ boost::json::array Application::GetJSONforAllMaps() const {
 }
 
 void Application::Move(std::shared_ptr<app::Player> player_ptr, std::string direction) {    
+    std::shared_lock lock{game_mutex_};
     player_ptr->Move(direction);
+    if (recorder_) {
+        recorder_->RecordMove(player_ptr->GetId(), direction);
+    }
 }
 
 void Application::UpdateTime(double time_delta) {
-    game_.UpdateTime(time_delta);
+    {
+        std::unique_lock lock{game_mutex_};
+        if (recorder_) {
+            recorder_->RecordTick(time_delta);
+        }
+        game_.UpdateTime(time_delta);
+        if (journal_) {
+            journal_->RecordTick(game_, time_delta);
+        }
+    }
     tick_signal_(time_delta);
 }
 
@@ -153,10 +186,16 @@ const model::Map* Application::FindMap(model::Map::Id(map_id)) {
 }
 
 std::shared_ptr<app::Player> Application::JoinGame(const std::string& name, const model::Map* map) {       
-    return game_.JoinGame(name, map);
+    std::unique_lock lock{game_mutex_};
+    auto player = game_.JoinGame(name, map);
+    if (recorder_) {
+        recorder_->RecordJoin(player->GetId(), player->GetSession()->GetId(), *map->GetId(), name);
+    }
+    return player;
 }
 
 std::shared_ptr<app::Player> Application::GetPlayerByToken(const std::string& token) const {
+    std::shared_lock lock{game_mutex_};
     return game_.GetPlayerByToken(token);
 } 
 
@@ -164,10 +203,80 @@ sig::connection Application::DoOnTimeUpdate(const TickSignal::slot_type& handler
     return tick_signal_.connect(handler);
 }
 
-void Application::SaveState() const {
-    if (state_save_file_path_) {
-        serialization::SaveGameStateInFile(*state_save_file_path_, game_);
+void Application::StartRecording(std::shared_ptr<replay::InputRecorder> recorder) {
+    std::unique_lock lock{game_mutex_};
+    const uint64_t seed = game_.GetRandomSeed();
+    game_.SetRandomSeed(seed);
+    recorder->RecordSeed(seed);
+    recorder->RecordSpawnSettings(game_.ArePlayersStartPointsRandomized());
+    recorder_ = std::move(recorder);
+}
+
+bool Application::SaveState() {
+    if (!state_saver_ || state_saver_->IsBusy()) {
+        return false;
+    }
+    std::vector<char> snapshot;
+    std::shared_ptr<serialization::ShardedSnapshot> sharded_snapshot;
+    uint64_t journal_generation = 0;
+    {
+        //only the copy into memory is made under the lock, the file is written by the saver thread
+        std::unique_lock lock{game_mutex_};
+        if (journal_) {
+            journal_generation = journal_->StartSegment();
+        }
+        if (sharded_writer_) {
+            sharded_snapshot = std::make_shared<serialization::ShardedSnapshot>(
+                sharded_writer_->Capture(game_, journal_generation));
+        } else {
+            snapshot = serialization::EncodeSnapshot(game_, journal_generation);
+        }
+    }
+    std::function<void()> on_written;
+    if (journal_) {
+        on_written = [path = *state_save_file_path_, journal_generation] {
+            serialization::RemoveJournalSegmentsBefore(path, journal_generation);
+        };
+    }
+    if (sharded_snapshot) {
+        state_saver_->SaveWith(
+            [writer = sharded_writer_.get(), sharded_snapshot] {
+                writer->Write(*sharded_snapshot);
+            },
+            std::move(on_written));
+    } else {
+        state_saver_->Save(std::move(snapshot), std::move(on_written));
+    }
+    return true;
+}
+
+void Application::SplitStateBySessions(unsigned io_threads) {
+    if (!state_save_file_path_) {
+        return;
+    }
+    state_saver_->Wait();
+    sharded_writer_ = std::make_unique<serialization::ShardedSnapshotWriter>(*state_save_file_path_, io_threads);
+}
+
+void Application::SaveStateAndWait() {
+    if (!state_saver_) {
+        return;
+    }
+    state_saver_->Wait();
+    SaveState();
+    state_saver_->Wait();
+}
+
+void Application::StartJournal() {
+    if (!state_save_file_path_) {
+        return;
+    }
+    {
+        std::unique_lock lock{game_mutex_};
+        game_.SetChangeTracking(true);
+        journal_ = std::make_unique<serialization::Journal>(*state_save_file_path_);
     }
+    SaveStateAndWait();
 }
 
 }//namespace application
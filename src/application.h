@@ -2,10 +2,15 @@
 
 #include <boost/signals2.hpp>
 #include <chrono>
+#include <shared_mutex>
 #include "model.h"
 #include "model_serialization.h"
 #include "data_structures.h"
 #include "db_manager.h"
+#include "input_log.h"
+#include "journal.h"
+#include "sharded_snapshot.h"
+#include "snapshot_saver.h"
 
 namespace app {
 
@@ -19,14 +24,13 @@ const std::map<app::Direction, std::string> dir_to_letter = { {app::Direction::N
                                                         {app::Direction::WEST, "L"s},
                                                         {app::Direction::EAST, "R"s} };
 
+// Requests of different sessions run concurrently on their own strands and share the game lock,
+// operations changing the whole game (join, tick, saving) take it exclusively.
 class Application {
 public:
     using TickSignal = sig::signal<void(double delta)>;
 
-    Application(model::Game& game, std::optional<std::string> path, std::shared_ptr<postgres::DBManager> db) 
-        : game_(game)        
-        , state_save_file_path_(path)
-        , db_(db) {}
+    Application(model::Game& game, std::optional<std::string> path, std::shared_ptr<postgres::DBManager> db);
     const model::Map* FindMap(model::Map::Id(map_id));
     std::shared_ptr<app::Player> JoinGame(const std::string& name, const model::Map* map);
 
@@ -40,12 +44,32 @@ public:
     void Move(std::shared_ptr<app::Player> player_ptr, std::string direction);
     void UpdateTime(double time_delta);
     sig::connection DoOnTimeUpdate(const TickSignal::slot_type& handler);
-    void SaveState() const;
+    // Captures the state under the game lock and leaves writing it to the saver thread. While the
+    // previous snapshot is still being written nothing is captured and false is returned, the state
+    // of a later call goes to the file then.
+    bool SaveState();
+    // saves the current state and waits until it is written, used on shutdown
+    void SaveStateAndWait();
+    // from now on the state is saved as a file per session written on io_threads threads,
+    // the sessions not changed since the previous save aren't written again, see sharded_snapshot.h
+    void SplitStateBySessions(unsigned io_threads);
+    // From now on every tick appends its changes to the journal next to the state file and
+    // SaveState compacts the journal into a new snapshot. The current state is saved first.
+    void StartJournal();
+    // from now on the inputs of the game are written to the recorder; the random streams are
+    // restarted from the game seed, so that a replay of the log draws the same numbers
+    void StartRecording(std::shared_ptr<replay::InputRecorder> recorder);
 
 private:
     model::Game& game_;
     std::optional<std::string> state_save_file_path_;
     TickSignal tick_signal_;
     std::shared_ptr<postgres::DBManager> db_;
+    mutable std::shared_mutex game_mutex_;
+    std::shared_ptr<replay::InputRecorder> recorder_;
+    // declared before the saver, whose thread may be writing a snapshot with it until the saver is destroyed
+    std::unique_ptr<serialization::ShardedSnapshotWriter> sharded_writer_;
+    std::unique_ptr<serialization::SnapshotSaver> state_saver_;
+    std::unique_ptr<serialization::Journal> journal_;
 };
 } //namespace application
\ No newline at end of file
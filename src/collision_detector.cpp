@@ -1,6 +1,11 @@
 #include "collision_detector.h"
+#include "simd_kernels.h"
 #include <cassert>
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
 
 using namespace std;
 
@@ -21,32 +26,190 @@ CollectionResult TryCollectPoint(geom::Point2D a, geom::Point2D b, geom::Point2D
     return CollectionResult(sq_distance, proj_ratio);
 }
 
-std::vector<GatheringEvent> FindGatherEvents(const ItemGathererProvider& provider) {
+namespace {
+
+// below this amount of gatherer-item pairs building the grid costs more than it saves
+constexpr size_t GRID_MIN_PAIRS = 1024;
+// extra space around a gatherer's path compensating rounding errors in TryCollectPoint
+constexpr double GRID_MARGIN = 1e-6;
+
+bool IsStanding(const Gatherer& gatherer) {
+    return gatherer.start_pos.x == gatherer.end_pos.x &&
+           gatherer.start_pos.y == gatherer.end_pos.y;
+}
+
+void SortEventsByTime(std::vector<GatheringEvent>& events) {
+    std::sort(events.begin(), events.end(), [](GatheringEvent lhs, GatheringEvent rhs) {
+        return lhs.time < rhs.time;
+    });
+}
+
+class ItemGrid {
+public:
+    ItemGrid(std::span<const Item> items, double cell_size)
+        : items_(items)
+        , cell_size_(cell_size) {
+        cell_items_.reserve(items_.size());
+        for (size_t i = 0; i < items_.size(); ++i) {
+            max_item_width_ = std::max(max_item_width_, items_[i].width);
+            cell_items_.push_back({CellKey(ToCell(items_[i].position.x), ToCell(items_[i].position.y)), i});
+        }
+        // items of a cell are kept in ascending order of their indices
+        std::sort(cell_items_.begin(), cell_items_.end());
+        for (size_t i = 0; i < cell_items_.size();) {
+            size_t end = i;
+            while (end < cell_items_.size() && cell_items_[end].first == cell_items_[i].first) {
+                ++end;
+            }
+            cells_.emplace(cell_items_[i].first, std::pair{i, end});
+            i = end;
+        }
+    }
+
+    const Item& GetItem(size_t idx) const {
+        return items_[idx];
+    }
+
+    // puts indices of the items which may be gathered on the way, in ascending order
+    void FindCandidates(const Gatherer& gatherer, std::vector<size_t>& candidates) const {
+        candidates.clear();
+        const double reach = gatherer.width + max_item_width_ + GRID_MARGIN;
+        const int64_t min_x = ToCell(std::min(gatherer.start_pos.x, gatherer.end_pos.x) - reach);
+        const int64_t max_x = ToCell(std::max(gatherer.start_pos.x, gatherer.end_pos.x) + reach);
+        const int64_t min_y = ToCell(std::min(gatherer.start_pos.y, gatherer.end_pos.y) - reach);
+        const int64_t max_y = ToCell(std::max(gatherer.start_pos.y, gatherer.end_pos.y) + reach);
+
+        // a long diagonal path covers more cells than there are filled ones
+        const double cells_count = static_cast<double>(max_x - min_x + 1) * static_cast<double>(max_y - min_y + 1);
+        if (cells_count > static_cast<double>(cells_.size())) {
+            for (size_t i = 0; i < items_.size(); ++i) {
+                candidates.push_back(i);
+            }
+            return;
+        }
+
+        for (int64_t x = min_x; x <= max_x; ++x) {
+            for (int64_t y = min_y; y <= max_y; ++y) {
+                auto it = cells_.find(CellKey(x, y));
+                if (it == cells_.end()) {
+                    continue;
+                }
+                for (size_t i = it->second.first; i < it->second.second; ++i) {
+                    candidates.push_back(cell_items_[i].second);
+                }
+            }
+        }
+        std::sort(candidates.begin(), candidates.end());
+    }
+
+private:
+    int64_t ToCell(double coord) const {
+        return static_cast<int64_t>(std::floor(coord / cell_size_));
+    }
+
+    static uint64_t CellKey(int64_t x, int64_t y) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+    }
+
+    std::span<const Item> items_;
+    double cell_size_;
+    double max_item_width_ = 0.;
+    // (cell key, item index) sorted by cell
+    std::vector<std::pair<uint64_t, size_t>> cell_items_;
+    // cell key to the range of its items in cell_items_
+    std::unordered_map<uint64_t, std::pair<size_t, size_t>> cells_;
+};
+
+std::vector<Item> ReadItems(const ItemGathererProvider& provider) {
+    std::vector<Item> items;
+    items.reserve(provider.ItemsCount());
+    for (size_t j = 0; j < provider.ItemsCount(); ++j) {
+        items.push_back(provider.GetItem(j));
+    }
+    return items;
+}
+
+std::vector<Gatherer> ReadGatherers(const ItemGathererProvider& provider) {
+    std::vector<Gatherer> gatherers;
+    gatherers.reserve(provider.GatherersCount());
+    for (size_t i = 0; i < provider.GatherersCount(); ++i) {
+        gatherers.push_back(provider.GetGatherer(i));
+    }
+    return gatherers;
+}
+
+}  // namespace
+
+void CollectEvents(const Gatherer& gatherer, size_t gatherer_id, ItemBatch& batch, std::vector<GatheringEvent>& events) {
+    const size_t count = batch.ids.size();
+    batch.sq_distance.resize(count);
+    batch.proj_ratio.resize(count);
+    simd::TryCollectPoints(gatherer.start_pos, gatherer.end_pos, count, batch.x.data(), batch.y.data(),
+                           batch.sq_distance.data(), batch.proj_ratio.data());
+    for (size_t k = 0; k < count; ++k) {
+        CollectionResult result{batch.sq_distance[k], batch.proj_ratio[k]};
+        if (result.IsCollected(batch.width[k] + gatherer.width)) {
+            GatheringEvent event; 
+            event.gatherer_id = gatherer_id;
+            event.item_id = batch.ids[k];
+            event.sq_distance = result.sq_distance;
+            event.time = result.proj_ratio;
+            events.push_back(event);
+        }
+    }
+}
+
+std::vector<GatheringEvent> FindGatherEventsExhaustive(std::span<const Item> items, std::span<const Gatherer> gatherers) {
     std::vector<GatheringEvent> events;
-    int gatherers_count = provider.GatherersCount();
-    int items_count = provider.ItemsCount();
-    for (uint i = 0; i < gatherers_count; i++) {
-        Gatherer gatherer = provider.GetGatherer(i);
-        if (gatherer.start_pos.x == gatherer.end_pos.x &&
-            gatherer.start_pos.y == gatherer.end_pos.y) {
+    // items are laid out once and every gatherer is tested against all of them by the batch kernel
+    ItemBatch batch;
+    for (size_t j = 0; j < items.size(); ++j) {
+        batch.Add(j, items[j]);
+    }
+    for (size_t i = 0; i < gatherers.size(); ++i) {
+        if (IsStanding(gatherers[i])) {
             continue;
         }
-        for (uint j = 0; j < items_count; j++) {
-            Item item = provider.GetItem(j);
-            auto result = TryCollectPoint(gatherer.start_pos, gatherer.end_pos, item.position);
-            if (result.IsCollected(item.width + gatherer.width)) {
-                GatheringEvent event; 
-                event.gatherer_id = i;
-                event.item_id = j;
-                event.sq_distance = result.sq_distance;
-                event.time = result.proj_ratio;
-                events.push_back(event);
-            }
+        CollectEvents(gatherers[i], i, batch, events);
+    }
+    SortEventsByTime(events);
+    return events;
+}
+
+std::vector<GatheringEvent> FindGatherEventsWithGrid(std::span<const Item> items, std::span<const Gatherer> gatherers,
+                                                     double cell_size) {
+    ItemGrid grid(items, cell_size);
+
+    std::vector<GatheringEvent> events;
+    std::vector<size_t> candidates;
+    ItemBatch batch;
+    for (size_t i = 0; i < gatherers.size(); ++i) {
+        const Gatherer& gatherer = gatherers[i];
+        if (IsStanding(gatherer)) {
+            continue;
         }
+        grid.FindCandidates(gatherer, candidates);
+        batch.Clear();
+        for (size_t j : candidates) {
+            batch.Add(j, grid.GetItem(j));
+        }
+        CollectEvents(gatherer, i, batch, events);
     }
-    std::sort(events.begin(), events.end(), [](GatheringEvent lhs, GatheringEvent rhs) {
-        return lhs.time < rhs.time;
-    });
+    // candidates were tested in the same order as in the exhaustive search,
+    // so sorting gives the same sequence of events
+    SortEventsByTime(events);
     return events;
 }
-}  // namespace collision_detector
\ No newline at end of file
+
+std::vector<GatheringEvent> FindGatherEvents(std::span<const Item> items, std::span<const Gatherer> gatherers) {
+    if (gatherers.size() * items.size() < GRID_MIN_PAIRS) {
+        return FindGatherEventsExhaustive(items, gatherers);
+    }
+    return FindGatherEventsWithGrid(items, gatherers);
+}
+
+std::vector<GatheringEvent> FindGatherEvents(const ItemGathererProvider& provider) {
+    return FindGatherEvents(ReadItems(provider), ReadGatherers(provider));
+}
+
+}  // namespace collision_detector
@@ -3,6 +3,7 @@
 #include "geom.h"
 
 #include <algorithm>
+#include <span>
 #include <vector>
 
 namespace collision_detector {
@@ -46,6 +47,60 @@ struct GatheringEvent {
     double time;
 };
 
+// Items tested against one gatherer, laid out for the batch kernel.
+// The arrays keep their capacity, so a batch reused between searches doesn't allocate.
+struct ItemBatch {
+    std::vector<size_t> ids;
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> width;
+    std::vector<double> sq_distance;
+    std::vector<double> proj_ratio;
+
+    void Clear() {
+        ids.clear();
+        x.clear();
+        y.clear();
+        width.clear();
+    }
+
+    void Reserve(size_t count) {
+        for (auto* column : {&x, &y, &width, &sq_distance, &proj_ratio}) {
+            column->reserve(count);
+        }
+        ids.reserve(count);
+    }
+
+    void Add(size_t id, const Item& item) {
+        ids.push_back(id);
+        x.push_back(item.position.x);
+        y.push_back(item.position.y);
+        width.push_back(item.width);
+    }
+};
+
+// Narrow phase shared by the searches below and by callers with a broadphase of their own:
+// appends the events of a moving gatherer with the items of the batch, in the order of the batch.
+void CollectEvents(const Gatherer& gatherer, size_t gatherer_id, ItemBatch& batch, std::vector<GatheringEvent>& events);
+
+// side of a cell of the uniform grid used as broadphase,
+// chosen so that a dog's path in one tick crosses only a few cells
+constexpr double DEFAULT_GRID_CELL_SIZE = 1.0;
+
+// The searches take contiguous arrays of items and gatherers, so the inner loops work on plain
+// memory the compiler can inline and vectorize; item_id and gatherer_id of an event are indices in them.
+// Tests every gatherer against every item.
+std::vector<GatheringEvent> FindGatherEventsExhaustive(std::span<const Item> items, std::span<const Gatherer> gatherers);
+// Buckets items into a uniform grid and tests each gatherer only against items
+// in the cells covered by its path. Gives exactly the same events in the same order
+// as FindGatherEventsExhaustive.
+std::vector<GatheringEvent> FindGatherEventsWithGrid(std::span<const Item> items, std::span<const Gatherer> gatherers,
+                                                     double cell_size = DEFAULT_GRID_CELL_SIZE);
+// Chooses one of the methods above depending on the amount of gatherers and items.
+std::vector<GatheringEvent> FindGatherEvents(std::span<const Item> items, std::span<const Gatherer> gatherers);
+
+// Adapter for ItemGathererProvider: the items and gatherers are read once through
+// the virtual interface and the search runs on the arrays.
 std::vector<GatheringEvent> FindGatherEvents(const ItemGathererProvider& provider);
 
 }  // namespace collision_detector
\ No newline at end of file
@@ -0,0 +1,188 @@
+#include "dog_store.h"
+#include "model.h"
+
+namespace model {
+
+DogStore::Index DogStore::Add(std::shared_ptr<app::Player> player, app::Coordinates position) {
+    const Index index = players.size();
+    x.push_back(position.x);
+    y.push_back(position.y);
+    speed_x.push_back(0.);
+    speed_y.push_back(0.);
+    direction.push_back(app::Direction::NORTH);
+    idle_time.push_back(0.);
+    play_time.push_back(0.);
+    settled_at.push_back(time);
+    horizontal_road.push_back(NO_ROAD);
+    vertical_road.push_back(NO_ROAD);
+    road_cell.push_back(std::nullopt);
+    active_slot.push_back(NOT_ACTIVE);
+    event_kind.push_back(KineticEvent::ROAD_END);
+    event_position.push_back(0.);
+    event_time.push_back(0.);
+
+    player->dogs_ = this;
+    player->dog_index_ = index;
+    id_to_index_[player->GetId()] = index;
+    ++version;
+    if (changes) {
+        changes->joined_players.push_back(player->GetId());
+    }
+    players.push_back(std::move(player));
+    UpdateRetirementTimer(index);
+    return index;
+}
+
+void DogStore::Reserve(size_t count) {
+    x.reserve(count);
+    y.reserve(count);
+    speed_x.reserve(count);
+    speed_y.reserve(count);
+    direction.reserve(count);
+    idle_time.reserve(count);
+    play_time.reserve(count);
+    settled_at.reserve(count);
+    horizontal_road.reserve(count);
+    vertical_road.reserve(count);
+    road_cell.reserve(count);
+    active_slot.reserve(count);
+    event_kind.reserve(count);
+    event_position.reserve(count);
+    event_time.reserve(count);
+    players.reserve(count);
+    id_to_index_.reserve(count);
+    retirement_timers_.Reserve(count);
+}
+
+void DogStore::Remove(Index index) {
+    const Index last = players.size() - 1;
+
+    // keep the total play time in the handle, it is reported after the dog has left
+    players[index]->total_play_time_ = GetPlayTime(index);
+    players[index]->dogs_ = nullptr;
+    if (IsActive(index)) {
+        Deactivate(index);
+    }
+    retirement_timers_.Remove(players[index]->GetId());
+    id_to_index_.erase(players[index]->GetId());
+    ++version;
+    if (changes) {
+        changes->left_players.push_back(players[index]->GetId());
+    }
+
+    if (index != last) {
+        x[index] = x[last];
+        y[index] = y[last];
+        speed_x[index] = speed_x[last];
+        speed_y[index] = speed_y[last];
+        direction[index] = direction[last];
+        idle_time[index] = idle_time[last];
+        play_time[index] = play_time[last];
+        settled_at[index] = settled_at[last];
+        horizontal_road[index] = horizontal_road[last];
+        vertical_road[index] = vertical_road[last];
+        road_cell[index] = road_cell[last];
+        active_slot[index] = active_slot[last];
+        event_kind[index] = event_kind[last];
+        event_position[index] = event_position[last];
+        event_time[index] = event_time[last];
+        if (active_slot[index] != NOT_ACTIVE) {
+            active[active_slot[index]] = index;
+        }
+        players[index] = std::move(players[last]);
+        players[index]->dog_index_ = index;
+        id_to_index_[players[index]->GetId()] = index;
+    }
+
+    x.pop_back();
+    y.pop_back();
+    speed_x.pop_back();
+    speed_y.pop_back();
+    direction.pop_back();
+    idle_time.pop_back();
+    play_time.pop_back();
+    settled_at.pop_back();
+    horizontal_road.pop_back();
+    vertical_road.pop_back();
+    road_cell.pop_back();
+    active_slot.pop_back();
+    event_kind.pop_back();
+    event_position.pop_back();
+    event_time.pop_back();
+    players.pop_back();
+}
+
+void DogStore::Settle(Index index) {
+    const double pending_time = GetPendingTime(index);
+    if (IsActive(index)) {
+        x[index] += speed_x[index] * pending_time;
+        y[index] += speed_y[index] * pending_time;
+    } else {
+        idle_time[index] += pending_time;
+    }
+    play_time[index] += pending_time;
+    settled_at[index] = time;
+}
+
+void DogStore::UpdateActivity(Index index) {
+    const bool is_moving = speed_x[index] != 0. || speed_y[index] != 0.;
+    if (is_moving && !IsActive(index)) {
+        Settle(index);
+        Activate(index);
+        UpdateRetirementTimer(index);
+    } else if (!is_moving && IsActive(index)) {
+        Settle(index);
+        Deactivate(index);
+        UpdateRetirementTimer(index);
+    }
+}
+
+void DogStore::UpdateRetirementTimer(Index index) {
+    const int player_id = players[index]->GetId();
+    if (IsActive(index)) {
+        retirement_timers_.Cancel(player_id);
+    } else {
+        retirement_timers_.Schedule(player_id, time + (idle_time_limit - GetIdleTime(index)));
+    }
+}
+
+void DogStore::FindRetirementCandidates(std::vector<Index>& dogs) {
+    expired_ids_.clear();
+    retirement_timers_.Advance(time, expired_ids_);
+    for (int player_id : expired_ids_) {
+        dogs.push_back(id_to_index_.at(player_id));
+    }
+}
+
+void DogStore::TakeMotionChanges(std::vector<Index>& dogs) {
+    for (int player_id : motion_changed_ids_) {
+        if (auto it = id_to_index_.find(player_id); it != id_to_index_.end()) {
+            dogs.push_back(it->second);
+        }
+    }
+    motion_changed_ids_.clear();
+}
+
+void DogStore::Activate(Index index) {
+    active_slot[index] = active.size();
+    active.push_back(index);
+}
+
+void DogStore::Deactivate(Index index) {
+    const size_t slot = active_slot[index];
+    active[slot] = active.back();
+    active_slot[active[slot]] = slot;
+    active.pop_back();
+    active_slot[index] = NOT_ACTIVE;
+}
+
+std::optional<DogStore::Index> DogStore::FindByToken(const app::Token& token) const {
+    for (Index i = 0; i < players.size(); ++i) {
+        if (players[i]->GetToken() == token) {
+            return i;
+        }
+    }
+    return std::nullopt;
+}
+
+}  // namespace model
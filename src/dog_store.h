@@ -0,0 +1,185 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "player.h"
+#include "road_graph.h"
+#include "timer_wheel.h"
+
+namespace model {
+
+// what happens to a moving dog at the event predicted in the kinetic mode
+enum class KineticEvent : uint8_t {
+    ROAD_END,
+    // the dog crosses a cell border next to a junction, the roads under it may change
+    JUNCTION,
+    GATHER
+};
+
+// ids of players and loot items changed in a session since the changes were taken last,
+// collected only while the session tracks them; an id may repeat
+struct SessionChanges {
+    std::vector<int> joined_players;
+    // speed, direction, bag or score of the player changed
+    std::vector<int> changed_players;
+    std::vector<int> left_players;
+    std::vector<int> spawned_loot;
+    std::vector<int> removed_loot;
+
+    void Clear() noexcept {
+        joined_players.clear();
+        changed_players.clear();
+        left_players.clear();
+        spawned_loot.clear();
+        removed_loot.clear();
+    }
+};
+
+// Dense state of all dogs of one game session.
+// Every field lives in its own contiguous array and a dog is addressed by its index,
+// so the tick loop walks memory linearly instead of chasing player pointers.
+// app::Player objects are thin handles that read and write their row of the store.
+// Dogs with non-zero speed form the active set, the tick moves only them. Stationary dogs
+// only get idle and play time, which are charged lazily from the session clock, and have
+// a timer set to the moment their idle time reaches the retirement limit.
+// In the kinetic mode moving dogs are charged lazily as well: x and y is the position at settled_at
+// and the dog goes straight with its speed until the next event predicted by the session.
+class DogStore {
+public:
+    using Index = size_t;
+    static constexpr size_t NOT_ACTIVE = std::numeric_limits<size_t>::max();
+
+    DogStore() = default;
+    DogStore(const DogStore&) = delete;
+    DogStore& operator=(const DogStore&) = delete;
+
+    size_t Size() const noexcept {
+        return players.size();
+    }
+
+    bool Empty() const noexcept {
+        return players.empty();
+    }
+
+    // makes room for count dogs, so that adding them doesn't move the arrays
+    void Reserve(size_t count);
+    // appends a row for the player and binds the player handle to it
+    Index Add(std::shared_ptr<app::Player> player, app::Coordinates position);
+    // removes the row by moving the last row into its place,
+    // the handle of the moved dog is re-pointed to its new index
+    void Remove(Index index);
+    std::optional<Index> FindByToken(const app::Token& token) const;
+    Index GetIndexById(int player_id) const {
+        return id_to_index_.at(player_id);
+    }
+    std::optional<Index> FindById(int player_id) const {
+        if (auto it = id_to_index_.find(player_id); it != id_to_index_.end()) {
+            return it->second;
+        }
+        return std::nullopt;
+    }
+
+    bool IsActive(Index index) const noexcept {
+        return active_slot[index] != NOT_ACTIVE;
+    }
+
+    // idle and play time including the time charged lazily
+    double GetIdleTime(Index index) const noexcept {
+        return idle_time[index] + (IsActive(index) ? 0. : GetPendingTime(index));
+    }
+
+    double GetPlayTime(Index index) const noexcept {
+        return play_time[index] + GetPendingTime(index);
+    }
+
+    app::Coordinates GetPosition(Index index) const noexcept {
+        if (!IsActive(index)) {
+            return {x[index], y[index]};
+        }
+        const double pending_time = GetPendingTime(index);
+        return {x[index] + speed_x[index] * pending_time, y[index] + speed_y[index] * pending_time};
+    }
+
+    // writes the lazily charged time into idle_time and play_time and the lazily made move into x and y,
+    // must be done before they are changed directly
+    void Settle(Index index);
+    // puts the dog in the active set or takes it out according to its speed
+    void UpdateActivity(Index index);
+    // remembers that the speed of the dog has been changed from outside the tick,
+    // the session predicts new events for such dogs in the kinetic mode
+    void MarkMotionChanged(Index index) {
+        if (track_motion_changes) {
+            motion_changed_ids_.push_back(players[index]->GetId());
+        }
+    }
+    // remembers that the speed, bag or score of the dog has changed, see SessionChanges
+    void MarkChanged(Index index) {
+        ++version;
+        if (changes) {
+            changes->changed_players.push_back(players[index]->GetId());
+        }
+    }
+    // moves indices of the dogs marked since the last call and still in the store to dogs
+    void TakeMotionChanges(std::vector<Index>& dogs);
+    // sets the retirement timer of a stationary dog from its current idle time, cancels it for a moving one
+    void UpdateRetirementTimer(Index index);
+    // appends indices of the stationary dogs whose timers have fired by the session time
+    void FindRetirementCandidates(std::vector<Index>& dogs);
+
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> speed_x;
+    std::vector<double> speed_y;
+    std::vector<app::Direction> direction;
+    // time up to settled_at only, see GetIdleTime and GetPlayTime
+    std::vector<double> idle_time;
+    std::vector<double> play_time;
+    std::vector<double> settled_at;
+    // indices in Map::GetRoads(), NO_ROAD if the dog is not on a road of that orientation
+    std::vector<size_t> horizontal_road;
+    std::vector<size_t> vertical_road;
+    // cell the roads above were found for, they are looked up again only when the dog leaves it
+    std::vector<std::optional<RoadCell>> road_cell;
+    std::vector<std::shared_ptr<app::Player>> players;
+
+    // position of the dog in active, NOT_ACTIVE for a stationary dog
+    std::vector<size_t> active_slot;
+    // indices of the dogs with non-zero speed in no particular order
+    std::vector<Index> active;
+
+    // next event of a moving dog in the kinetic mode and the coordinate along its way where it happens
+    std::vector<KineticEvent> event_kind;
+    std::vector<double> event_position;
+    std::vector<double> event_time;
+
+    // session time, sum of all tick deltas
+    double time = 0.;
+    double idle_time_limit = std::numeric_limits<double>::infinity();
+    bool track_motion_changes = false;
+    // joins, leaves and changes of the dogs are added here when it is set
+    SessionChanges* changes = nullptr;
+    // counts the joins, leaves and changes of the dogs whether they are collected or not
+    uint64_t version = 0;
+
+private:
+    double GetPendingTime(Index index) const noexcept {
+        return time - settled_at[index];
+    }
+
+    void Activate(Index index);
+    void Deactivate(Index index);
+
+    std::unordered_map<int, Index> id_to_index_;
+    // keyed by player id, it doesn't change when rows are moved
+    util::TimerWheel<int> retirement_timers_;
+    std::vector<int> expired_ids_;
+    std::vector<int> motion_changed_ids_;
+};
+
+}  // namespace model
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace util {
+
+// Counter-based generator: the n-th number of a stream is the splitmix64 hash of the stream key
+// and n, so streams made from one seed are independent and cost two words each.
+// Meets UniformRandomBitGenerator, so it can be used with the standard distributions too.
+class FastRandom {
+public:
+    using result_type = uint64_t;
+
+    explicit FastRandom(uint64_t seed = 0) {
+        Seed(seed);
+    }
+
+    // the stream of the given number, streams of different numbers don't overlap in practice
+    FastRandom(uint64_t seed, uint64_t stream)
+        : key_{Mix(Mix(seed) ^ Mix(stream + GOLDEN_GAMMA))} {
+    }
+
+    // close seeds give unrelated sequences
+    void Seed(uint64_t seed) {
+        key_ = Mix(seed);
+        counter_ = 0;
+    }
+
+    static constexpr result_type min() {
+        return 0;
+    }
+
+    static constexpr result_type max() {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    result_type operator()() {
+        return Mix(key_ + GOLDEN_GAMMA * ++counter_);
+    }
+
+    // uniform in [0, 1)
+    double NextDouble() {
+        return static_cast<double>((*this)() >> 11) * 0x1.0p-53;
+    }
+
+    // uniform in [0, count), count must be positive
+    size_t NextIndex(size_t count) {
+        // multiply-shift, the bias is below 2^-32 for any count a map can have
+        return static_cast<size_t>((static_cast<unsigned __int128>((*this)()) * count) >> 64);
+    }
+
+private:
+    static constexpr uint64_t GOLDEN_GAMMA = 0x9E3779B97F4A7C15ULL;
+
+    static uint64_t Mix(uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    uint64_t key_ = 0;
+    uint64_t counter_ = 0;
+};
+
+}  // namespace util
@@ -0,0 +1,214 @@
+#include "input_log.h"
+
+#include <bit>
+#include <cstring>
+
+namespace replay {
+
+using namespace std::literals;
+
+namespace {
+
+constexpr char MAGIC[] = {'G', 'S', 'I', 'N'};
+constexpr uint8_t VERSION = 1;
+
+}  // namespace
+
+InputRecorder::InputRecorder(std::ostream& output)
+    : output_{output} {
+    output_.write(MAGIC, sizeof(MAGIC));
+    output_.put(static_cast<char>(VERSION));
+}
+
+void InputRecorder::RecordSeed(uint64_t seed) {
+    std::lock_guard lock{mutex_};
+    output_.put(static_cast<char>(InputKind::SEED));
+    WriteFixed(seed);
+}
+
+void InputRecorder::RecordSpawnSettings(bool randomize_spawn_points) {
+    std::lock_guard lock{mutex_};
+    output_.put(static_cast<char>(InputKind::SPAWN_SETTINGS));
+    output_.put(randomize_spawn_points ? 1 : 0);
+}
+
+void InputRecorder::RecordJoin(int player_id, int session_id, const std::string& map_id, const std::string& name) {
+    std::lock_guard lock{mutex_};
+    output_.put(static_cast<char>(InputKind::JOIN));
+    WriteVarint(static_cast<uint64_t>(player_id));
+    WriteVarint(static_cast<uint64_t>(session_id));
+    WriteString(map_id);
+    WriteString(name);
+}
+
+void InputRecorder::RecordMove(int player_id, const std::string& direction) {
+    std::lock_guard lock{mutex_};
+    output_.put(static_cast<char>(InputKind::MOVE));
+    WriteVarint(static_cast<uint64_t>(player_id));
+    output_.put(direction.empty() ? '\0' : direction.front());
+}
+
+void InputRecorder::RecordTick(double time_delta) {
+    std::lock_guard lock{mutex_};
+    output_.put(static_cast<char>(InputKind::TICK));
+    WriteFixed(std::bit_cast<uint64_t>(time_delta));
+    output_.flush();
+}
+
+void InputRecorder::WriteVarint(uint64_t value) {
+    while (value >= 0x80) {
+        output_.put(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    output_.put(static_cast<char>(value));
+}
+
+void InputRecorder::WriteFixed(uint64_t value) {
+    char bytes[8];
+    for (char& byte : bytes) {
+        byte = static_cast<char>(value & 0xFF);
+        value >>= 8;
+    }
+    output_.write(bytes, sizeof(bytes));
+}
+
+void InputRecorder::WriteString(const std::string& value) {
+    WriteVarint(value.size());
+    output_.write(value.data(), value.size());
+}
+
+InputReader::InputReader(std::istream& input)
+    : input_{input} {
+    char magic[sizeof(MAGIC)];
+    if (!input_.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) {
+        throw InputLogError("Not an input log"s);
+    }
+    if (const int version = input_.get(); version != VERSION) {
+        throw InputLogError("Unsupported input log version "s + std::to_string(version));
+    }
+}
+
+std::optional<InputRecord> InputReader::Next() {
+    const int kind = input_.get();
+    if (kind == std::char_traits<char>::eof()) {
+        return std::nullopt;
+    }
+    InputRecord record;
+    record.kind = static_cast<InputKind>(kind);
+    switch (record.kind) {
+        case InputKind::SEED:
+            record.seed = ReadFixed();
+            break;
+        case InputKind::SPAWN_SETTINGS:
+            record.randomize_spawn_points = ReadByte() != 0;
+            break;
+        case InputKind::JOIN:
+            record.player_id = static_cast<int>(ReadVarint());
+            record.session_id = static_cast<int>(ReadVarint());
+            record.map_id = ReadString();
+            record.name = ReadString();
+            break;
+        case InputKind::MOVE:
+            record.player_id = static_cast<int>(ReadVarint());
+            if (const char direction = static_cast<char>(ReadByte()); direction != '\0') {
+                record.direction = std::string(1, direction);
+            }
+            break;
+        case InputKind::TICK:
+            record.time_delta = std::bit_cast<double>(ReadFixed());
+            break;
+        default:
+            throw InputLogError("Unknown input record kind "s + std::to_string(kind));
+    }
+    return record;
+}
+
+uint8_t InputReader::ReadByte() {
+    const int byte = input_.get();
+    if (byte == std::char_traits<char>::eof()) {
+        throw InputLogError("Input log is cut off"s);
+    }
+    return static_cast<uint8_t>(byte);
+}
+
+uint64_t InputReader::ReadVarint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        const uint8_t byte = ReadByte();
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+    throw InputLogError("Broken varint in the input log"s);
+}
+
+uint64_t InputReader::ReadFixed() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 8) {
+        value |= static_cast<uint64_t>(ReadByte()) << shift;
+    }
+    return value;
+}
+
+std::string InputReader::ReadString() {
+    const uint64_t size = ReadVarint();
+    std::string value(size, '\0');
+    if (!input_.read(value.data(), size)) {
+        throw InputLogError("Input log is cut off"s);
+    }
+    return value;
+}
+
+InputReplayer::InputReplayer(model::Game& game)
+    : game_{game}
+    , players_{game.GetPlayers()} {
+}
+
+void InputReplayer::Apply(const InputRecord& record) {
+    switch (record.kind) {
+        case InputKind::SEED:
+            game_.SetRandomSeed(record.seed);
+            break;
+        case InputKind::SPAWN_SETTINGS:
+            game_.SetPlayersStartPointRandomizing(record.randomize_spawn_points);
+            break;
+        case InputKind::JOIN: {
+            const model::Map* map = game_.FindMap(model::Map::Id{record.map_id});
+            if (!map) {
+                throw InputLogError("Map "s + record.map_id + " of the input log is not in the game"s);
+            }
+            players_[record.player_id] = game_.JoinGame(record.name, map, record.session_id);
+            ++stats_.joins;
+            break;
+        }
+        case InputKind::MOVE: {
+            auto it = players_.find(record.player_id);
+            if (it == players_.end()) {
+                throw InputLogError("Player "s + std::to_string(record.player_id) + " of the input log is not in the game"s);
+            }
+            it->second->Move(record.direction);
+            ++stats_.moves;
+            break;
+        }
+        case InputKind::TICK: {
+            const auto start = std::chrono::steady_clock::now();
+            game_.UpdateTime(record.time_delta);
+            stats_.tick_time += std::chrono::steady_clock::now() - start;
+            stats_.game_time += record.time_delta;
+            ++stats_.ticks;
+            break;
+        }
+    }
+}
+
+ReplayStats InputReplayer::Replay(InputReader& reader) {
+    const auto start = std::chrono::steady_clock::now();
+    while (auto record = reader.Next()) {
+        Apply(*record);
+    }
+    stats_.total_time += std::chrono::steady_clock::now() - start;
+    return stats_;
+}
+
+}  // namespace replay
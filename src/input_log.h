@@ -0,0 +1,114 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+
+#include "model.h"
+
+namespace replay {
+
+// Binary log of the inputs reaching the model. It starts with a header and goes on with records,
+// each record is a kind byte and its fields. Integers are LEB128 varints, doubles and seeds
+// are 8 little-endian bytes, strings are a varint length and the bytes.
+enum class InputKind : uint8_t {
+    SEED = 1,           // seed: the master random seed set at this point
+    SPAWN_SETTINGS = 2, // randomize_spawn_points
+    JOIN = 3,           // player_id, session_id, map_id, name: the ids given by the recorded game
+    MOVE = 4,           // player_id, direction: one of "U", "D", "L", "R" or "" to stop
+    TICK = 5,           // time_delta in milliseconds
+};
+
+struct InputRecord {
+    InputKind kind;
+    uint64_t seed = 0;
+    bool randomize_spawn_points = false;
+    int player_id = 0;
+    int session_id = 0;
+    std::string map_id;
+    std::string name;
+    std::string direction;
+    double time_delta = 0.;
+};
+
+class InputLogError : public std::runtime_error {
+public:
+    using runtime_error::runtime_error;
+};
+
+// Appends records to a stream. Moves of different sessions are recorded concurrently,
+// so the writes are serialized by a mutex; the stream is flushed after every tick.
+class InputRecorder {
+public:
+    explicit InputRecorder(std::ostream& output);
+
+    void RecordSeed(uint64_t seed);
+    void RecordSpawnSettings(bool randomize_spawn_points);
+    void RecordJoin(int player_id, int session_id, const std::string& map_id, const std::string& name);
+    void RecordMove(int player_id, const std::string& direction);
+    void RecordTick(double time_delta);
+
+private:
+    void WriteVarint(uint64_t value);
+    void WriteFixed(uint64_t value);
+    void WriteString(const std::string& value);
+
+    std::mutex mutex_;
+    std::ostream& output_;
+};
+
+class InputReader {
+public:
+    // reads and checks the header
+    explicit InputReader(std::istream& input);
+
+    // the next record or nullopt at the end of the log, a broken record throws InputLogError
+    std::optional<InputRecord> Next();
+
+private:
+    uint8_t ReadByte();
+    uint64_t ReadVarint();
+    uint64_t ReadFixed();
+    std::string ReadString();
+
+    std::istream& input_;
+};
+
+struct ReplayStats {
+    size_t joins = 0;
+    size_t moves = 0;
+    size_t ticks = 0;
+    // game time covered by the ticks
+    double game_time = 0.;
+    // wall time spent in Game::UpdateTime
+    std::chrono::nanoseconds tick_time{};
+    std::chrono::nanoseconds total_time{};
+};
+
+// Re-executes a log against a game as fast as it can. The game has to be in the state the recorded
+// one was in when the recording started: loaded from the same config and restored from the same state.
+class InputReplayer {
+public:
+    explicit InputReplayer(model::Game& game);
+
+    void Apply(const InputRecord& record);
+    ReplayStats Replay(InputReader& reader);
+    const ReplayStats& GetStats() const noexcept {
+        return stats_;
+    }
+
+private:
+    model::Game& game_;
+    // recorded player id to the player of this game; players join the sessions they were recorded in,
+    // so the sessions get the ids and the random streams of the recorded ones
+    std::map<int, std::shared_ptr<app::Player>> players_;
+    ReplayStats stats_;
+};
+
+}  // namespace replay
@@ -0,0 +1,419 @@
+#include "journal.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+#include "little_endian.h"
+
+namespace serialization {
+
+using namespace std::literals;
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr std::string_view SEGMENT_SUFFIX = ".journal."sv;
+// kind byte and payload size
+constexpr size_t ENTRY_HEADER_SIZE = 5;
+
+class EntryWriter {
+public:
+    explicit EntryWriter(std::vector<char>& data) : data_(data) {
+    }
+
+    template <typename T>
+    void Put(T value) {
+        data_.resize(data_.size() + sizeof(T));
+        little_endian::Store<T>(data_.data() + data_.size() - sizeof(T), value);
+    }
+
+    void PutString(std::string_view value) {
+        Put<uint32_t>(static_cast<uint32_t>(value.size()));
+        data_.insert(data_.end(), value.begin(), value.end());
+    }
+
+    void PutPlayerState(const app::Player& player) {
+        const app::Coordinates coordinates = player.GetCoordinates();
+        const app::Speed speed = player.GetSpeed();
+        Put<int32_t>(player.GetScore());
+        Put<double>(player.GetIdleTime());
+        Put<double>(player.GetTotalTime());
+        Put<double>(coordinates.x);
+        Put<double>(coordinates.y);
+        Put<double>(speed.x);
+        Put<double>(speed.y);
+        Put<uint8_t>(static_cast<uint8_t>(player.GetDirection()));
+        const std::vector<model::Item> bag = player.GetBag();
+        Put<uint32_t>(static_cast<uint32_t>(bag.size()));
+        for (const model::Item& item : bag) {
+            PutItem(item);
+        }
+    }
+
+    void PutItem(const model::Item& item) {
+        Put<int32_t>(item.id);
+        Put<int32_t>(item.type);
+        Put<int32_t>(item.value);
+    }
+
+private:
+    std::vector<char>& data_;
+};
+
+class EntryReader {
+public:
+    explicit EntryReader(std::span<const char> data) : data_(data) {
+    }
+
+    bool AtEnd() const noexcept {
+        return position_ == data_.size();
+    }
+
+    template <typename T>
+    T Get() {
+        Require(sizeof(T));
+        const T value = little_endian::Load<T>(data_.data() + position_);
+        position_ += sizeof(T);
+        return value;
+    }
+
+    std::string GetString() {
+        const uint32_t length = Get<uint32_t>();
+        Require(length);
+        std::string value{data_.data() + position_, length};
+        position_ += length;
+        return value;
+    }
+
+    // the fields of PlayerState written by EntryWriter::PutPlayerState
+    void GetPlayerState(PlayerState& player) {
+        player.score = Get<int32_t>();
+        player.idle_time = Get<double>();
+        player.total_time = Get<double>();
+        player.coordinates.x = Get<double>();
+        player.coordinates.y = Get<double>();
+        player.speed.x = Get<double>();
+        player.speed.y = Get<double>();
+        const uint8_t direction = Get<uint8_t>();
+        if (direction > static_cast<uint8_t>(app::Direction::EAST)) {
+            throw JournalError("Journal has a wrong direction"s);
+        }
+        player.direction = static_cast<app::Direction>(direction);
+        const uint32_t bag_size = Get<uint32_t>();
+        Require(static_cast<size_t>(bag_size) * 3 * sizeof(int32_t));
+        player.bag.clear();
+        player.bag.reserve(bag_size);
+        for (uint32_t i = 0; i < bag_size; ++i) {
+            player.bag.push_back(GetItem());
+        }
+    }
+
+    model::Item GetItem() {
+        model::Item item;
+        item.id = Get<int32_t>();
+        item.type = Get<int32_t>();
+        item.value = Get<int32_t>();
+        return item;
+    }
+
+private:
+    void Require(size_t size) const {
+        if (data_.size() - position_ < size) {
+            throw JournalError("Journal record is cut short"s);
+        }
+    }
+
+    std::span<const char> data_;
+    size_t position_ = 0;
+};
+
+// applies the records to the state, keeping where every player is and the time of its last state
+class JournalReplayer {
+public:
+    explicit JournalReplayer(GameState& state) : state_(state) {
+        for (auto& [session_id, session] : state_.sessions) {
+            for (size_t i = 0; i < session.players.size(); ++i) {
+                players_[session.players[i].id] = {session_id, i, 0.};
+            }
+        }
+    }
+
+    void ApplyTick(EntryReader& entry, JournalReplayStats& stats) {
+        time_ += entry.Get<double>();
+        ++stats.ticks;
+        while (!entry.AtEnd()) {
+            ApplyRecord(entry);
+            ++stats.records;
+        }
+    }
+
+    // drops the players who have left and moves the rest to the time of the last tick
+    void Finish() {
+        for (auto& [session_id, session] : state_.sessions) {
+            size_t kept = 0;
+            for (size_t i = 0; i < session.players.size(); ++i) {
+                auto it = players_.find(session.players[i].id);
+                if (it == players_.end() || it->second.session_id != session_id || it->second.index != i) {
+                    continue;
+                }
+                if (kept != i) {
+                    session.players[kept] = std::move(session.players[i]);
+                }
+                // the dog went straight or stood still since its last state, a stop would have been recorded
+                AdvancePlayer(session.players[kept++], time_ - it->second.time);
+            }
+            session.players.resize(kept);
+        }
+    }
+
+private:
+    struct PlayerPlace {
+        int session_id = 0;
+        size_t index = 0;
+        // time of the last state of the player, the snapshot is at 0
+        double time = 0.;
+    };
+
+    void ApplyRecord(EntryReader& entry) {
+        switch (static_cast<JournalRecord>(entry.Get<uint8_t>())) {
+            case JournalRecord::JOIN: {
+                const int session_id = entry.Get<int32_t>();
+                SessionState& session = GetSession(session_id);
+                std::string map_id = entry.GetString();
+                if (session.map_id.empty()) {
+                    session.map_id = std::move(map_id);
+                }
+                const int player_id = entry.Get<int32_t>();
+                PlayerState& player = GetOrAddPlayer(session, player_id);
+                player.name = entry.GetString();
+                player.token = entry.GetString();
+                entry.GetPlayerState(player);
+                return;
+            }
+            case JournalRecord::PLAYER: {
+                const int player_id = entry.Get<int32_t>();
+                PlayerState scratch;
+                PlayerState* player = &scratch;
+                if (auto it = players_.find(player_id); it != players_.end()) {
+                    it->second.time = time_;
+                    player = &state_.sessions.at(it->second.session_id).players[it->second.index];
+                }
+                entry.GetPlayerState(*player);
+                return;
+            }
+            case JournalRecord::LEAVE:
+                players_.erase(entry.Get<int32_t>());
+                return;
+            case JournalRecord::LOOT: {
+                SessionState& session = GetSession(entry.Get<int32_t>());
+                model::LostObject object;
+                object.item = entry.GetItem();
+                object.coordinates.x = entry.Get<double>();
+                object.coordinates.y = entry.Get<double>();
+                session.loot[object.item.id] = object;
+                return;
+            }
+            case JournalRecord::LOOT_REMOVE: {
+                const int session_id = entry.Get<int32_t>();
+                const int item_id = entry.Get<int32_t>();
+                if (auto it = state_.sessions.find(session_id); it != state_.sessions.end()) {
+                    it->second.loot.erase(item_id);
+                }
+                return;
+            }
+        }
+        throw JournalError("Unknown journal record"s);
+    }
+
+    SessionState& GetSession(int session_id) {
+        SessionState& session = state_.sessions[session_id];
+        session.id = session_id;
+        return session;
+    }
+
+    PlayerState& GetOrAddPlayer(SessionState& session, int player_id) {
+        auto [it, inserted] = players_.try_emplace(player_id);
+        it->second.time = time_;
+        if (inserted || it->second.session_id != session.id) {
+            it->second.session_id = session.id;
+            it->second.index = session.players.size();
+            session.players.emplace_back().id = player_id;
+        }
+        return session.players[it->second.index];
+    }
+
+    GameState& state_;
+    double time_ = 0.;
+    std::unordered_map<int, PlayerPlace> players_;
+};
+
+std::optional<uint64_t> ParseSegmentGeneration(const std::string& file_name, const std::string& prefix) {
+    if (!file_name.starts_with(prefix) || file_name.size() == prefix.size()) {
+        return std::nullopt;
+    }
+    uint64_t generation = 0;
+    for (char c : std::string_view{file_name}.substr(prefix.size())) {
+        if (c < '0' || c > '9') {
+            return std::nullopt;
+        }
+        generation = generation * 10 + static_cast<uint64_t>(c - '0');
+    }
+    return generation;
+}
+
+std::vector<char> ReadFile(const std::string& path) {
+    std::ifstream file{path, std::ios::binary};
+    if (!file) {
+        throw JournalError("Failed to open "s + path);
+    }
+    return {std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+}
+
+}  // namespace
+
+Journal::Journal(std::string state_path) : state_path_(std::move(state_path)) {
+}
+
+uint64_t Journal::StartSegment() {
+    const std::vector<uint64_t> segments = FindJournalSegments(state_path_);
+    generation_ = std::max(generation_, segments.empty() ? 0 : segments.back()) + 1;
+    segment_.close();
+    const std::string path = GetJournalSegmentPath(state_path_, generation_);
+    segment_.open(path, std::ios::binary | std::ios::trunc);
+    if (!segment_) {
+        throw JournalError("Failed to open "s + path);
+    }
+    return generation_;
+}
+
+void Journal::RecordTick(model::Game& game, double time_delta) {
+    if (!segment_.is_open()) {
+        throw JournalError("Journal segment is not started"s);
+    }
+    entry_.assign(ENTRY_HEADER_SIZE, 0);
+    EntryWriter writer{entry_};
+    writer.Put<double>(time_delta);
+
+    for (const auto& [session_id, session] : game.GetSessions()) {
+        session->TakeChanges(changes_);
+        //players who joined and left within the tick are only left, a joined player has no other records
+        for (int player_id : changes_.joined_players) {
+            if (auto player = session->FindPlayer(player_id)) {
+                writer.Put<uint8_t>(static_cast<uint8_t>(JournalRecord::JOIN));
+                writer.Put<int32_t>(session_id);
+                writer.PutString(session->GetMapID());
+                writer.Put<int32_t>(player_id);
+                writer.PutString(player->GetName());
+                writer.PutString(player->GetToken());
+                writer.PutPlayerState(*player);
+            }
+        }
+        std::vector<int>& changed = changes_.changed_players;
+        std::sort(changed.begin(), changed.end());
+        changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+        for (int player_id : changed) {
+            const bool joined = std::find(changes_.joined_players.begin(), changes_.joined_players.end(), player_id) !=
+                                changes_.joined_players.end();
+            auto player = joined ? nullptr : session->FindPlayer(player_id);
+            if (player) {
+                writer.Put<uint8_t>(static_cast<uint8_t>(JournalRecord::PLAYER));
+                writer.Put<int32_t>(player_id);
+                writer.PutPlayerState(*player);
+            }
+        }
+        for (int player_id : changes_.left_players) {
+            writer.Put<uint8_t>(static_cast<uint8_t>(JournalRecord::LEAVE));
+            writer.Put<int32_t>(player_id);
+        }
+
+        const model::Game::LostObjects& loot = session->GetLostObjects();
+        for (int item_id : changes_.spawned_loot) {
+            if (auto it = loot.find(item_id); it != loot.end()) {
+                writer.Put<uint8_t>(static_cast<uint8_t>(JournalRecord::LOOT));
+                writer.Put<int32_t>(session_id);
+                writer.PutItem(it->second.item);
+                writer.Put<double>(it->second.coordinates.x);
+                writer.Put<double>(it->second.coordinates.y);
+            }
+        }
+        for (int item_id : changes_.removed_loot) {
+            writer.Put<uint8_t>(static_cast<uint8_t>(JournalRecord::LOOT_REMOVE));
+            writer.Put<int32_t>(session_id);
+            writer.Put<int32_t>(item_id);
+        }
+    }
+
+    little_endian::Store<uint8_t>(entry_.data(), static_cast<uint8_t>(JournalKind::TICK));
+    little_endian::Store<uint32_t>(entry_.data() + 1, static_cast<uint32_t>(entry_.size() - ENTRY_HEADER_SIZE));
+    if (!segment_.write(entry_.data(), static_cast<std::streamsize>(entry_.size())) || !segment_.flush()) {
+        throw JournalError("Failed to write the journal segment "s + std::to_string(generation_));
+    }
+}
+
+std::string GetJournalSegmentPath(const std::string& state_path, uint64_t generation) {
+    return state_path + std::string(SEGMENT_SUFFIX) + std::to_string(generation);
+}
+
+std::vector<uint64_t> FindJournalSegments(const std::string& state_path) {
+    const fs::path path{state_path};
+    const fs::path directory = path.has_parent_path() ? path.parent_path() : fs::path{"."};
+    const std::string prefix = path.filename().string() + std::string(SEGMENT_SUFFIX);
+
+    std::vector<uint64_t> generations;
+    std::error_code error;
+    for (const auto& file : fs::directory_iterator{directory, error}) {
+        if (auto generation = ParseSegmentGeneration(file.path().filename().string(), prefix)) {
+            generations.push_back(*generation);
+        }
+    }
+    std::sort(generations.begin(), generations.end());
+    return generations;
+}
+
+void RemoveJournalSegmentsBefore(const std::string& state_path, uint64_t generation) {
+    for (uint64_t segment : FindJournalSegments(state_path)) {
+        if (segment < generation) {
+            std::error_code error;
+            fs::remove(GetJournalSegmentPath(state_path, segment), error);
+        }
+    }
+}
+
+JournalReplayStats ReplayJournal(const std::string& state_path, GameState& state) {
+    JournalReplayStats stats;
+    if (state.journal_generation == 0) {
+        return stats;
+    }
+    JournalReplayer replayer{state};
+    for (uint64_t generation : FindJournalSegments(state_path)) {
+        if (generation < state.journal_generation) {
+            continue;
+        }
+        const std::vector<char> segment = ReadFile(GetJournalSegmentPath(state_path, generation));
+        ++stats.segments;
+        size_t position = 0;
+        while (segment.size() - position >= ENTRY_HEADER_SIZE) {
+            const auto kind = little_endian::Load<uint8_t>(segment.data() + position);
+            const size_t size = little_endian::Load<uint32_t>(segment.data() + position + 1);
+            if (segment.size() - position - ENTRY_HEADER_SIZE < size) {
+                break;
+            }
+            if (kind != static_cast<uint8_t>(JournalKind::TICK)) {
+                throw JournalError("Unknown journal entry"s);
+            }
+            EntryReader entry{std::span{segment}.subspan(position + ENTRY_HEADER_SIZE, size)};
+            replayer.ApplyTick(entry, stats);
+            position += ENTRY_HEADER_SIZE + size;
+        }
+    }
+    replayer.Finish();
+    return stats;
+}
+
+}  // namespace serialization
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "model.h"
+#include "snapshot.h"
+
+namespace serialization {
+
+// Append-only journal of the changes of the game between two snapshots.
+//
+// The journal is split into segments, the files <state path>.journal.<generation>. A snapshot
+// starts a new segment and keeps its generation, the state is the snapshot with its segment and
+// the later ones applied, so the older segments are removed once the snapshot is written.
+// A segment is a sequence of entries: a kind byte, the u32 size of the payload and the payload,
+// numbers are little-endian as in the snapshot. Every tick appends one TICK entry with the tick
+// delta and the records of the players and loot changed since the previous tick. A record keeps
+// the whole state of its player or item, so a record applied to a state that has it already
+// does no harm. Dogs going straight aren't recorded, their last record and the time passed since
+// it give their position. An entry cut short by a crash ends the segment.
+enum class JournalKind : uint8_t {
+    TICK = 1,        // time_delta, then the records
+};
+
+enum class JournalRecord : uint8_t {
+    JOIN = 1,        // session_id, map_id, player_id, name, token, player state
+    PLAYER = 2,      // player_id, player state
+    LEAVE = 3,       // player_id
+    LOOT = 4,        // session_id, item id, type, value, x, y
+    LOOT_REMOVE = 5, // session_id, item id
+};
+// player state: score, idle_time, total_time, x, y, speed x, speed y, direction byte,
+// the count of bag items and their id, type and value
+
+class JournalError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// Writes the segments. The changes are taken from the sessions of the game,
+// so it should track them, see Game::SetChangeTracking.
+class Journal {
+public:
+    explicit Journal(std::string state_path);
+
+    // closes the current segment and opens the next one, returns its generation;
+    // it is greater than the generations of all segments found next to the state file
+    uint64_t StartSegment();
+    uint64_t GetGeneration() const noexcept {
+        return generation_;
+    }
+    // appends the tick and the changes made since the previous one, the segment is flushed
+    void RecordTick(model::Game& game, double time_delta);
+
+private:
+    std::string state_path_;
+    uint64_t generation_ = 0;
+    std::ofstream segment_;
+    std::vector<char> entry_;
+    model::SessionChanges changes_;
+};
+
+struct JournalReplayStats {
+    size_t segments = 0;
+    size_t ticks = 0;
+    size_t records = 0;
+};
+
+std::string GetJournalSegmentPath(const std::string& state_path, uint64_t generation);
+// generations of the segments next to the state file in ascending order
+std::vector<uint64_t> FindJournalSegments(const std::string& state_path);
+// the segments older than generation are covered by the snapshot of that generation
+void RemoveJournalSegmentsBefore(const std::string& state_path, uint64_t generation);
+// Applies the segments of the snapshot generation and the later ones to the state decoded from it
+// and moves the dogs going straight to the time of the last tick. A snapshot of generation 0 was
+// written without the journal and is left as it is.
+JournalReplayStats ReplayJournal(const std::string& state_path, GameState& state);
+
+}  // namespace serialization
@@ -142,6 +142,42 @@ model::LootGeneratorConfig ParseLootGeneratorConfig(const boost::json::value& va
     return {period, probability};
 }
 
+model::SessionShardingConfig ParseSessionShardingConfig(const boost::json::value& value) {
+    model::SessionShardingConfig config;
+    if (!value.as_object().contains("sessionConfig")) {
+        return config;
+    }
+    const auto& session_config = value.as_object().at("sessionConfig").as_object();
+    if (session_config.contains("maxPlayers")) {
+        const int64_t max_players = session_config.at("maxPlayers").as_int64();
+        if (max_players < 1) {
+            throw InvalidConfigureFile("sessionConfig maxPlayers should be at least 1");
+        }
+        config.max_players = static_cast<size_t>(max_players);
+    }
+    if (session_config.contains("refillMargin")) {
+        const int64_t refill_margin = session_config.at("refillMargin").as_int64();
+        if (refill_margin < 0) {
+            throw InvalidConfigureFile("sessionConfig refillMargin should not be negative");
+        }
+        config.refill_margin = static_cast<size_t>(refill_margin);
+    }
+    if (session_config.contains("placement")) {
+        std::string placement = session_config.at("placement").as_string().c_str();
+        if (placement == "fillFirst") {
+            config.placement = model::SessionPlacement::FILL_FIRST;
+        } else if (placement == "leastLoaded") {
+            config.placement = model::SessionPlacement::LEAST_LOADED;
+        } else {
+            throw InvalidConfigureFile("incorrect sessionConfig placement");
+        }
+    }
+    if (config.max_players != 0 && config.refill_margin >= config.max_players) {
+        throw InvalidConfigureFile("sessionConfig refillMargin should be less than maxPlayers");
+    }
+    return config;
+}
+
 DefaultSettings ParseDefaultSettings(const boost::json::value& value) {
     DefaultSettings settings;
     if (value.as_object().contains("defaultDogSpeed")) {
@@ -164,8 +200,10 @@ model::Game LoadGame(const std::filesystem::path& json_path) {
     while (getline(File, line)) {
         result_line += line;
     }
-    auto value = json::parse(result_line);
+    return LoadGameFromJson(json::parse(result_line));
+}
 
+model::Game LoadGameFromJson(const boost::json::value& value) {
     model::Game game;    
     DefaultSettings default_settings = ParseDefaultSettings(value);
     LootObjectsInfo loot_info;
@@ -187,6 +225,10 @@ model::Game LoadGame(const std::filesystem::path& json_path) {
     }   
     game.SetLootObjectsInfo(loot_info);    
     game.SetLootGenerator(ParseLootGeneratorConfig(value));
+    game.SetSessionSharding(ParseSessionShardingConfig(value));
+    if (value.as_object().contains("randomSeed")) {
+        game.SetRandomSeed(value.as_object().at("randomSeed").to_number<uint64_t>());
+    }
 
     return game;
 }
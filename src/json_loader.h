@@ -1,5 +1,7 @@
 #pragma once
 
+#include <boost/json.hpp>
+
 #include <filesystem>
 #include <exception>
 #include <string>
@@ -39,6 +41,8 @@ struct DefaultSettings {
 };
 
 model::Game LoadGame(const std::filesystem::path& json_path);
+// the config already parsed, e.g. a generated one
+model::Game LoadGameFromJson(const boost::json::value& config);
 
 
 }  // namespace json_loader
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace serialization::little_endian {
+
+// Numbers of the state files are little-endian on any machine. They are stored byte by byte,
+// so the place in the buffer doesn't have to be aligned.
+
+template <typename T>
+using Bits = std::conditional_t<sizeof(T) == 8, uint64_t, std::conditional_t<sizeof(T) == 4, uint32_t, uint8_t>>;
+
+template <typename T>
+void Store(char* at, T value) {
+    static_assert(sizeof(T) == 1 || sizeof(T) == 4 || sizeof(T) == 8);
+    const auto bits = std::bit_cast<Bits<T>>(value);
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        at[i] = static_cast<char>(bits >> (8 * i));
+    }
+}
+
+template <typename T>
+T Load(const char* at) {
+    static_assert(sizeof(T) == 1 || sizeof(T) == 4 || sizeof(T) == 8);
+    Bits<T> bits = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        bits |= static_cast<Bits<T>>(static_cast<unsigned char>(at[i])) << (8 * i);
+    }
+    return std::bit_cast<T>(bits);
+}
+
+}  // namespace serialization::little_endian
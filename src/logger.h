@@ -31,6 +31,8 @@ namespace LoggerMessages {
     const std::string request_received = "request received"s;
     const std::string response_sent = "response sent"s;
     const std::string error = "error"s;
+    const std::string tick_overrun = "tick overrun"s;
+    const std::string state_restored = "state restored"s;
 }
 
 namespace LoggerJSONKeys {
@@ -48,6 +50,15 @@ namespace LoggerJSONKeys {
     const std::string exception = "exception"s;
     const std::string text = "text"s;
     const std::string where = "where"s;
+    const std::string substeps = "substeps"s;
+    const std::string dropped_steps = "dropped_steps"s;
+    const std::string dropped_time = "dropped_time"s;
+    const std::string sessions = "sessions"s;
+    const std::string players = "players"s;
+    const std::string loot = "loot"s;
+    const std::string journal_ticks = "journal_ticks"s;
+    const std::string restore_time = "restore_time"s;
+    const std::string players_per_second = "players_per_second"s;
 }
 
 void MyFormatter(logging::record_view const& rec, logging::formatting_ostream& strm);
@@ -7,7 +7,8 @@ namespace loot_gen {
 class LootGenerator {
 public:
     using RandomGenerator = std::function<double()>;
-    using TimeInterval = std::chrono::milliseconds;
+    // fractional milliseconds, ticks of any length add up without rounding
+    using TimeInterval = std::chrono::duration<double, std::milli>;
 
     LootGenerator(TimeInterval base_interval, double probability,
                   RandomGenerator random_gen = DefaultGenerator)
@@ -0,0 +1,96 @@
+#include "loot_index.h"
+#include "model.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace model {
+
+namespace {
+
+bool IsOnLine(double coord) {
+    return coord == std::floor(coord);
+}
+
+}  // namespace
+
+void LootIndex::Add(int id, app::Coordinates coordinates) {
+    if (IsOnLine(coordinates.x)) {
+        Line& line = vertical_lines_[static_cast<int>(coordinates.x)];
+        LineEntry entry{coordinates.y, id};
+        line.insert(std::upper_bound(line.begin(), line.end(), entry), entry);
+    } else if (IsOnLine(coordinates.y)) {
+        Line& line = horizontal_lines_[static_cast<int>(coordinates.y)];
+        LineEntry entry{coordinates.x, id};
+        line.insert(std::upper_bound(line.begin(), line.end(), entry), entry);
+    } else {
+        off_road_.push_back({id, coordinates});
+    }
+}
+
+void LootIndex::Remove(int id, app::Coordinates coordinates) {
+    auto remove_from_line = [id](std::map<int, Line>& lines, int key, double position) {
+        auto line_it = lines.find(key);
+        if (line_it == lines.end()) {
+            return;
+        }
+        Line& line = line_it->second;
+        auto it = std::lower_bound(line.begin(), line.end(), LineEntry{position, id});
+        //an empty line is kept, the loot spawned on it later reuses its storage
+        if (it != line.end() && it->id == id) {
+            line.erase(it);
+        }
+    };
+
+    if (IsOnLine(coordinates.x)) {
+        remove_from_line(vertical_lines_, static_cast<int>(coordinates.x), coordinates.y);
+    } else if (IsOnLine(coordinates.y)) {
+        remove_from_line(horizontal_lines_, static_cast<int>(coordinates.y), coordinates.x);
+    } else {
+        auto it = std::find_if(off_road_.begin(), off_road_.end(), [id](const Entry& entry) {
+            return entry.id == id;
+        });
+        if (it != off_road_.end()) {
+            off_road_.erase(it);
+        }
+    }
+}
+
+void LootIndex::Clear() {
+    vertical_lines_.clear();
+    horizontal_lines_.clear();
+    off_road_.clear();
+}
+
+void LootIndex::FindInRect(double min_x, double max_x, double min_y, double max_y, std::vector<Entry>& entries) const {
+    entries.clear();
+    FindOnLines(vertical_lines_, min_x, max_x, min_y, max_y, true, entries);
+    FindOnLines(horizontal_lines_, min_y, max_y, min_x, max_x, false, entries);
+    for (const auto& entry : off_road_) {
+        if (entry.coordinates.x >= min_x && entry.coordinates.x <= max_x &&
+            entry.coordinates.y >= min_y && entry.coordinates.y <= max_y) {
+            entries.push_back(entry);
+        }
+    }
+}
+
+void LootIndex::FindOnLines(const std::map<int, Line>& lines, double min_line, double max_line,
+                            double min_position, double max_position, bool vertical, std::vector<Entry>& entries) {
+    auto line_it = lines.lower_bound(static_cast<int>(std::ceil(min_line)));
+    for (; line_it != lines.end() && line_it->first <= max_line; ++line_it) {
+        const Line& line = line_it->second;
+        auto it = std::lower_bound(line.begin(), line.end(), min_position, [](const LineEntry& entry, double position) {
+            return entry.position < position;
+        });
+        for (; it != line.end() && it->position <= max_position; ++it) {
+            const double line_coord = static_cast<double>(line_it->first);
+            if (vertical) {
+                entries.push_back({it->id, {line_coord, it->position}});
+            } else {
+                entries.push_back({it->id, {it->position, line_coord}});
+            }
+        }
+    }
+}
+
+}  // namespace model
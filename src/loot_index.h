@@ -0,0 +1,51 @@
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "player.h"
+
+namespace model {
+
+// Spatial index of the lost objects of a session.
+// Loot is spawned on roads, so almost every object lies on a vertical line x = const
+// or on a horizontal line y = const. Objects are grouped by these lines and kept sorted
+// along the line, which turns the search around a dog's path into a few range queries:
+// one over the line the dog moves along and one per crossed perpendicular line.
+class LootIndex {
+public:
+    struct Entry {
+        int id;
+        app::Coordinates coordinates;
+    };
+
+    void Add(int id, app::Coordinates coordinates);
+    void Remove(int id, app::Coordinates coordinates);
+    void Clear();
+    // puts all objects inside the rectangle into entries, in no particular order
+    void FindInRect(double min_x, double max_x, double min_y, double max_y, std::vector<Entry>& entries) const;
+
+private:
+    struct LineEntry {
+        // coordinate along the line
+        double position;
+        int id;
+
+        bool operator<(const LineEntry& other) const {
+            return position < other.position || (position == other.position && id < other.id);
+        }
+    };
+    using Line = std::vector<LineEntry>;
+
+    static void FindOnLines(const std::map<int, Line>& lines, double min_line, double max_line,
+                            double min_position, double max_position, bool vertical, std::vector<Entry>& entries);
+
+    // x to objects on the line sorted by y
+    std::map<int, Line> vertical_lines_;
+    // y to objects on the line sorted by x
+    std::map<int, Line> horizontal_lines_;
+    // objects which are on no line, e.g. restored from an old state file
+    std::vector<Entry> off_road_;
+};
+
+}  // namespace model
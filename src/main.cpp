@@ -21,6 +21,9 @@ using namespace std::literals;
 
 namespace {
 
+// with the journal and no save state period the journal is compacted into a snapshot once a minute
+constexpr int JOURNAL_COMPACTION_PERIOD = 60'000;
+
 template <typename Fn>
 void RunWorkers(unsigned n, const Fn& fn) {
     n = std::max(1u, n);
@@ -65,8 +68,26 @@ try {
         model::Game game = json_loader::LoadGame(args.value().config_file_path);
         game.SetPlayersStartPointRandomizing(args.value().randomize_spawn_points);
         game.SetOnLeaveHandler(on_leave_db_handler);
+        game.SetTickThreads(args->tick_threads);
+        game.SetParallelSessionSize(args->parallel_session_players);
+        game.SetKineticMode(args->kinetic_events);
+        if (args->random_seed) {
+            game.SetRandomSeed(*args->random_seed);
+        }
         if (args->state_path_specified) {
-            serialization::RestoreGameState(args->state_path, game);
+            //the server can't take requests until the state is restored, so all cores are used for it
+            util::WorkStealingPool restore_pool{num_threads};
+            const serialization::RestoreStats stats = serialization::RestoreGameState(args->state_path, game, &restore_pool);
+            const double seconds = std::chrono::duration<double>(stats.duration).count();
+            boost::json::object restore_data;
+            restore_data.insert({{LoggerJSONKeys::sessions, stats.sessions}});
+            restore_data.insert({{LoggerJSONKeys::players, stats.players}});
+            restore_data.insert({{LoggerJSONKeys::loot, stats.loot}});
+            restore_data.insert({{LoggerJSONKeys::journal_ticks, stats.journal_ticks}});
+            restore_data.insert({{LoggerJSONKeys::restore_time, seconds * 1000.}});
+            restore_data.insert({{LoggerJSONKeys::players_per_second, seconds > 0. ? stats.players / seconds : 0.}});
+            BOOST_LOG_TRIVIAL(info) << logging::add_value(additional_data, restore_data)
+                                    << LoggerMessages::state_restored;
         }
 
         // 2. Initialize io_context
@@ -91,18 +112,33 @@ try {
         if (args->state_path_specified) save_state_path = args->state_path;
 
         auto application = std::make_shared<app::Application>(game, save_state_path, db_manager);
+        std::ofstream input_log;
+        if (!args->record_input_path.empty()) {
+            input_log.open(args->record_input_path, std::ios::binary | std::ios::trunc);
+            if (!input_log) {
+                throw std::runtime_error("Failed to open the input log "s + args->record_input_path);
+            }
+            application->StartRecording(std::make_shared<replay::InputRecorder>(input_log));
+        }
         auto api_handler = std::make_shared<http_handler::APIHandler>(application, !args.value().tick_period_specified);
         auto handler = std::make_shared<http_handler::RequestHandler>(api_handler, args->static_data_path, api_strand);
 
         // 5. Bind the game model state-saving handler to the game clock tick
         boost::signals2::connection connection;
 
-        if (args->save_state_period_specified) {
+        if (args->state_io_threads > 0) {
+            application->SplitStateBySessions(args->state_io_threads);
+        }
+        if (args->state_journal) {
+            application->StartJournal();
+        }
+        if (args->save_state_period_specified || args->state_journal) {
             auto save_handler = [&application, total = 0.,
-                                 save_period = args->save_state_period](double time_delta) mutable {
+                                 save_period = args->save_state_period_specified ? args->save_state_period
+                                                                                 : JOURNAL_COMPACTION_PERIOD](double time_delta) mutable {
                 total += time_delta;
-                if(total > save_period) {
-                    application->SaveState();
+                //a save skipped while the previous one is being written is retried on the next tick
+                if(total > save_period && application->SaveState()) {
                     total = 0.;
                 };
             };            
@@ -115,9 +151,20 @@ try {
 
         // 5. Start updating the state of players and items at the specified interval
         if (args.value().tick_period_specified) {
-            std::shared_ptr<Ticker> ticker = std::make_shared<Ticker>(api_strand,std::chrono::milliseconds(args->tick_period), [&application](std::chrono::milliseconds period) {
-                                                                                            application->UpdateTime(period.count());
+            std::shared_ptr<Ticker> ticker = std::make_shared<Ticker>(api_strand,std::chrono::milliseconds(args->tick_period), [&application](double delta) {
+                                                                                            application->UpdateTime(delta);
             });
+            if (args->fixed_step_specified) {
+                auto step = std::chrono::duration_cast<Ticker::Clock::duration>(std::chrono::duration<double, std::milli>(args->fixed_step));
+                ticker->SetFixedStep(step, args->max_substeps, [](const Ticker::Overrun& overrun) {
+                    boost::json::object overrun_data;
+                    overrun_data.insert({{LoggerJSONKeys::substeps, overrun.substeps}});
+                    overrun_data.insert({{LoggerJSONKeys::dropped_steps, overrun.dropped_steps}});
+                    overrun_data.insert({{LoggerJSONKeys::dropped_time, overrun.dropped_time}});
+                    BOOST_LOG_TRIVIAL(info) << logging::add_value(additional_data, overrun_data)
+                                            << LoggerMessages::tick_overrun;
+                });
+            }
             ticker->Start(); 
         }            
         
@@ -142,7 +189,7 @@ try {
 
         // 8. Save the game state to a file before shutting down the program
         if (args->state_path_specified) {
-            application->SaveState();
+            application->SaveStateAndWait();
         }       
     } catch (const std::exception& ex) {
         boost::json::object server_stop_data;
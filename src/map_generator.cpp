@@ -0,0 +1,289 @@
+#include "map_generator.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <set>
+#include <stdexcept>
+#include <utility>
+
+#include "fast_random.h"
+
+namespace map_gen {
+
+using namespace std::literals;
+
+namespace {
+
+// share of side street pieces of the city left in place
+constexpr double CITY_STREET_SHARE = 0.8;
+// every such line of the city is an avenue crossing the whole map
+constexpr size_t CITY_AVENUE_EVERY = 4;
+// office tries per office before giving up on finding a free place
+constexpr size_t OFFICE_ATTEMPTS = 100;
+
+const std::vector<std::string> LOOT_COLORS = {"#338844"s, "#883344"s, "#334488"s, "#888833"s, "#338888"s, "#883388"s};
+
+int RandomInRange(util::FastRandom& random, int min, int max) {
+    return min + static_cast<int>(random.NextIndex(static_cast<size_t>(max - min) + 1));
+}
+
+void AddGridRoads(const MapOptions& options, GeneratedMap& map) {
+    for (int y = 0; y <= options.height; y += options.block_size) {
+        map.roads.emplace_back(model::Road::HORIZONTAL, model::Point{0, y}, options.width);
+    }
+    for (int x = 0; x <= options.width; x += options.block_size) {
+        map.roads.emplace_back(model::Road::VERTICAL, model::Point{x, 0}, options.height);
+    }
+    if (!options.buildings || options.block_size <= 4) {
+        return;
+    }
+    for (int y = 0; y + options.block_size <= options.height; y += options.block_size) {
+        for (int x = 0; x + options.block_size <= options.width; x += options.block_size) {
+            map.buildings.emplace_back(model::Rectangle{model::Point{x + 2, y + 2},
+                                                        model::Size{options.block_size - 4, options.block_size - 4}});
+        }
+    }
+}
+
+void AddStreetRoads(const MapOptions& options, util::FastRandom& random, GeneratedMap& map) {
+    map.roads.emplace_back(model::Road::HORIZONTAL, model::Point{0, options.height / 2}, options.width);
+    const size_t max_attempts = options.streets_count * 10;
+    for (size_t attempt = 0; map.roads.size() < options.streets_count && attempt < max_attempts; ++attempt) {
+        // a new street starts on an existing one, so all of them stay connected
+        const model::Road& base = map.roads[random.NextIndex(map.roads.size())];
+        const model::Point from = base.GetStart();
+        const model::Point to = base.GetEnd();
+        const int length = RandomInRange(random, options.block_size, options.block_size * 10);
+        const bool forward = random.NextIndex(2) == 0;
+        if (base.IsHorizontal()) {
+            const model::Point start{RandomInRange(random, std::min(from.x, to.x), std::max(from.x, to.x)), from.y};
+            const int end = std::clamp(start.y + (forward ? length : -length), 0, options.height);
+            if (end != start.y) {
+                map.roads.emplace_back(model::Road::VERTICAL, start, end);
+            }
+        } else {
+            const model::Point start{from.x, RandomInRange(random, std::min(from.y, to.y), std::max(from.y, to.y))};
+            const int end = std::clamp(start.x + (forward ? length : -length), 0, options.width);
+            if (end != start.x) {
+                map.roads.emplace_back(model::Road::HORIZONTAL, start, end);
+            }
+        }
+    }
+    if (!options.buildings) {
+        return;
+    }
+    // a house along every street
+    for (const model::Road& road : map.roads) {
+        const model::Point start = road.GetStart();
+        const model::Point end = road.GetEnd();
+        if (road.IsHorizontal()) {
+            const int length = std::min(std::abs(end.x - start.x), 8);
+            map.buildings.emplace_back(model::Rectangle{model::Point{std::min(start.x, end.x), start.y + 2}, model::Size{length, 4}});
+        } else {
+            const int length = std::min(std::abs(end.y - start.y), 8);
+            map.buildings.emplace_back(model::Rectangle{model::Point{start.x + 2, std::min(start.y, end.y)}, model::Size{4, length}});
+        }
+    }
+}
+
+// positions of the lines of the city along one side, from 0 to extent
+std::vector<int> MakeCityLines(int extent, int block_size, util::FastRandom& random) {
+    std::vector<int> lines{0};
+    const int min_block = std::max(2, block_size / 2);
+    while (lines.back() < extent) {
+        lines.push_back(std::min(extent, lines.back() + RandomInRange(random, min_block, min_block + block_size)));
+    }
+    return lines;
+}
+
+bool IsAvenue(size_t line, size_t lines_count) {
+    return line % CITY_AVENUE_EVERY == 0 || line + 1 == lines_count;
+}
+
+// roads along one line of the city; `across` are the positions of the crossing lines
+template <typename MakeRoad>
+void AddCityLine(size_t line, size_t lines_count, const std::vector<int>& across, util::FastRandom& random,
+                 const MakeRoad& make_road) {
+    if (IsAvenue(line, lines_count)) {
+        make_road(across.front(), across.back());
+        return;
+    }
+    // side streets are cut into pieces between crossings, a run of the pieces left becomes a road
+    // if it reaches an avenue, the others would be cut off from the rest of the city
+    size_t run_start = 0;
+    bool in_run = false;
+    for (size_t piece = 0; piece + 1 < across.size(); ++piece) {
+        const bool kept = random.NextDouble() < CITY_STREET_SHARE;
+        if (kept && !in_run) {
+            run_start = piece;
+            in_run = true;
+        }
+        if (!in_run || (kept && piece + 2 < across.size())) {
+            continue;
+        }
+        // crossing the run ends at
+        const size_t run_end = kept ? piece + 1 : piece;
+        bool reaches_avenue = false;
+        for (size_t crossing = run_start; crossing <= run_end; ++crossing) {
+            reaches_avenue = reaches_avenue || IsAvenue(crossing, across.size());
+        }
+        if (reaches_avenue) {
+            make_road(across[run_start], across[run_end]);
+        }
+        in_run = false;
+    }
+}
+
+void AddCityRoads(const MapOptions& options, util::FastRandom& random, GeneratedMap& map) {
+    const std::vector<int> columns = MakeCityLines(options.width, options.block_size, random);
+    const std::vector<int> rows = MakeCityLines(options.height, options.block_size, random);
+    for (size_t row = 0; row < rows.size(); ++row) {
+        AddCityLine(row, rows.size(), columns, random, [&](int from, int to) {
+            map.roads.emplace_back(model::Road::HORIZONTAL, model::Point{from, rows[row]}, to);
+        });
+    }
+    for (size_t column = 0; column < columns.size(); ++column) {
+        AddCityLine(column, columns.size(), rows, random, [&](int from, int to) {
+            map.roads.emplace_back(model::Road::VERTICAL, model::Point{columns[column], from}, to);
+        });
+    }
+    if (!options.buildings) {
+        return;
+    }
+    for (size_t row = 0; row + 1 < rows.size(); ++row) {
+        for (size_t column = 0; column + 1 < columns.size(); ++column) {
+            const int width = columns[column + 1] - columns[column] - 2;
+            const int height = rows[row + 1] - rows[row] - 2;
+            if (width > 0 && height > 0) {
+                map.buildings.emplace_back(model::Rectangle{model::Point{columns[column] + 1, rows[row] + 1},
+                                                            model::Size{width, height}});
+            }
+        }
+    }
+}
+
+void AddOffices(const MapOptions& options, util::FastRandom& random, GeneratedMap& map) {
+    std::set<std::pair<int, int>> taken;
+    for (size_t attempt = 0; map.offices.size() < options.offices_count && attempt < options.offices_count * OFFICE_ATTEMPTS;
+         ++attempt) {
+        const model::Road& road = map.roads[random.NextIndex(map.roads.size())];
+        const model::Point start = road.GetStart();
+        const model::Point end = road.GetEnd();
+        const model::Point position{RandomInRange(random, std::min(start.x, end.x), std::max(start.x, end.x)),
+                                    RandomInRange(random, std::min(start.y, end.y), std::max(start.y, end.y))};
+        if (!taken.emplace(position.x, position.y).second) {
+            continue;
+        }
+        const model::Offset offset = road.IsHorizontal() ? model::Offset{0, RandomInRange(random, 1, 5)}
+                                                         : model::Offset{RandomInRange(random, 1, 5), 0};
+        map.offices.emplace_back(model::Office::Id{"o"s + std::to_string(map.offices.size())}, position, offset);
+    }
+}
+
+}  // namespace
+
+Layout ParseLayout(std::string_view name) {
+    if (name == "grid"sv) {
+        return Layout::GRID;
+    }
+    if (name == "streets"sv) {
+        return Layout::STREETS;
+    }
+    if (name == "city"sv) {
+        return Layout::CITY;
+    }
+    throw std::invalid_argument("Unknown map layout "s + std::string(name));
+}
+
+GeneratedMap GenerateMap(const MapOptions& options) {
+    if (options.width <= 0 || options.height <= 0 || options.block_size <= 0) {
+        throw std::invalid_argument("Map sizes should be positive"s);
+    }
+    if (options.loot_types_count == 0) {
+        throw std::invalid_argument("Map should have loot types"s);
+    }
+    util::FastRandom random{options.seed};
+    GeneratedMap map;
+    switch (options.layout) {
+        case Layout::GRID:
+            AddGridRoads(options, map);
+            break;
+        case Layout::STREETS:
+            AddStreetRoads(options, random, map);
+            break;
+        case Layout::CITY:
+            AddCityRoads(options, random, map);
+            break;
+    }
+    AddOffices(options, random, map);
+    return map;
+}
+
+boost::json::object MakeMapJson(const MapOptions& options, const GeneratedMap& map) {
+    boost::json::object map_json;
+    map_json["id"] = options.id;
+    map_json["name"] = options.name;
+    map_json["dogSpeed"] = options.dog_speed;
+    map_json["bagCapacity"] = options.bag_capacity;
+
+    boost::json::array loot_types;
+    for (size_t i = 0; i < options.loot_types_count; ++i) {
+        loot_types.emplace_back(boost::json::object{{"name", "loot"s + std::to_string(i)},
+                                                    {"file", "assets/key.obj"},
+                                                    {"type", "obj"},
+                                                    {"rotation", 0},
+                                                    {"color", LOOT_COLORS[i % LOOT_COLORS.size()]},
+                                                    {"scale", 0.03},
+                                                    {"value", static_cast<int>(10 * (i + 1))}});
+    }
+    map_json["lootTypes"] = std::move(loot_types);
+
+    boost::json::array roads;
+    for (const model::Road& road : map.roads) {
+        const model::Point start = road.GetStart();
+        const model::Point end = road.GetEnd();
+        if (road.IsHorizontal()) {
+            roads.emplace_back(boost::json::object{{"x0", start.x}, {"y0", start.y}, {"x1", end.x}});
+        } else {
+            roads.emplace_back(boost::json::object{{"x0", start.x}, {"y0", start.y}, {"y1", end.y}});
+        }
+    }
+    map_json["roads"] = std::move(roads);
+
+    boost::json::array buildings;
+    for (const model::Building& building : map.buildings) {
+        const model::Rectangle& bounds = building.GetBounds();
+        buildings.emplace_back(boost::json::object{{"x", bounds.position.x},
+                                                   {"y", bounds.position.y},
+                                                   {"w", bounds.size.width},
+                                                   {"h", bounds.size.height}});
+    }
+    map_json["buildings"] = std::move(buildings);
+
+    boost::json::array offices;
+    for (const model::Office& office : map.offices) {
+        offices.emplace_back(boost::json::object{{"id", *office.GetId()},
+                                                 {"x", office.GetPosition().x},
+                                                 {"y", office.GetPosition().y},
+                                                 {"offsetX", office.GetOffset().dx},
+                                                 {"offsetY", office.GetOffset().dy}});
+    }
+    map_json["offices"] = std::move(offices);
+    return map_json;
+}
+
+boost::json::object MakeConfigJson(const std::vector<MapOptions>& maps, const ConfigOptions& config) {
+    boost::json::object config_json;
+    config_json["defaultDogSpeed"] = config.default_dog_speed;
+    config_json["lootGeneratorConfig"] = boost::json::object{{"period", config.loot_period},
+                                                             {"probability", config.loot_probability}};
+    config_json["dogRetirementTime"] = config.retirement_time;
+    boost::json::array maps_json;
+    for (const MapOptions& options : maps) {
+        maps_json.emplace_back(MakeMapJson(options, GenerateMap(options)));
+    }
+    config_json["maps"] = std::move(maps_json);
+    return config_json;
+}
+
+}  // namespace map_gen
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <boost/json.hpp>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "model.h"
+
+namespace map_gen {
+
+enum class Layout {
+    // roads at equal distances in both directions
+    GRID,
+    // a road grows from a random point of an earlier one, like streets of a village
+    STREETS,
+    // blocks of different sizes, with long avenues and side streets broken off at places
+    CITY,
+};
+
+// "grid", "streets" or "city"
+Layout ParseLayout(std::string_view name);
+
+struct MapOptions {
+    std::string id = "generated";
+    std::string name = "Generated map";
+    Layout layout = Layout::GRID;
+    int width = 1000;
+    int height = 1000;
+    // distance between parallel roads of the grid, the average one of the city
+    int block_size = 20;
+    // roads of the streets layout
+    size_t streets_count = 2000;
+    size_t offices_count = 20;
+    size_t loot_types_count = 4;
+    bool buildings = true;
+    // in units per second, as in the config
+    double dog_speed = 4.;
+    int bag_capacity = 3;
+    uint64_t seed = 1;
+};
+
+struct ConfigOptions {
+    double default_dog_speed = 3.;
+    // in seconds
+    double loot_period = 5.;
+    double loot_probability = 0.5;
+    double retirement_time = 60.;
+};
+
+// all roads of a generated map are connected, offices stand on roads
+struct GeneratedMap {
+    std::vector<model::Road> roads;
+    std::vector<model::Building> buildings;
+    std::vector<model::Office> offices;
+};
+
+GeneratedMap GenerateMap(const MapOptions& options);
+
+// the map in the format of a map of the config, with loot_types_count loot types
+boost::json::object MakeMapJson(const MapOptions& options, const GeneratedMap& map);
+
+// a config json_loader::LoadGame accepts, the maps are generated from the options
+boost::json::object MakeConfigJson(const std::vector<MapOptions>& maps, const ConfigOptions& config = {});
+
+}  // namespace map_gen
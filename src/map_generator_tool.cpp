@@ -0,0 +1,93 @@
+#include <boost/program_options.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "map_generator.h"
+
+using namespace std::literals;
+
+namespace {
+
+struct GeneratorArgs {
+    map_gen::MapOptions map;
+    map_gen::ConfigOptions config;
+    std::string layout = "grid"s;
+    size_t maps_count = 1;
+    std::string output_path;
+};
+
+[[nodiscard]] std::optional<GeneratorArgs> ParseCommandLine(int argc, const char* const argv[]) {
+    namespace po = boost::program_options;
+
+    po::options_description desc{"Writes a game config with generated maps.\nAllowed options"s};
+
+    GeneratorArgs args;
+    desc.add_options()
+        ("help,h", "produce help message")
+        ("layout,l", po::value(&args.layout)->value_name("layout"s), "grid, streets or city")
+        ("width", po::value(&args.map.width)->value_name("units"s), "width of a map")
+        ("height", po::value(&args.map.height)->value_name("units"s), "height of a map")
+        ("block-size", po::value(&args.map.block_size)->value_name("units"s), "distance between parallel roads of the grid, average one of the city")
+        ("streets", po::value(&args.map.streets_count)->value_name("roads"s), "roads of the streets layout")
+        ("offices", po::value(&args.map.offices_count)->value_name("offices"s), "offices per map")
+        ("loot-types", po::value(&args.map.loot_types_count)->value_name("types"s), "loot types per map")
+        ("no-buildings", "leave the maps without buildings")
+        ("maps", po::value(&args.maps_count)->value_name("maps"s), "number of maps, each one made from its own seed")
+        ("seed", po::value(&args.map.seed)->value_name("seed"s), "seed of the first map")
+        ("dog-speed", po::value(&args.map.dog_speed)->value_name("speed"s), "dog speed of the maps")
+        ("loot-period", po::value(&args.config.loot_period)->value_name("seconds"s), "period of the loot generator")
+        ("loot-probability", po::value(&args.config.loot_probability)->value_name("probability"s), "probability of the loot generator")
+        ("retirement-time", po::value(&args.config.retirement_time)->value_name("seconds"s), "dog retirement time")
+        ("output,o", po::value(&args.output_path)->value_name("file"s), "write the config to the file instead of the standard output");
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.contains("help"s)) {
+        std::cout << desc;
+        return std::nullopt;
+    }
+    if (vm.contains("no-buildings"s)) {
+        args.map.buildings = false;
+    }
+    args.map.layout = map_gen::ParseLayout(args.layout);
+    return args;
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+    try {
+        auto args = ParseCommandLine(argc, argv);
+        if (!args) {
+            return EXIT_SUCCESS;
+        }
+
+        std::vector<map_gen::MapOptions> maps;
+        for (size_t i = 0; i < args->maps_count; ++i) {
+            map_gen::MapOptions& map = maps.emplace_back(args->map);
+            map.id = "map"s + std::to_string(i + 1);
+            map.name = "Map "s + std::to_string(i + 1);
+            map.seed = args->map.seed + i;
+        }
+        const std::string config = boost::json::serialize(map_gen::MakeConfigJson(maps, args->config));
+
+        if (args->output_path.empty()) {
+            std::cout << config << std::endl;
+        } else {
+            std::ofstream output{args->output_path};
+            if (!(output << config << std::endl)) {
+                throw std::runtime_error("Failed to write the config to "s + args->output_path);
+            }
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
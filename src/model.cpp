@@ -1,16 +1,23 @@
 #include "model.h"
 #include "player.h"
+#include "simd_kernels.h"
 
 #include <stdexcept>
 #include <cmath>
+#include <functional>
 #include <limits>
+#include <tuple>
 
 namespace model {
 using namespace std::literals;
 
 int GameSession::session_id_counter_ = 0;
-int GameSession::loot_counter_ = 0;
 constexpr double EPSILON = 1e-6;
+constexpr double DOG_WIDTH = 0.3;
+constexpr double LOOT_WIDTH = 0.;
+constexpr double OFFICE_WIDTH = 0.25;
+// extra space around a dog's path compensating rounding errors in TryCollectPoint
+constexpr double GATHER_SEARCH_MARGIN = 1e-6;
 
 bool isFractionInRange(double num) {
     double intPart;
@@ -36,14 +43,7 @@ void Map::AddOffice(Office office) {
 
 void Map::AddRoad(const Road& road) {
     roads_.emplace_back(road);
-    
-    if (road.IsHorizontal()) {
-        road_ptrs_.push_back(std::make_shared<Road>(Road::HORIZONTAL, road.GetStart(), road.GetEnd().x));
-        horizontal_roads_[road.GetStart().y].push_back(road_ptrs_.back());
-    } else {
-        road_ptrs_.push_back(std::make_shared<Road>(Road::VERTICAL, road.GetStart(), road.GetEnd().y));
-        vertical_roads_[road.GetStart().x].push_back(road_ptrs_.back());
-    }
+    road_graph_.AddRoad(road);
 } 
 
 void Map::SetLootValues(const std::vector<int>& values) {
@@ -100,52 +100,31 @@ const Map::Offices& Map::GetOffices() const noexcept {
 
 
 PositionOnRoads Map::GetRoadsByCoordinates(app::Coordinates coordinates) const {
-    PositionOnRoads roads;
-    bool update_vertical = true;
-    bool update_horizontal = true;
-
-    if (isFractionInRange(coordinates.x)) {
-        update_vertical = false;
-    }
-    if (isFractionInRange(coordinates.y)) { 
-        update_horizontal = false;
-    }
-
-    int x = std::round(coordinates.x);
-    int y = std::round(coordinates.y);
-    
-    if(update_vertical) {
-        if (vertical_roads_.contains(x)) {
-            for (auto road : vertical_roads_.at(x)) {
-                double start_y = std::min(road->GetStart().y, road->GetEnd().y) - 0.4;
-                double end_y = std::max(road->GetStart().y, road->GetEnd().y) + 0.4;
-                if(static_cast<double>(y) >= start_y &&
-                   static_cast<double>(y) <= end_y) {
-                    roads.vertical = road;
-                    break;
-                }
-            }
-        }
-    }
-    if(update_horizontal) {
-        if (horizontal_roads_.contains(y)) {
-            for (auto road : horizontal_roads_.at(y)) {
-                double start_x = std::min(road->GetStart().x, road->GetEnd().x) - 0.4;
-                double end_x = std::max(road->GetStart().x, road->GetEnd().x) + 0.4;
-                if(static_cast<double>(x) >= start_x &&
-                   static_cast<double>(x) <= end_x) {
-                    roads.horizontal = road;
-                    break;
-                }
-            }
-        }
+    return road_graph_.Find(MakeRoadCell(coordinates));
+}
+
+int Map::GetRandomLootType(util::FastRandom& random) const {
+    return static_cast<int>(random.NextIndex(loot_number_));
+}
+
+void Map::BuildSpawnTable() {
+    std::vector<double> lengths;
+    lengths.reserve(roads_.size());
+    for (const Road& road : roads_) {
+        lengths.push_back(std::abs(road.GetEnd().x - road.GetStart().x) + std::abs(road.GetEnd().y - road.GetStart().y));
     }
-    return roads;
+    spawn_roads_ = util::AliasTable(lengths);
 }
 
-int Map::GetRandomLootType() const {
-    std::srand(static_cast<unsigned int>(std::time(nullptr)));    
-    return std::rand() % loot_number_;
+app::Coordinates Map::GetRandomRoadPoint(util::FastRandom& random) const {
+    if (spawn_roads_.Empty()) {
+        throw std::logic_error("Map "s + *id_ + " has no roads to spawn on"s);
+    }
+    const Road& road = roads_[spawn_roads_.Sample(random.NextDouble())];
+    const double fraction = random.NextDouble();
+    const double x = road.GetStart().x + fraction * (road.GetEnd().x - road.GetStart().x);
+    const double y = road.GetStart().y + fraction * (road.GetEnd().y - road.GetStart().y);
+    return {x, y};
 }
 
 void Game::AddMap(Map map) {
@@ -154,6 +133,8 @@ void Game::AddMap(Map map) {
         throw std::invalid_argument("Map with id "s + *map.GetId() + " already exists"s);
     } else {
         try {
+            map.BuildRoadJunctions();
+            map.BuildSpawnTable();
             maps_.emplace_back(std::move(map));
         } catch (...) {
             map_id_to_index_.erase(it);
@@ -189,37 +170,207 @@ const Map* Game::FindMap(const Map::Id& id) const noexcept {
     return nullptr;
 }
 
+void Game::SetSessionSharding(SessionShardingConfig config) {
+    session_sharding_ = config;
+}
+
 std::shared_ptr<GameSession> Game::AddSession(const Map* map) {
+    std::shared_ptr<GameSession> selected_session;
     if (map_to_sessions_.contains(map)) {
-        //returns the first session of the map
-        return id_to_sessions_.at(map_to_sessions_.at(map).at(0));
-    }       
-    std::shared_ptr<GameSession> session_ptr = std::make_shared<GameSession>(map, spawn_points_randomized_, loot_generator_);    
+        for (int id : map_to_sessions_.at(map)) {
+            const auto& session = id_to_sessions_.at(id);
+            if (!AcceptsPlayers(*session)) {
+                continue;
+            }
+            if (session_sharding_.placement == SessionPlacement::FILL_FIRST) {
+                //sessions are in creation order
+                selected_session = session;
+                break;
+            }
+            if (!selected_session || session->GetPlayersCount() < selected_session->GetPlayersCount()) {
+                selected_session = session;
+            }
+        }
+    }
+    if (!selected_session) {
+        selected_session = CreateSession(map, 0);
+    }
+    return selected_session;
+}
+
+std::shared_ptr<GameSession> Game::RestoreSession(const Map* map, int session_id) {
+    if (auto it = id_to_sessions_.find(session_id); it != id_to_sessions_.end()) {
+        if (it->second->GetMap() != map) {
+            throw std::invalid_argument("Session "s + std::to_string(session_id) + " belongs to another map"s);
+        }
+        return it->second;
+    }
+    return CreateSession(map, session_id);
+}
+
+std::shared_ptr<GameSession> Game::CreateSession(const Map* map, int session_id) {
+    auto loot_generator = std::make_shared<loot_gen::LootGenerator>(*loot_generator_);
+    std::shared_ptr<GameSession> session_ptr = session_id > 0
+        ? std::make_shared<GameSession>(session_id, map, spawn_points_randomized_, loot_generator)
+        : std::make_shared<GameSession>(map, spawn_points_randomized_, loot_generator);
+    session_ptr->SetKineticMode(kinetic_mode_);
+    session_ptr->SetChangeTracking(change_tracking_);
+    //the stream is keyed on the session id, so it doesn't depend on the order sessions are created or restored in
+    session_ptr->SetRandomStream(random_.MakeStream(util::RandomService::Purpose::SESSION,
+                                                    static_cast<uint64_t>(session_ptr->GetId())));
     id_to_sessions_[session_ptr->GetId()] = session_ptr;   
     map_to_sessions_[map].push_back(session_ptr->GetId()); 
+    //restored sessions may come in any order, keep the creation order
+    std::sort(map_to_sessions_[map].begin(), map_to_sessions_[map].end());
     return session_ptr;    
 }
 
+bool Game::AcceptsPlayers(const GameSession& session) {
+    const size_t max_players = session_sharding_.max_players;
+    if (max_players == 0) {
+        return true;
+    }
+    const size_t players_count = session.GetPlayersCount();
+    if (full_sessions_.contains(session.GetId())) {
+        if (players_count + session_sharding_.refill_margin > max_players) {
+            return false;
+        }
+        full_sessions_.erase(session.GetId());
+    }
+    return players_count < max_players;
+}
+
+void Game::UpdateSessionLoad(const GameSession& session) {
+    if (session_sharding_.max_players != 0 && session.GetPlayersCount() >= session_sharding_.max_players) {
+        full_sessions_.insert(session.GetId());
+    }
+}
+
 std::shared_ptr<app::Player> Game::JoinGame(const std::string& name, const Map* map) {
     std::shared_ptr<GameSession> session_ptr = AddSession(map);
     auto player = players_.AddPlayer(name, session_ptr);
+    UpdateSessionLoad(*session_ptr);
+    return player;
+}
+
+std::shared_ptr<app::Player> Game::JoinGame(const std::string& name, const Map* map, int session_id) {
+    std::shared_ptr<GameSession> session_ptr = RestoreSession(map, session_id);
+    auto player = players_.AddPlayer(name, session_ptr);
+    UpdateSessionLoad(*session_ptr);
     return player;
 }
 
 std::shared_ptr<app::Player> Game::InitializePlayerForRestore(std::string name,  
-                                            std::string token, int id, const Map* map) {
-    std::shared_ptr<GameSession> session_ptr = AddSession(map);
+                                            std::string token, int id, const Map* map, int session_id) {
+    std::shared_ptr<GameSession> session_ptr = session_id > 0 ? RestoreSession(map, session_id) : AddSession(map);
     auto player = players_.AddPlayer(name, token, id, session_ptr);
+    UpdateSessionLoad(*session_ptr);
     return player;
 }
 
+void Game::RestoreSessions(std::vector<RestoredSession> sessions, util::WorkStealingPool* pool) {
+    //sessions are created here, before the parallel part; a session keeps its saved id and so its random stream
+    std::vector<std::shared_ptr<GameSession>> targets;
+    targets.reserve(sessions.size());
+    size_t players_count = 0;
+    for (const RestoredSession& session : sessions) {
+        targets.push_back(RestoreSession(session.map, session.id));
+        players_count += session.players.size();
+    }
+    players_.Reserve(players_count);
+
+    //a session touches only its own dogs and loot, the players registry is filled after the join
+    std::vector<std::vector<std::shared_ptr<app::Player>>> players(sessions.size());
+    auto restore_session = [&](size_t i) {
+        RestoredSession& session = sessions[i];
+        players[i].reserve(session.players.size());
+        for (PlayerState& state : session.players) {
+            auto player = players_.MakePlayer(std::move(state.name), std::move(state.token), state.id);
+            player->SetSession(targets[i]);
+            player->RestoreScore(state.score, std::move(state.bag));
+            players[i].push_back(std::move(player));
+        }
+        targets[i]->RestoreDogs(players[i], session.players);
+        targets[i]->RestoreLostObjects(std::move(session.loot));
+    };
+    if (pool) {
+        pool->ParallelFor(sessions.size(), restore_session);
+    } else {
+        for (size_t i = 0; i < sessions.size(); ++i) {
+            restore_session(i);
+        }
+    }
+
+    for (size_t i = 0; i < targets.size(); ++i) {
+        for (const auto& player : players[i]) {
+            players_.RegisterPlayer(player);
+        }
+        UpdateSessionLoad(*targets[i]);
+    }
+}
+
 std::shared_ptr<app::Player> Game::GetPlayerByToken(const std::string& token) const {
     return players_.GetPlayerByToken(token);
 } 
 
 void Game::UpdateTime(double time_delta) {
-    for (auto [id, session] : id_to_sessions_ ) {
-        session->UpdateTime(time_delta);
+    if (!tick_pool_) {
+        for (auto [id, session] : id_to_sessions_ ) {
+            session->UpdateTime(time_delta);
+        }
+        return;
+    }
+
+    //large sessions get all threads one after another, the rest are ticked in parallel with each other
+    std::vector<GameSession*> sessions;
+    sessions.reserve(id_to_sessions_.size());
+    for (const auto& [id, session] : id_to_sessions_) {
+        if (parallel_session_size_ > 0 && session->GetPlayersCount() >= parallel_session_size_) {
+            session->Tick(time_delta, tick_pool_.get());
+        } else {
+            sessions.push_back(session.get());
+        }
+    }
+    tick_pool_->ParallelFor(sessions.size(), [&sessions, time_delta](size_t i) {
+        sessions[i]->Tick(time_delta);
+    });
+    //leaving the game touches the players registry and the database, so it's done after the join
+    for (const auto& [id, session] : id_to_sessions_) {
+        session->NotifyRetiredPlayers();
+    }
+}
+
+void Game::SetParallelSessionSize(size_t players_count) {
+    parallel_session_size_ = players_count;
+}
+
+void Game::SetKineticMode(bool enabled) {
+    kinetic_mode_ = enabled;
+    for (auto& [id, session] : id_to_sessions_) {
+        session->SetKineticMode(enabled);
+    }
+}
+
+void Game::SetChangeTracking(bool enabled) {
+    change_tracking_ = enabled;
+    for (auto& [id, session] : id_to_sessions_) {
+        session->SetChangeTracking(enabled);
+    }
+}
+
+void Game::SetRandomSeed(uint64_t seed) {
+    random_.SetSeed(seed);
+    players_.SetTokenRandomStream(random_.MakeStream(util::RandomService::Purpose::TOKENS));
+    for (auto& [id, session] : id_to_sessions_) {
+        session->SetRandomStream(random_.MakeStream(util::RandomService::Purpose::SESSION, static_cast<uint64_t>(id)));
+    }
+}
+
+void Game::SetTickThreads(unsigned threads_count) {
+    if (threads_count > 1) {
+        tick_pool_ = std::make_shared<util::WorkStealingPool>(threads_count);
+    } else {
+        tick_pool_.reset();
     }
 }
 
@@ -228,8 +379,11 @@ void Game::SetPlayersStartPointRandomizing(bool randomize_spawn_points) {
 }
 
 void  Game::RestoreLootForAllSessions(std::map<int, LostObjects> session_id_to_loot) {
-    for (const auto& [id, loot] : session_id_to_loot) {
-        id_to_sessions_.at(id)->RestoreLostObjects(loot);
+    for (auto& [id, loot] : session_id_to_loot) {
+        //sessions are restored with their players, loot of a session left without players is dropped
+        if (auto it = id_to_sessions_.find(id); it != id_to_sessions_.end()) {
+            it->second->RestoreLostObjects(std::move(loot));
+        }
     }
 }
 std::map<int, Game::LostObjects>   Game::RetrieveLootForBackup() const {
@@ -245,52 +399,148 @@ int GameSession::GetId() const {
 }
 
 void GameSession::AddPlayer(std::shared_ptr<app::Player>& player) {
-    players_.push_back(player);
-    UpdateRoadsDataForPlayer(player);
+    player->ReserveBag(map_->GetBagCapacity());
+    DogStore::Index index = dogs_.Add(player, GetSpawnCoordinates());
+    UpdateRoadsDataForDog(index);
+    ReserveGatherScratch();
 }
 
-void GameSession::RestoreLostObjects(std::map<int, LostObject> loot) {
-    loot_ = loot;
+void GameSession::RestoreDogState(DogStore::Index index, double idle_time, double total_time,
+                                  app::Coordinates coordinates, app::Speed speed, app::Direction direction) {
+    SetDogState(index, idle_time, total_time, coordinates, speed, direction);
+    UpdateRoadsDataForDog(index);
 }
 
-std::string GameSession::GetMapID() const {
-    return *(map_->GetId());
+void GameSession::RestoreDogs(std::span<const std::shared_ptr<app::Player>> players,
+                              std::span<const PlayerState> states) {
+    const DogStore::Index first = dogs_.Size();
+    dogs_.Reserve(first + players.size());
+    for (size_t i = 0; i < players.size(); ++i) {
+        const PlayerState& state = states[i];
+        players[i]->ReserveBag(map_->GetBagCapacity());
+        const DogStore::Index index = dogs_.Add(players[i], state.coordinates);
+        SetDogState(index, state.idle_time, state.total_time, state.coordinates, state.speed, state.direction);
+    }
+    UpdateRoadsDataForDogs(first);
+    ReserveGatherScratch();
 }
 
-std::vector<std::shared_ptr<app::Player>> GameSession::GetPlayers() const {
-    return  players_;
+void GameSession::ReserveGatherScratch() {
+    //loot is spawned only while there are fewer items than dogs, so a search finds no more items than that
+    const size_t items_count = std::max(dogs_.Size(), loot_.size());
+    GatherScratch& gather = scratch_.gather;
+    if (gather.candidates.capacity() >= items_count) {
+        return;
+    }
+    const size_t capacity = std::max(items_count, 2 * gather.candidates.capacity());
+    gather.candidates.reserve(capacity);
+    gather.items.Reserve(capacity + map_->GetOffices().size());
 }
 
-app::Coordinates GameSession::GetRandomCoordinates() const {
-    double x, y;
-    auto roads = map_->GetRoads();
+void GameSession::SetDogState(DogStore::Index index, double idle_time, double total_time,
+                              app::Coordinates coordinates, app::Speed speed, app::Direction direction) {
+    dogs_.idle_time[index] = idle_time;
+    dogs_.play_time[index] = total_time;
+    dogs_.x[index] = coordinates.x;
+    dogs_.y[index] = coordinates.y;
+    dogs_.speed_x[index] = speed.x;
+    dogs_.speed_y[index] = speed.y;
+    dogs_.direction[index] = direction;
+    dogs_.settled_at[index] = dogs_.time;
+    dogs_.UpdateActivity(index);
+    dogs_.UpdateRetirementTimer(index);
+    dogs_.MarkMotionChanged(index);
+}
+
+void GameSession::RestoreLostObjects(std::map<int, LostObject> loot) {
+    loot_.clear();
+    loot_index_.Clear();
+    for (const auto& [id, lost_object] : loot) {
+        AddLostObject(lost_object);
+    }
+    ReserveGatherScratch();
+    //the ways of the moving dogs are checked against the new loot at the next tick
+    for (DogStore::Index i : dogs_.active) {
+        dogs_.MarkMotionChanged(i);
+    }
+    //new loot ids continue after the restored ones
+    loot_counter_ = loot_.empty() ? 0 : loot_.rbegin()->first + 1;
+}
 
-    std::uniform_int_distribution<int> road_index_distribution(0, roads.size() - 1);
-    std::uniform_real_distribution<double> road_coordinates_distribution(0.0, 1.0);        
-    int road_index = road_index_distribution(generator_);
-    double random_number = road_coordinates_distribution(generator_);
+void GameSession::AddLostObject(const LostObject& lost_object) {
+    if (spare_loot_nodes_.empty()) {
+        loot_[lost_object.item.id] = lost_object;
+    } else {
+        //the node of a removed object is reused, spawning doesn't allocate
+        std::map<int, LostObject>::node_type node = std::move(spare_loot_nodes_.back());
+        spare_loot_nodes_.pop_back();
+        node.key() = lost_object.item.id;
+        node.mapped() = lost_object;
+        auto result = loot_.insert(std::move(node));
+        if (!result.inserted) {
+            result.position->second = lost_object;
+            spare_loot_nodes_.push_back(std::move(result.node));
+        }
+    }
+    loot_index_.Add(lost_object.item.id, lost_object.coordinates);
+    ++loot_version_;
+    if (changes_) {
+        changes_->spawned_loot.push_back(lost_object.item.id);
+    }
+}
 
-    auto road = roads.at(road_index);        
+void GameSession::RemoveLostObject(std::map<int, LostObject>::iterator it) {
+    ++loot_version_;
+    if (changes_) {
+        changes_->removed_loot.push_back(it->first);
+    }
+    loot_index_.Remove(it->first, it->second.coordinates);
+    spare_loot_nodes_.push_back(loot_.extract(it));
+}
 
-    if (road.IsVertical()) {
-        x = road.GetStart().x;
-        y = road.GetStart().y + random_number * (road.GetEnd().y - road.GetStart().y);
+void GameSession::SetChangeTracking(bool enabled) {
+    if (enabled == changes_.has_value()) {
+        return;
+    }
+    if (enabled) {
+        changes_.emplace();
+        dogs_.changes = &*changes_;
     } else {
-        y = road.GetStart().y;
-        x = road.GetStart().x + random_number * (road.GetEnd().x - road.GetStart().x);
+        dogs_.changes = nullptr;
+        changes_.reset();
     }
-    
-    return {x,y};
 }
 
-void GameSession::DeletePlayerFromSession(std::string token) {
-    auto it = std::find_if(players_.begin(), players_.end(),
-    [&token](const std::shared_ptr<app::Player>& player) {
-        return player->GetToken() == token; 
-    });
+void GameSession::TakeChanges(SessionChanges& changes) {
+    changes.Clear();
+    if (changes_) {
+        std::swap(changes, *changes_);
+    }
+}
+
+std::shared_ptr<app::Player> GameSession::FindPlayer(int player_id) const {
+    if (auto index = dogs_.FindById(player_id)) {
+        return dogs_.players[*index];
+    }
+    return nullptr;
+}
+
+std::string GameSession::GetMapID() const {
+    return *(map_->GetId());
+}
+
+std::vector<std::shared_ptr<app::Player>> GameSession::GetPlayers() const {
+    return  dogs_.players;
+}
 
-    if (it != players_.end()) {
-        players_.erase(it); 
+app::Coordinates GameSession::GetRandomCoordinates() const {
+    return map_->GetRandomRoadPoint(random_);
+}
+
+void GameSession::DeletePlayerFromSession(std::string token) {
+    if (auto index = dogs_.FindByToken(token)) {
+        kinetic_events_.Remove(dogs_.players[*index]->GetId());
+        dogs_.Remove(*index);
     }
 }
 
@@ -307,120 +557,544 @@ app::Coordinates GameSession::GetSpawnCoordinates() const {
     }
 }
 
-std::map<int, LostObject> GameSession::GetLostObjects() const {
-    return loot_;
-}
-
 double GameSession::GetMapSpeed() const {
     return map_->GetMapSpeed();
 }
 
-void GameSession::UpdateTime(double time_delta) {
-    collision_detector::GameItemGathererProvider provider;
-    std::map<int, int> items_index_to_loot;
-    std::map<int, std::shared_ptr<app::Player>> gatherer_index_to_player;
-    std::vector<std::shared_ptr<app::Player>> players_to_exclude;
+void GameSession::UpdateTime(double time_delta, util::WorkStealingPool* pool) {
+    Tick(time_delta, pool);
+    NotifyRetiredPlayers();
+}
+
+void GameSession::NotifyRetiredPlayers() {
+    for (const auto& player : retired_players_) {
+        player->LeaveGame();
+    }
+    retired_players_.clear();
+}
 
-    int items_counter = 0;
-    int gatherers_counter = 0;
+void GameSession::Tick(double time_delta, util::WorkStealingPool* pool) {
+    std::vector<DogStore::Index>& dogs_to_exclude = scratch_.dogs_to_exclude;
+    dogs_to_exclude.clear();
 
-    //update players position 
-    for (auto [player, roads] : player_to_roads_) {                   
-        MoveInfo move_info;
-        auto dir = player->GetDirection();
-        if (dir == app::Direction::WEST || dir == app::Direction::EAST) {
-            if(roads.horizontal) {
-                move_info = CalculateNewPosition(player->GetCoordinates(), player->GetSpeed(), time_delta, roads.horizontal);
-            } else {
-                move_info = CalculateNewPosition(player->GetCoordinates(), player->GetSpeed(), time_delta, roads.vertical);
-            }
+    const double idle_time_limit = map_->GetIdleTimeLimit();
+    if (kinetic_) {
+        //moving dogs are handled only at their events
+        ProcessKineticEvents(dogs_.time + time_delta);
+    } else {
+        dogs_.time += time_delta;
+    }
+
+    //stationary dogs only get idle time, it is charged lazily and their retirement timers fire
+    std::vector<DogStore::Index>& retirement_candidates = scratch_.retirement_candidates;
+    retirement_candidates.clear();
+    dogs_.FindRetirementCandidates(retirement_candidates);
+    for (DogStore::Index i : retirement_candidates) {
+        if (dogs_.GetIdleTime(i) >= idle_time_limit) {
+            RetireStationaryDog(i, idle_time_limit);
+            dogs_to_exclude.push_back(i);
         } else {
-            if (roads.vertical) {
-                move_info = CalculateNewPosition(player->GetCoordinates(), player->GetSpeed(), time_delta, roads.vertical);
+            //the deadline was rounded off earlier than the idle time sum, check again next tick
+            dogs_.UpdateRetirementTimer(i);
+        }
+    }
+
+    if (!kinetic_) {
+        MoveActiveDogs(time_delta, idle_time_limit, dogs_to_exclude, pool);
+    }
+
+    //exclude players
+    std::sort(dogs_to_exclude.begin(), dogs_to_exclude.end());
+    ExcludePlayers(dogs_to_exclude);
+
+    // moved loot generation after the logic of excluding players 
+    GenerateLoot(loot_gen::LootGenerator::TimeInterval{time_delta});
+}
+
+void GameSession::MoveActiveDogs(double time_delta, double idle_time_limit,
+                                 std::vector<DogStore::Index>& dogs_to_exclude, util::WorkStealingPool* pool) {
+    TickScratch& scratch = scratch_;
+
+    //moving dogs are visited in index order, it keeps the order of gather events
+    std::vector<DogStore::Index>& moving_dogs = scratch.moving_dogs;
+    moving_dogs.assign(dogs_.active.begin(), dogs_.active.end());
+    std::sort(moving_dogs.begin(), moving_dogs.end());
+    const size_t dogs_count = moving_dogs.size();
+
+    for (auto* column : {&scratch.x, &scratch.y, &scratch.speed_x, &scratch.speed_y, &scratch.min_x, &scratch.max_x,
+                         &scratch.min_y, &scratch.max_y, &scratch.end_x, &scratch.end_y, &scratch.duration}) {
+        column->resize(dogs_count);
+    }
+    scratch.road_end_met.resize(dogs_count);
+    scratch.road_indices.resize(dogs_count);
+    scratch.in_game.resize(dogs_count);
+    scratch.gatherers.resize(dogs_count);
+
+    //a range of dogs is moved and its gather events are found without touching other dogs and the loot,
+    //so the ranges can be handled in parallel
+    auto move_range = [&](size_t begin, size_t end, GatherScratch& gather,
+                          std::vector<collision_detector::GatheringEvent>& events) {
+        //position and road bounds of every dog's move, the dogs are then moved by a batch kernel
+        for (size_t k = begin; k < end; ++k) {
+            const DogStore::Index i = moving_dogs[k];
+            scratch.x[k] = dogs_.x[i];
+            scratch.y[k] = dogs_.y[i];
+            scratch.speed_x[k] = dogs_.speed_x[i];
+            scratch.speed_y[k] = dogs_.speed_y[i];
+            scratch.road_indices[k] = SelectRoadForMove(i);
+            if (scratch.road_indices[k] != NO_ROAD) {
+                const Road& road = map_->GetRoads()[scratch.road_indices[k]];
+                scratch.min_x[k] = std::min(road.GetStart().x, road.GetEnd().x) - 0.4;
+                scratch.max_x[k] = std::max(road.GetStart().x, road.GetEnd().x) + 0.4;
+                scratch.min_y[k] = std::min(road.GetStart().y, road.GetEnd().y) - 0.4;
+                scratch.max_y[k] = std::max(road.GetStart().y, road.GetEnd().y) + 0.4;
             } else {
-                move_info = CalculateNewPosition(player->GetCoordinates(), player->GetSpeed(), time_delta, roads.horizontal);
+                //the dog is off the roads and can't move
+                scratch.min_x[k] = scratch.max_x[k] = scratch.x[k];
+                scratch.min_y[k] = scratch.max_y[k] = scratch.y[k];
             }
         }
-        // This method returns false if the player has been idle for too long.
-        bool is_player_in_game = player->UpdatePosition(time_delta, move_info);
-         
-        //add player to provider
-        provider.AddGatherer({geom::Point2D(move_info.start_coordinates.x, move_info.start_coordinates.y), 
-                              geom::Point2D(move_info.end_coordinates.x, move_info.end_coordinates.y), 0.3});
-        gatherer_index_to_player[gatherers_counter++] = player;
-
-        UpdateRoadsDataForPlayer(player);
-        if (!is_player_in_game) {
-             players_to_exclude.push_back(player);
-        } 
-    }
+        simd::MoveBatch batch;
+        batch.count = end - begin;
+        batch.x = scratch.x.data() + begin;
+        batch.y = scratch.y.data() + begin;
+        batch.speed_x = scratch.speed_x.data() + begin;
+        batch.speed_y = scratch.speed_y.data() + begin;
+        batch.min_x = scratch.min_x.data() + begin;
+        batch.max_x = scratch.max_x.data() + begin;
+        batch.min_y = scratch.min_y.data() + begin;
+        batch.max_y = scratch.max_y.data() + begin;
+        batch.end_x = scratch.end_x.data() + begin;
+        batch.end_y = scratch.end_y.data() + begin;
+        batch.movement_duration = scratch.duration.data() + begin;
+        batch.road_end_met = scratch.road_end_met.data() + begin;
+        simd::CalculateNewPositions(batch, time_delta, EPSILON);
+
+        //update dogs position 
+        for (size_t k = begin; k < end; ++k) {
+            const DogStore::Index i = moving_dogs[k];
+            MoveInfo move_info{scratch.road_end_met[k] != 0, scratch.duration[k],
+                               {scratch.x[k], scratch.y[k]}, {scratch.end_x[k], scratch.end_y[k]}};
+            if (scratch.road_indices[k] == NO_ROAD) {
+                move_info = {false, 0., move_info.start_coordinates, move_info.start_coordinates};
+            }
+            scratch.in_game[k] = AdvanceDog(i, time_delta, move_info, idle_time_limit);
 
-    //add items to provider 
-    for (const auto& [id, loot] : loot_) {
-        collision_detector::Item item {geom::Point2D(loot.coordinates.x, loot.coordinates.y), 0.};
-        provider.AddItem(item);
-        items_index_to_loot[items_counter++] = id;
+            //gatherer index is the index in moving_dogs
+            scratch.gatherers[k] = {geom::Point2D(move_info.start_coordinates.x, move_info.start_coordinates.y),
+                                    geom::Point2D(move_info.end_coordinates.x, move_info.end_coordinates.y), DOG_WIDTH};
+            UpdateRoadsDataForDog(i);
+        }
+        FindGatherEvents(std::span{scratch.gatherers}.subspan(begin, end - begin), begin, gather, events);
+    };
+
+    std::vector<collision_detector::GatheringEvent>& events = scratch.events;
+    events.clear();
+    const size_t chunk_size = parallel_tick_chunk_;
+    if (pool && dogs_count >= 2 * chunk_size) {
+        ++parallel_ticks_;
+        const size_t chunks_count = (dogs_count + chunk_size - 1) / chunk_size;
+        scratch.chunk_gather.resize(chunks_count);
+        scratch.chunk_events.resize(chunks_count);
+        pool->ParallelFor(chunks_count, [&](size_t chunk) {
+            scratch.chunk_events[chunk].clear();
+            move_range(chunk * chunk_size, std::min(dogs_count, (chunk + 1) * chunk_size),
+                       scratch.chunk_gather[chunk], scratch.chunk_events[chunk]);
+        });
+        for (size_t chunk = 0; chunk < chunks_count; ++chunk) {
+            events.insert(events.end(), scratch.chunk_events[chunk].begin(), scratch.chunk_events[chunk].end());
+        }
+    } else {
+        move_range(0, dogs_count, scratch.gather, events);
     }
-    //add offices to provider 
-    for (const auto& office : map_->GetOffices()) {
-        collision_detector::Item item {geom::Point2D(office.GetPosition().x,office.GetPosition().y ), 0.25};
-        provider.AddItem(item);
-        items_counter++;
+    SortGatherEvents(events);
+
+    std::vector<DogStore::Index>& stopped_dogs = scratch.stopped_dogs;
+    stopped_dogs.clear();
+    for (size_t k = 0; k < dogs_count; ++k) {
+        const DogStore::Index i = moving_dogs[k];
+        if (!scratch.in_game[k]) {
+             dogs_to_exclude.push_back(i);
+        } 
+        if (dogs_.speed_x[i] == 0. && dogs_.speed_y[i] == 0.) {
+            stopped_dogs.push_back(i);
+        }
     }
-    //get gather events and process each event
-    auto events = collision_detector::FindGatherEvents(provider);
+
+    //process gather events one by one, the first dog to reach an item gets it
     for (const auto& event : events) {
-        auto player = gatherer_index_to_player.at(event.gatherer_id);
+        const auto& player = dogs_.players[moving_dogs[event.gatherer_id]];
         //collision with office
-        if (!items_index_to_loot.contains(event.item_id)) {
+        if (event.item_id == OFFICE_ITEM_ID) {
             player->ClearBag();
             continue;
         }
         //collision with item
         //if item hasn't been collected by other players yet and player's bag is not full
-        if (loot_.contains(items_index_to_loot.at(event.item_id)) &&
-            player->GetBag().size() < map_->GetBagCapacity()) {            
-            player->CollectItem(loot_.at(items_index_to_loot.at(event.item_id)).item);
+        auto loot_it = loot_.find(static_cast<int>(event.item_id));
+        if (loot_it != loot_.end() &&
+            player->GetBagSize() < static_cast<size_t>(map_->GetBagCapacity())) {            
+            player->CollectItem(loot_it->second.item);
             //delete item from map
-            loot_.erase(items_index_to_loot.at(event.item_id));    
+            RemoveLostObject(loot_it);
         }           
     }
-    //exclude players
-    ExcludePlayers(players_to_exclude);
+    for (DogStore::Index i : stopped_dogs) {
+        dogs_.UpdateActivity(i);
+        dogs_.MarkChanged(i);
+    }
+}
 
-    // moved loot generation after the logic of excluding players 
-    GenerateLoot(std::chrono::milliseconds(
-        static_cast<uint64_t>(std::lround(time_delta))
-    ));
+void GameSession::SetKineticMode(bool enabled) {
+    if (kinetic_ == enabled) {
+        return;
+    }
+    kinetic_ = enabled;
+    dogs_.track_motion_changes = enabled;
+    for (DogStore::Index i : dogs_.active) {
+        if (enabled) {
+            dogs_.MarkMotionChanged(i);
+        } else {
+            dogs_.Settle(i);
+            UpdateRoadsDataForDog(i);
+            kinetic_events_.Cancel(dogs_.players[i]->GetId());
+        }
+    }
 }
 
-void GameSession::ExcludePlayers(const std::vector<std::shared_ptr<app::Player>>& players_to_exclude) {
-    for (const auto& player : players_to_exclude) {
-        DeletePlayerFromSession(player->GetToken());
-        UpdateRoadsDataForPlayer(player, true);
-        player->LeaveGame();
+void GameSession::ProcessKineticEvents(double now) {
+    //dogs whose speed has been changed between the ticks start their ways at the current session time
+    std::vector<DogStore::Index>& changed_dogs = scratch_.changed_dogs;
+    changed_dogs.clear();
+    dogs_.TakeMotionChanges(changed_dogs);
+    for (DogStore::Index i : changed_dogs) {
+        const int player_id = dogs_.players[i]->GetId();
+        if (!dogs_.IsActive(i)) {
+            kinetic_events_.Cancel(player_id);
+            continue;
+        }
+        dogs_.Settle(i);
+        UpdateRoadsDataForDog(i);
+        PredictKineticEvent(i, true);
+        if (dogs_.IsActive(i)) {
+            kinetic_events_.Schedule(player_id, dogs_.event_time[i]);
+        }
+    }
+
+    std::vector<int>& fired_ids = scratch_.fired_ids;
+    fired_ids.clear();
+    kinetic_events_.Advance(now, fired_ids);
+    //events are handled in the order of time, ties in the order of player ids;
+    //an event may be followed by another one of the same dog before now
+    using Event = TickScratch::KineticEventEntry;
+    std::vector<Event>& events = scratch_.kinetic_queue;
+    events.clear();
+    for (int player_id : fired_ids) {
+        events.emplace_back(dogs_.event_time[dogs_.GetIndexById(player_id)], player_id);
+    }
+    std::make_heap(events.begin(), events.end(), std::greater<Event>{});
+    while (!events.empty()) {
+        std::pop_heap(events.begin(), events.end(), std::greater<Event>{});
+        const auto [event_time, player_id] = events.back();
+        events.pop_back();
+        const DogStore::Index i = dogs_.GetIndexById(player_id);
+        dogs_.time = event_time;
+        HandleKineticEvent(i);
+        if (!dogs_.IsActive(i)) {
+            continue;
+        }
+        if (dogs_.event_time[i] <= now) {
+            events.emplace_back(dogs_.event_time[i], player_id);
+            std::push_heap(events.begin(), events.end(), std::greater<Event>{});
+        } else {
+            kinetic_events_.Schedule(player_id, dogs_.event_time[i]);
+        }
+    }
+    dogs_.time = now;
+}
+
+void GameSession::HandleKineticEvent(DogStore::Index index) {
+    dogs_.Settle(index);
+    const bool horizontal = dogs_.speed_x[index] != 0.;
+    //the event point is exact, the settled position may be off by rounding
+    const double position = dogs_.event_position[index];
+    (horizontal ? dogs_.x : dogs_.y)[index] = position;
+
+    switch (dogs_.event_kind[index]) {
+        case KineticEvent::ROAD_END:
+            dogs_.speed_x[index] = 0.;
+            dogs_.speed_y[index] = 0.;
+            UpdateRoadsDataForDog(index);
+            dogs_.UpdateActivity(index);
+            dogs_.MarkChanged(index);
+            return;
+        case KineticEvent::JUNCTION: {
+            //the dog is on the border, the roads are taken from the cell it enters
+            const double direction = (horizontal ? dogs_.speed_x : dogs_.speed_y)[index] > 0. ? 1. : -1.;
+            app::Coordinates ahead{dogs_.x[index], dogs_.y[index]};
+            (horizontal ? ahead.x : ahead.y) += direction * 0.25;
+            UpdateRoadsDataForDog(index, ahead);
+            break;
+        }
+        case KineticEvent::GATHER: {
+            //everything at the point is gathered at once, loot in the order of ids and offices after it
+            const app::Coordinates dog{dogs_.x[index], dogs_.y[index]};
+            const double loot_reach = DOG_WIDTH + LOOT_WIDTH;
+            std::vector<LootIndex::Entry>& candidates = scratch_.gather.candidates;
+            if (horizontal) {
+                loot_index_.FindInRect(position, position, dog.y - loot_reach, dog.y + loot_reach, candidates);
+            } else {
+                loot_index_.FindInRect(dog.x - loot_reach, dog.x + loot_reach, position, position, candidates);
+            }
+            std::sort(candidates.begin(), candidates.end(), [](const LootIndex::Entry& lhs, const LootIndex::Entry& rhs) {
+                return lhs.id < rhs.id;
+            });
+            const auto& player = dogs_.players[index];
+            for (const auto& candidate : candidates) {
+                auto loot_it = loot_.find(candidate.id);
+                if (loot_it != loot_.end() && player->GetBagSize() < static_cast<size_t>(map_->GetBagCapacity())) {
+                    player->CollectItem(loot_it->second.item);
+                    RemoveLostObject(loot_it);
+                }
+            }
+            for (const auto& office : map_->GetOffices()) {
+                const double along = horizontal ? office.GetPosition().x : office.GetPosition().y;
+                const double across = horizontal ? office.GetPosition().y - dog.y : office.GetPosition().x - dog.x;
+                if (along == position && std::abs(across) <= DOG_WIDTH + OFFICE_WIDTH) {
+                    player->ClearBag();
+                }
+            }
+            break;
+        }
+    }
+    PredictKineticEvent(index, false);
+}
+
+void GameSession::PredictKineticEvent(DogStore::Index index, bool include_start) {
+    const size_t road_index = SelectRoadForMove(index);
+    if (road_index == NO_ROAD) {
+        //the dog is off the roads and can't move
+        dogs_.speed_x[index] = 0.;
+        dogs_.speed_y[index] = 0.;
+        dogs_.UpdateActivity(index);
+        return;
+    }
+    const Road& road = map_->GetRoads()[road_index];
+    const double min_x = std::min(road.GetStart().x, road.GetEnd().x) - 0.4;
+    const double max_x = std::max(road.GetStart().x, road.GetEnd().x) + 0.4;
+    const double min_y = std::min(road.GetStart().y, road.GetEnd().y) - 0.4;
+    const double max_y = std::max(road.GetStart().y, road.GetEnd().y) + 0.4;
+    //the same snap to the road as in CalculateNewPosition
+    dogs_.x[index] = std::clamp(dogs_.x[index], min_x, max_x);
+    dogs_.y[index] = std::clamp(dogs_.y[index], min_y, max_y);
+
+    const bool horizontal = dogs_.speed_x[index] != 0.;
+    const double velocity = horizontal ? dogs_.speed_x[index] : dogs_.speed_y[index];
+    const bool forward = velocity > 0.;
+    const double start = horizontal ? dogs_.x[index] : dogs_.y[index];
+    const double across = horizontal ? dogs_.y[index] : dogs_.x[index];
+    auto distance_to = [start, forward](double position) {
+        return forward ? position - start : start - position;
+    };
+
+    KineticEvent kind = KineticEvent::ROAD_END;
+    double position = horizontal ? (forward ? max_x : min_x) : (forward ? max_y : min_y);
+    if (road.IsHorizontal() == horizontal) {
+        const double border = map_->GetRoadGraph().FindNextJunctionBorder(road_index, start, forward);
+        if (distance_to(border) < distance_to(position)) {
+            kind = KineticEvent::JUNCTION;
+            position = border;
+        }
+    }
+
+    //the first item or office before the event, it wins a tie with it
+    auto try_gather = [&](double item_along, double item_across, double width) {
+        const double distance = distance_to(item_along);
+        if (std::abs(item_across - across) <= DOG_WIDTH + width && (distance > 0. || (include_start && distance == 0.)) &&
+            (distance < distance_to(position) || (distance == distance_to(position) && kind != KineticEvent::GATHER))) {
+            kind = KineticEvent::GATHER;
+            position = item_along;
+        }
+    };
+    const double loot_reach = DOG_WIDTH + LOOT_WIDTH;
+    std::vector<LootIndex::Entry>& candidates = scratch_.gather.candidates;
+    const double min_along = std::min(start, position);
+    const double max_along = std::max(start, position);
+    if (horizontal) {
+        loot_index_.FindInRect(min_along, max_along, across - loot_reach, across + loot_reach, candidates);
+    } else {
+        loot_index_.FindInRect(across - loot_reach, across + loot_reach, min_along, max_along, candidates);
+    }
+    for (const auto& candidate : candidates) {
+        try_gather(horizontal ? candidate.coordinates.x : candidate.coordinates.y,
+                   horizontal ? candidate.coordinates.y : candidate.coordinates.x, LOOT_WIDTH);
+    }
+    for (const auto& office : map_->GetOffices()) {
+        const Point point = office.GetPosition();
+        try_gather(horizontal ? point.x : point.y, horizontal ? point.y : point.x, OFFICE_WIDTH);
+    }
+
+    dogs_.event_kind[index] = kind;
+    dogs_.event_position[index] = position;
+    dogs_.event_time[index] = dogs_.time + distance_to(position) / std::abs(velocity);
+}
+
+void GameSession::UpdateKineticEventsForLoot(app::Coordinates coordinates) {
+    std::vector<DogStore::Index>& dogs_to_update = scratch_.changed_dogs;
+    dogs_to_update.clear();
+    for (DogStore::Index i : dogs_.active) {
+        const app::Coordinates dog = dogs_.GetPosition(i);
+        const bool horizontal = dogs_.speed_x[i] != 0.;
+        const bool forward = (horizontal ? dogs_.speed_x[i] : dogs_.speed_y[i]) > 0.;
+        const double start = horizontal ? dog.x : dog.y;
+        const double item = horizontal ? coordinates.x : coordinates.y;
+        const double across = horizontal ? coordinates.y - dog.y : coordinates.x - dog.x;
+        const double distance = forward ? item - start : start - item;
+        const double event_distance = forward ? dogs_.event_position[i] - start : start - dogs_.event_position[i];
+        if (std::abs(across) > DOG_WIDTH + LOOT_WIDTH || distance < 0. || distance > event_distance ||
+            (distance == event_distance && dogs_.event_kind[i] == KineticEvent::GATHER)) {
+            continue;
+        }
+        dogs_to_update.push_back(i);
+    }
+    for (DogStore::Index i : dogs_to_update) {
+        dogs_.Settle(i);
+        PredictKineticEvent(i, true);
+        if (dogs_.IsActive(i)) {
+            kinetic_events_.Schedule(dogs_.players[i]->GetId(), dogs_.event_time[i]);
+        }
+    }
+}
+
+void GameSession::FindGatherEvents(std::span<const collision_detector::Gatherer> gatherers, size_t first_gatherer_id,
+                                   GatherScratch& gather,
+                                   std::vector<collision_detector::GatheringEvent>& events) const {
+    const auto& offices = map_->GetOffices();
+    auto& candidates = gather.candidates;
+    auto& items = gather.items;
+
+    for (size_t i = 0; i < gatherers.size(); ++i) {
+        const auto& gatherer = gatherers[i];
+        const size_t gatherer_id = first_gatherer_id + i;
+        if (gatherer.start_pos == gatherer.end_pos) {
+            continue;
+        }
+        // dogs move along a road, so this is a range query over the road's line
+        // and over the perpendicular lines crossed on the way
+        const double reach = gatherer.width + LOOT_WIDTH + GATHER_SEARCH_MARGIN;
+        loot_index_.FindInRect(std::min(gatherer.start_pos.x, gatherer.end_pos.x) - reach,
+                               std::max(gatherer.start_pos.x, gatherer.end_pos.x) + reach,
+                               std::min(gatherer.start_pos.y, gatherer.end_pos.y) - reach,
+                               std::max(gatherer.start_pos.y, gatherer.end_pos.y) + reach,
+                               candidates);
+        // loot is tested in the order of ids and offices after it,
+        // so ties in time are resolved as before the index was introduced
+        std::sort(candidates.begin(), candidates.end(), [](const LootIndex::Entry& lhs, const LootIndex::Entry& rhs) {
+            return lhs.id < rhs.id;
+        });
+
+        // the candidates are tested by the collision detector's batch kernel
+        items.Clear();
+        for (const auto& candidate : candidates) {
+            items.Add(static_cast<size_t>(candidate.id),
+                      {geom::Point2D(candidate.coordinates.x, candidate.coordinates.y), LOOT_WIDTH});
+        }
+        for (const auto& office : offices) {
+            items.Add(OFFICE_ITEM_ID, {geom::Point2D(static_cast<double>(office.GetPosition().x),
+                                                     static_cast<double>(office.GetPosition().y)), OFFICE_WIDTH});
+        }
+        collision_detector::CollectEvents(gatherer, gatherer_id, items, events);
+    }
+}
+
+void GameSession::SortGatherEvents(std::vector<collision_detector::GatheringEvent>& events) {
+    // the order is total, so it doesn't depend on the order the events were found in;
+    // offices have the largest item id and come after loot
+    std::sort(events.begin(), events.end(), [](const collision_detector::GatheringEvent& lhs,
+                                                const collision_detector::GatheringEvent& rhs) {
+        if (lhs.time != rhs.time) {
+            return lhs.time < rhs.time;
+        }
+        if (lhs.gatherer_id != rhs.gatherer_id) {
+            return lhs.gatherer_id < rhs.gatherer_id;
+        }
+        return lhs.item_id < rhs.item_id;
+    });
+}
+
+bool GameSession::AdvanceDog(DogStore::Index index, double time_delta, const MoveInfo& move_info, double idle_time_limit) {
+    double time_until_exclusion = idle_time_limit - dogs_.idle_time[index];
+
+    //update idle time
+    dogs_.idle_time[index] += time_delta - move_info.movement_duration;
+
+    // update speed if dog stopped
+    if (move_info.road_end_met) {
+        dogs_.speed_x[index] = 0.;
+        dogs_.speed_y[index] = 0.;
+    }
+    dogs_.x[index] = move_info.end_coordinates.x;
+    dogs_.y[index] = move_info.end_coordinates.y;
+    dogs_.settled_at[index] = dogs_.time;
+
+    //check if idle time exceeded idle time limit
+    if (dogs_.idle_time[index] >= idle_time_limit) {
+        dogs_.play_time[index] += time_until_exclusion;
+        return false;
+    }
+
+    dogs_.play_time[index] += time_delta;
+    return true;
+}
+
+void GameSession::RetireStationaryDog(DogStore::Index index, double idle_time_limit) {
+    //the dog is in the game until its idle time reaches the limit, the same as a moving dog
+    dogs_.Settle(index);
+    const double overtime = dogs_.idle_time[index] - idle_time_limit;
+    dogs_.play_time[index] -= overtime;
+}
+
+size_t GameSession::SelectRoadForMove(DogStore::Index index) const {
+    auto dir = dogs_.direction[index];
+    size_t horizontal = dogs_.horizontal_road[index];
+    size_t vertical = dogs_.vertical_road[index];
+    if (dir == app::Direction::WEST || dir == app::Direction::EAST) {
+        return horizontal != NO_ROAD ? horizontal : vertical;
+    }
+    return vertical != NO_ROAD ? vertical : horizontal;
+}
+
+void GameSession::ExcludePlayers(const std::vector<DogStore::Index>& dogs_to_exclude) {
+    // indices are ascending, removing from the back keeps the remaining ones valid
+    for (auto it = dogs_to_exclude.rbegin(); it != dogs_to_exclude.rend(); ++it) {
+        retired_players_.push_back(dogs_.players[*it]);
+        kinetic_events_.Remove(dogs_.players[*it]->GetId());
+        dogs_.Remove(*it);
     }
 }
 
-void GameSession::GenerateLoot(std::chrono::milliseconds time_delta) {
-    int amount_loot_to_add = loot_generator_->Generate(time_delta, loot_.size(), players_.size());
+void GameSession::GenerateLoot(loot_gen::LootGenerator::TimeInterval time_delta) {
+    int amount_loot_to_add = loot_generator_->Generate(time_delta, loot_.size(), dogs_.Size());
     for (int i = 0; i < amount_loot_to_add; --amount_loot_to_add) {
         LostObject lost_object;
         lost_object.item.id = loot_counter_++;
-        lost_object.item.type = map_->GetRandomLootType();
+        lost_object.item.type = map_->GetRandomLootType(random_);
         lost_object.item.value = map_->GetLootValue(lost_object.item.type);
         lost_object.coordinates = GetRandomCoordinates();
-        loot_[lost_object.item.id] = lost_object;         
+        AddLostObject(lost_object);
+        if (kinetic_) {
+            UpdateKineticEventsForLoot(lost_object.coordinates);
+        }
     } 
 }
 
-MoveInfo GameSession::CalculateNewPosition(app::Coordinates start, app::Speed v, double t, std::shared_ptr<Road> road) {
+MoveInfo GameSession::CalculateNewPosition(app::Coordinates start, app::Speed v, double t, const Road& road) {
     MoveInfo move;
     move.start_coordinates = start;
-    auto minX = std::min(road->GetStart().x, road->GetEnd().x) - 0.4;
-    auto maxX = std::max(road->GetStart().x, road->GetEnd().x) + 0.4;
-    auto minY = std::min(road->GetStart().y, road->GetEnd().y) - 0.4;
-    auto maxY = std::max(road->GetStart().y, road->GetEnd().y) + 0.4;
+    auto minX = std::min(road.GetStart().x, road.GetEnd().x) - 0.4;
+    auto maxX = std::max(road.GetStart().x, road.GetEnd().x) + 0.4;
+    auto minY = std::min(road.GetStart().y, road.GetEnd().y) - 0.4;
+    auto maxY = std::max(road.GetStart().y, road.GetEnd().y) + 0.4;
 
     app::Coordinates actual_position;
 
@@ -449,13 +1123,44 @@ MoveInfo GameSession::CalculateNewPosition(app::Coordinates start, app::Speed v,
     return move;
 } 
 
-void GameSession::UpdateRoadsDataForPlayer(std::shared_ptr<app::Player> player, bool is_excluded) {
-    if (is_excluded) {
-        player_to_roads_.erase(player);
-    } else {
-        PositionOnRoads roads = map_->GetRoadsByCoordinates(player->GetCoordinates());
-        player_to_roads_[player] = {roads};
+void GameSession::UpdateRoadsDataForDog(DogStore::Index index) {
+    UpdateRoadsDataForDog(index, {dogs_.x[index], dogs_.y[index]});
+}
+
+void GameSession::UpdateRoadsDataForDogs(DogStore::Index first) {
+    //dogs of a restored session tend to gather at the same points, so they are sorted by cell
+    //and the roads of a cell are looked up once for all dogs in it
+    std::vector<std::pair<RoadCell, DogStore::Index>> cells;
+    cells.reserve(dogs_.Size() - first);
+    for (DogStore::Index i = first; i < dogs_.Size(); ++i) {
+        cells.emplace_back(MakeRoadCell({dogs_.x[i], dogs_.y[i]}), i);
+    }
+    std::sort(cells.begin(), cells.end(), [](const auto& lhs, const auto& rhs) {
+        const RoadCell& a = lhs.first;
+        const RoadCell& b = rhs.first;
+        return std::tie(a.x, a.y, a.find_vertical, a.find_horizontal) < std::tie(b.x, b.y, b.find_vertical, b.find_horizontal);
+    });
+    PositionOnRoads roads;
+    for (size_t i = 0; i < cells.size(); ++i) {
+        const auto& [cell, index] = cells[i];
+        if (i == 0 || !(cell == cells[i - 1].first)) {
+            roads = map_->GetRoadsByCell(cell);
+        }
+        dogs_.road_cell[index] = cell;
+        dogs_.horizontal_road[index] = roads.horizontal;
+        dogs_.vertical_road[index] = roads.vertical;
+    }
+}
+
+void GameSession::UpdateRoadsDataForDog(DogStore::Index index, app::Coordinates position) {
+    RoadCell cell = MakeRoadCell(position);
+    if (dogs_.road_cell[index] == cell) {
+        return;
     }
+    dogs_.road_cell[index] = cell;
+    PositionOnRoads roads = map_->GetRoadsByCell(cell);
+    dogs_.horizontal_road[index] = roads.horizontal;
+    dogs_.vertical_road[index] = roads.vertical;
 }
 
 double GameSession::GetIdleTimeLimit() const {
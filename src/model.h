@@ -5,10 +5,16 @@
 #include <vector>
 #include <map>
 #include <memory>
+#include <optional>
 #include <set>
+#include <span>
+#include <limits>
 #include "player.h"
-#include <random>
-#include <ctime>
+#include "dog_store.h"
+#include "loot_index.h"
+#include "road_graph.h"
+#include "alias_table.h"
+#include "random_service.h"
 #include <cmath>
 #include <chrono>
 #include <boost/signals2.hpp>
@@ -17,41 +23,9 @@
 #include "loot_generator.h"
 #include "tagged.h"
 #include "collision_detector.h"
+#include "thread_pool.h"
 namespace sig = boost::signals2;
 
-namespace collision_detector {
-class GameItemGathererProvider: public ItemGathererProvider {
-public:
-        
-    size_t ItemsCount() const override {
-        return items_.size();
-    };
-
-    Item GetItem(size_t idx) const override {
-        return items_[idx];
-    };
-
-    void AddItem(Item item) {
-        items_.push_back(std::move(item));
-    };
-
-    size_t GatherersCount() const override { 
-        return gatherers_.size();
-    };
-
-    Gatherer GetGatherer(size_t idx) const override { 
-        return gatherers_[idx];
-    };
-
-    void AddGatherer(Gatherer gatherer) {
-        gatherers_.push_back(std::move(gatherer));
-    };
-private:
-    std::vector<Item> items_;
-    std::vector<Gatherer> gatherers_;
-};
-}
-
 namespace model {
 
 using Dimension = int;
@@ -128,11 +102,6 @@ private:
     Point end_;
 };
 
-struct PositionOnRoads {
-    std::shared_ptr<Road> vertical = nullptr;
-    std::shared_ptr<Road> horizontal = nullptr;
-};
-
 class Building {
 public:
     explicit Building(Rectangle bounds) noexcept
@@ -194,9 +163,17 @@ public:
     const Offices& GetOffices() const noexcept;
     int GetBagCapacity() const;
     double GetMapSpeed() const;
-    int GetRandomLootType() const;
+    int GetRandomLootType(util::FastRandom& random) const;
+    // a point on a road, roads are chosen with the probability proportional to their length
+    app::Coordinates GetRandomRoadPoint(util::FastRandom& random) const;
     int GetLootValue(int id) const;
     PositionOnRoads GetRoadsByCoordinates(app::Coordinates coordinates) const;
+    PositionOnRoads GetRoadsByCell(const RoadCell& cell) const {
+        return road_graph_.Find(cell);
+    }
+    const RoadGraph& GetRoadGraph() const noexcept {
+        return road_graph_;
+    }
     double GetIdleTimeLimit() const { return idle_time_limit_;}
 
     void SetLootNumber(int loot_number);  
@@ -211,6 +188,11 @@ public:
     void AddRoad(const Road& road);
     void AddOffice(Office office);
     void AddBuilding(const Building& building);
+    // called once all roads are added
+    void BuildRoadJunctions() {
+        road_graph_.BuildJunctions();
+    }
+    void BuildSpawnTable();
 
 private:
     using OfficeIdToIndex = std::unordered_map<Office::Id, size_t, util::TaggedHasher<Office::Id>>;
@@ -218,7 +200,6 @@ private:
     Id id_;
     std::string name_;
     Roads roads_;
-    std::vector<std::shared_ptr<Road>> road_ptrs_;
 
     Buildings buildings_;    
     double speed_ = 0.001;
@@ -226,8 +207,8 @@ private:
 
     OfficeIdToIndex warehouse_id_to_index_;
     Offices offices_;
-    std::map<int, std::vector<std::shared_ptr<Road>>> vertical_roads_;
-    std::map<int, std::vector<std::shared_ptr<Road>>> horizontal_roads_;
+    RoadGraph road_graph_;
+    util::AliasTable spawn_roads_;
     int loot_number_;
     std::vector<int> loot_type_id_to_value_;
     double idle_time_limit_;
@@ -244,47 +225,206 @@ struct LostObject {
     app::Coordinates coordinates;
 };
 
+// saved state of a player
+struct PlayerState {
+    int id = 0;
+    std::string name;
+    std::string token;
+    int score = 0;
+    double idle_time = 0.;
+    double total_time = 0.;
+    app::Coordinates coordinates;
+    app::Speed speed;
+    app::Direction direction = app::Direction::NORTH;
+    std::vector<Item> bag;
+};
+
+// saved players and loot of a session, see Game::RestoreSessions
+struct RestoredSession {
+    int id = 0;
+    const Map* map = nullptr;
+    // in the order of the dogs of the session
+    std::vector<PlayerState> players;
+    std::map<int, LostObject> loot;
+};
+
+// item id of a gathering event at an office
+constexpr size_t OFFICE_ITEM_ID = std::numeric_limits<size_t>::max();
+
 class GameSession {
 public:
     GameSession(const Map* map, bool spawn_points_randomized, std::shared_ptr<loot_gen::LootGenerator> loot_generator) 
+        : GameSession(session_id_counter_ + 1, map, spawn_points_randomized, loot_generator)
+    {        
+    }
+
+    //used to restore a session with its saved id
+    GameSession(int session_id, const Map* map, bool spawn_points_randomized, std::shared_ptr<loot_gen::LootGenerator> loot_generator) 
         : map_(map)
-        , session_id_(++session_id_counter_)
+        , session_id_(session_id)
         , spawn_points_randomized_(spawn_points_randomized)
-        , generator_(static_cast<unsigned>(time(0)))
         , loot_generator_(loot_generator)
     {        
+        session_id_counter_ = std::max(session_id_counter_, session_id);
+        dogs_.idle_time_limit = map->GetIdleTimeLimit();
     }
 
     int GetId() const;
+    const Map* GetMap() const noexcept { return map_; }
+    size_t GetPlayersCount() const noexcept { return dogs_.Size(); }
     void AddPlayer(std::shared_ptr<app::Player>& player);
     std::vector<std::shared_ptr<app::Player>> GetPlayers() const;
     app::Coordinates GetRandomCoordinates() const;
     app::Coordinates GetDefaultCoordinates() const;
     app::Coordinates GetSpawnCoordinates() const;
     double GetMapSpeed() const;
-    void UpdateTime(double time_delta);
-    MoveInfo CalculateNewPosition(app::Coordinates start, app::Speed v, double t, std::shared_ptr<Road> road);
-    std::map<int, LostObject> GetLostObjects() const;
+    // with a pool the moving dogs of the session are split between its threads,
+    // the result is the same as without it
+    void UpdateTime(double time_delta, util::WorkStealingPool* pool = nullptr);
+    // advances the session without touching anything outside it, so sessions can be ticked in parallel;
+    // players retired during the tick are kept until NotifyRetiredPlayers
+    void Tick(double time_delta, util::WorkStealingPool* pool = nullptr);
+    // dogs moved by one task of the parallel tick, the dogs are split only when there are
+    // at least two chunks of them
+    static constexpr size_t DEFAULT_PARALLEL_TICK_CHUNK = 256;
+    void SetParallelTickChunk(size_t dogs_count) {
+        parallel_tick_chunk_ = std::max<size_t>(dogs_count, 1);
+    }
+    // ticks in which the moving dogs were split between the threads of the pool
+    size_t GetParallelTicksCount() const noexcept { return parallel_ticks_; }
+    void NotifyRetiredPlayers();
+    MoveInfo CalculateNewPosition(app::Coordinates start, app::Speed v, double t, const Road& road);
+    const std::map<int, LostObject>& GetLostObjects() const noexcept {
+        return loot_;
+    }
     void RestoreLostObjects(std::map<int, LostObject> loot);
     std::string GetMapID() const;
     double GetIdleTimeLimit() const;
     void DeletePlayerFromSession(std::string token);
+    void RestoreDogState(DogStore::Index index, double idle_time, double total_time,
+                         app::Coordinates coordinates, app::Speed speed, app::Direction direction);
+    // adds the dogs of the players bound to this session with their saved states,
+    // the roads under the dogs are looked up in one pass after all of them are added
+    void RestoreDogs(std::span<const std::shared_ptr<app::Player>> players, std::span<const PlayerState> states);
+    // In the kinetic mode a moving dog isn't moved every tick. When it starts to move, the session
+    // predicts the time of its next event: the road end, a cell border next to a junction or
+    // the first item or office on the way, and the dog is handled only when the event fires.
+    // Dogs pass junctions as if the tick were infinitely short, so their ways may differ from
+    // the ones of the tick mode where a long tick carries a dog past the point where the road changes.
+    // Events at the same time are handled in the order of player ids, while the tick mode orders
+    // gathers by the time within the tick and then by the dog index. The two times are rounded
+    // differently, so when two dogs reach an item at the same instant, or an item lies exactly at
+    // the reach of a dog, the modes may give it to different dogs. Otherwise they play the same game.
+    void SetKineticMode(bool enabled);
+    // loot types and spawn points are drawn from the stream
+    void SetRandomStream(util::FastRandom random) {
+        random_ = random;
+    }
+    // while it is on the ids of the players and loot changed by ticks and requests are collected
+    void SetChangeTracking(bool enabled);
+    // moves the changes collected since the last call to changes
+    void TakeChanges(SessionChanges& changes);
+    // nullptr if the player is not in the session
+    std::shared_ptr<app::Player> FindPlayer(int player_id) const;
+    // Grows with every change that SessionChanges would collect, whether they are collected or not.
+    // Between two changes the dogs only go straight or stand still, so the state of the session at
+    // a later time follows from its state at the version and the time passed.
+    uint64_t GetVersion() const noexcept {
+        return dogs_.version + loot_version_;
+    }
+    // sum of the tick deltas
+    double GetTime() const noexcept {
+        return dogs_.time;
+    }
 
 private:  
-    std::vector<std::shared_ptr<app::Player>> players_;
+    DogStore dogs_;
     const Map* map_;
     int session_id_;
     bool spawn_points_randomized_;
     static int session_id_counter_;
-    static int loot_counter_;
-    mutable std::mt19937 generator_; 
+    int loot_counter_ = 0;
+    mutable util::FastRandom random_;
     std::shared_ptr<loot_gen::LootGenerator> loot_generator_;
 
-    std::map<std::shared_ptr<app::Player>, PositionOnRoads> player_to_roads_;
     std::map<int, LostObject> loot_;
-    void UpdateRoadsDataForPlayer(std::shared_ptr<app::Player> player, bool is_excluded = false);  
-    void GenerateLoot(std::chrono::milliseconds time_delta);
-    void ExcludePlayers(const std::vector<std::shared_ptr<app::Player>>& players_to_exclude);
+    // nodes of the removed objects, reused by the objects spawned next
+    std::vector<std::map<int, LostObject>::node_type> spare_loot_nodes_;
+    LootIndex loot_index_;
+    std::optional<SessionChanges> changes_;
+    uint64_t loot_version_ = 0;
+    std::vector<std::shared_ptr<app::Player>> retired_players_;
+    bool kinetic_ = false;
+    // deadlines of the predicted events keyed by player id
+    util::TimerWheel<int> kinetic_events_;
+    // Buffers of the tick. They are cleared rather than freed, so once they have grown
+    // to the size of the session a tick makes no heap allocations.
+    // buffers of the gather search of one range of dogs
+    struct GatherScratch {
+        std::vector<LootIndex::Entry> candidates;
+        collision_detector::ItemBatch items;
+    };
+    struct TickScratch {
+        using KineticEventEntry = std::pair<double, int>;
+
+        std::vector<DogStore::Index> dogs_to_exclude;
+        std::vector<DogStore::Index> retirement_candidates;
+        std::vector<DogStore::Index> moving_dogs;
+        std::vector<DogStore::Index> stopped_dogs;
+        std::vector<DogStore::Index> changed_dogs;
+        std::vector<double> x, y, speed_x, speed_y;
+        std::vector<double> min_x, max_x, min_y, max_y;
+        std::vector<double> end_x, end_y, duration;
+        std::vector<uint8_t> road_end_met;
+        std::vector<size_t> road_indices;
+        std::vector<uint8_t> in_game;
+        std::vector<collision_detector::Gatherer> gatherers;
+        std::vector<collision_detector::GatheringEvent> events;
+        GatherScratch gather;
+        // of every range of dogs moved in parallel
+        std::vector<GatherScratch> chunk_gather;
+        std::vector<std::vector<collision_detector::GatheringEvent>> chunk_events;
+        std::vector<int> fired_ids;
+        // binary heap of (time, player id) of the kinetic events to handle in the tick
+        std::vector<KineticEventEntry> kinetic_queue;
+    };
+    TickScratch scratch_;
+    size_t parallel_tick_chunk_ = DEFAULT_PARALLEL_TICK_CHUNK;
+    size_t parallel_ticks_ = 0;
+    // appends events of the gatherers numbered from first_gatherer_id, item_id is the loot id or OFFICE_ITEM_ID
+    void FindGatherEvents(std::span<const collision_detector::Gatherer> gatherers, size_t first_gatherer_id,
+                          GatherScratch& gather, std::vector<collision_detector::GatheringEvent>& events) const;
+    // by time, then by gatherer and item, which is the order the events are handled in
+    static void SortGatherEvents(std::vector<collision_detector::GatheringEvent>& events);
+    // makes room in the gather buffers for all the loot the session may have
+    void ReserveGatherScratch();
+    void AddLostObject(const LostObject& lost_object);
+    void RemoveLostObject(std::map<int, LostObject>::iterator it);
+    void UpdateRoadsDataForDog(DogStore::Index index);
+    // looks the roads up for the dogs from first to the last one, each distinct cell once
+    void UpdateRoadsDataForDogs(DogStore::Index first);
+    void SetDogState(DogStore::Index index, double idle_time, double total_time,
+                     app::Coordinates coordinates, app::Speed speed, app::Direction direction);
+    // looks the roads up for the given point of the dog's way instead of its position
+    void UpdateRoadsDataForDog(DogStore::Index index, app::Coordinates position);
+    size_t SelectRoadForMove(DogStore::Index index) const;
+    // moves the active dogs by the tick, the dogs to retire are appended to dogs_to_exclude
+    void MoveActiveDogs(double time_delta, double idle_time_limit, std::vector<DogStore::Index>& dogs_to_exclude,
+                        util::WorkStealingPool* pool);
+    // handles the kinetic events up to the time now in the order of time and sets the session clock to it
+    void ProcessKineticEvents(double now);
+    void HandleKineticEvent(DogStore::Index index);
+    // sets the next event of a moving dog settled at the session time,
+    // items at its position are taken into account if include_start is set
+    void PredictKineticEvent(DogStore::Index index, bool include_start);
+    // predicts again the events of the moving dogs which are to pass the new item before their events
+    void UpdateKineticEventsForLoot(app::Coordinates coordinates);
+    // applies movement to the dog, returns false if the dog has been idle for too long
+    bool AdvanceDog(DogStore::Index index, double time_delta, const MoveInfo& move_info, double idle_time_limit);
+    // sets the final play time of a stationary dog whose idle time has reached the limit
+    void RetireStationaryDog(DogStore::Index index, double idle_time_limit);
+    void GenerateLoot(loot_gen::LootGenerator::TimeInterval time_delta);
+    void ExcludePlayers(const std::vector<DogStore::Index>& dogs_to_exclude);
 };
 
 struct LootGeneratorConfig {
@@ -292,6 +432,23 @@ struct LootGeneratorConfig {
     double probability;
 };
 
+enum class SessionPlacement {
+    // the oldest session with free places
+    FILL_FIRST,
+    // the session with the fewest players
+    LEAST_LOADED
+};
+
+// Splitting of players of a map between several sessions.
+// A session that has reached max_players stops accepting players until
+// it has no more than max_players - refill_margin of them.
+struct SessionShardingConfig {
+    // 0 means no limit: one session per map
+    size_t max_players = 0;
+    size_t refill_margin = 0;
+    SessionPlacement placement = SessionPlacement::FILL_FIRST;
+};
+
 class Game {
 public:
     using DBSignal = sig::signal<void(std::string, int, int)>;
@@ -305,16 +462,50 @@ public:
     void AddMap(Map map);
     const Maps& GetMaps() const noexcept;
     const Map* FindMap(const Map::Id& id) const noexcept;
+    void SetSessionSharding(SessionShardingConfig config);
+    // session of the map for a new player, a new session is created if all of them are full
     std::shared_ptr<GameSession> AddSession(const Map* map);
+    // session with the given id, created if it doesn't exist yet
+    std::shared_ptr<GameSession> RestoreSession(const Map* map, int session_id);
     std::shared_ptr<app::Player> JoinGame(const std::string& name, const Map* map);
+    // joins the player to the session with the given id, created if it doesn't exist yet,
+    // used to replay the joins of a recorded game
+    std::shared_ptr<app::Player> JoinGame(const std::string& name, const Map* map, int session_id);
     RetiredPlayerInfo LeaveGame(std::shared_ptr<app::Player> player);
 
-    std::shared_ptr<app::Player> InitializePlayerForRestore(std::string name, std::string token, int id, const Map* map);
+    // session_id 0 means the session is unknown and is chosen as for a new player
+    std::shared_ptr<app::Player> InitializePlayerForRestore(std::string name, std::string token, int id, const Map* map,
+                                                            int session_id = 0);
+    // Restores saved sessions at once, the way to restore many players: the registries are sized
+    // for all of them, the sessions are filled independently, on the threads of the pool if it is given,
+    // and the players are registered in the game afterwards. The loot of a session replaces its current loot.
+    void RestoreSessions(std::vector<RestoredSession> sessions, util::WorkStealingPool* pool = nullptr);
     std::shared_ptr<app::Player> GetPlayerByToken(const std::string& token) const;
     void UpdateTime(double time_delta);
     void SetPlayersStartPointRandomizing(bool randomize_spawn_points);
+    bool ArePlayersStartPointsRandomized() const noexcept {
+        return spawn_points_randomized_;
+    }
+    // sessions are ticked in parallel when threads_count > 1
+    void SetTickThreads(unsigned threads_count);
+    // see GameSession::SetKineticMode, applies to the existing and new sessions
+    void SetKineticMode(bool enabled);
+    // see GameSession::SetChangeTracking, applies to the existing and new sessions
+    void SetChangeTracking(bool enabled);
+    // sessions with at least players_count players are ticked one by one, each on all tick threads;
+    // 0 turns it off
+    void SetParallelSessionSize(size_t players_count);
+    // makes loot, spawn points and tokens the same from run to run; call it before sessions are created
+    void SetRandomSeed(uint64_t seed);
+    // the seed set or the one taken from std::random_device
+    uint64_t GetRandomSeed() const noexcept {
+        return random_.GetSeed();
+    }
     LootProperties GetLootInfo(std::string map_id);
     std::map<int, std::shared_ptr<app::Player>> GetPlayers();
+    const Sessions& GetSessions() const noexcept {
+        return id_to_sessions_;
+    }
     void RestoreLootForAllSessions(std::map<int, LostObjects> session_id_to_loot);
     std::map<int, LostObjects>  RetrieveLootForBackup() const;
     void SetOnLeaveHandler(const DBSignal::slot_type& handler) {
@@ -331,10 +522,23 @@ private:
     Sessions id_to_sessions_;
     //map ptr to collection of sessions' id
     std::map<const Map*, std::vector<int>> map_to_sessions_;
+    SessionShardingConfig session_sharding_;
+    //sessions that have reached the player limit and don't accept new players
+    std::set<int> full_sessions_;
     app::Players players_;
     bool spawn_points_randomized_;    
+    //every session gets its own copy of this generator
     std::shared_ptr<loot_gen::LootGenerator> loot_generator_;
     LootObjectsInfo loot_objects_info_;
+    std::shared_ptr<util::WorkStealingPool> tick_pool_;
+    bool kinetic_mode_ = false;
+    bool change_tracking_ = false;
+    size_t parallel_session_size_ = 0;
+    util::RandomService random_;
+
+    std::shared_ptr<GameSession> CreateSession(const Map* map, int session_id);
+    bool AcceptsPlayers(const GameSession& session);
+    void UpdateSessionLoad(const GameSession& session);
 };
 
 }  // namespace model
@@ -1,11 +1,38 @@
 #include "model_serialization.h"
 
+#include "journal.h"
+#include "sharded_snapshot.h"
+#include "snapshot.h"
+
 namespace serialization {
-void RestoreGameState(std::string path, model::Game& game) {
+namespace {
+
+void CountRestored(const model::Game& game, RestoreStats& stats) {
+    stats.sessions = game.GetSessions().size();
+    for (const auto& [id, session] : game.GetSessions()) {
+        stats.players += session->GetPlayersCount();
+        stats.loot += session->GetLostObjects().size();
+    }
+}
+
+}  // namespace
+
+RestoreStats RestoreGameState(std::string path, model::Game& game, util::WorkStealingPool* pool) {
+    RestoreStats stats;
     if (!std::filesystem::exists(path)) {
-        return;
+        return stats;
     }
+    const auto start = std::chrono::steady_clock::now();
     try {
+        if (IsSnapshotFile(path) || IsManifestFile(path)) {
+            GameState state = IsManifestFile(path) ? ReadShardedSnapshot(path, pool) : ReadSnapshotFile(path, pool);
+            stats.journal_ticks = ReplayJournal(path, state).ticks;
+            RestoreState(std::move(state), game, pool);
+            stats.duration = std::chrono::steady_clock::now() - start;
+            CountRestored(game, stats);
+            return stats;
+        }
+        //states saved before the binary snapshot are text archives
         std::ifstream ifs(path);
 
         boost::archive::text_iarchive ia{ifs}; 
@@ -16,7 +43,8 @@ void RestoreGameState(std::string path, model::Game& game) {
         ia >> loot_info;
 
         for (const auto& [id, player] : players_info) {
-            auto player_ptr = game.InitializePlayerForRestore(player.name, player.token, id, game.FindMap(model::Map::Id(player.map_id)));
+            auto player_ptr = game.InitializePlayerForRestore(player.name, player.token, id, 
+                                                           game.FindMap(model::Map::Id(player.map_id)), player.session_id);
             player_ptr->RestorePlayerState( player.score, 
                                             player.idle_time,
                                             player.total_time,
@@ -26,7 +54,10 @@ void RestoreGameState(std::string path, model::Game& game) {
                                             player.bag);
         } 
 
-        game.RestoreLootForAllSessions(loot_info);
+        game.RestoreLootForAllSessions(std::move(loot_info));
+        stats.duration = std::chrono::steady_clock::now() - start;
+        CountRestored(game, stats);
+        return stats;
     }
     catch(const std::exception& e) {
         throw std::runtime_error("Error restoring game data: corrupted file");
@@ -34,6 +65,10 @@ void RestoreGameState(std::string path, model::Game& game) {
 }
 
 void SaveGameStateInFile(std::string path,  model::Game& game) {
+    WriteSnapshotFile(path, EncodeSnapshot(game));
+}
+
+void SaveGameStateInTextFile(std::string path,  model::Game& game) {
     namespace fs = std::filesystem;
     
     std::string temp_path = path + ".tmp";
@@ -55,7 +90,8 @@ void SaveGameStateInFile(std::string path,  model::Game& game) {
                             player->GetCoordinates(),
                             player->GetSpeed(),
                             player->GetDirection(),
-                            player->GetBag()};
+                            player->GetBag(),
+                            player->GetSession()->GetId()};
     }
 
     //serialize loot info
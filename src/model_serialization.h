@@ -5,17 +5,34 @@
 #include <boost/serialization/vector.hpp>
 #include <boost/serialization/map.hpp>
 #include <boost/serialization/shared_ptr.hpp>
+#include <boost/serialization/version.hpp>
+#include <chrono>
 #include <filesystem>
 #include <fstream>
 #include <string>
 #include <stdexcept>
 
 #include "model.h"
+#include "thread_pool.h"
 
 namespace serialization {
 
-void RestoreGameState(std::string path, model::Game& game);
+struct RestoreStats {
+    size_t sessions = 0;
+    size_t players = 0;
+    size_t loot = 0;
+    //ticks of the journal replayed on top of the snapshot
+    size_t journal_ticks = 0;
+    std::chrono::steady_clock::duration duration{};
+};
+
+//restores the binary snapshot, whole or split by sessions, with its journal and the text archive of the older versions;
+//the sessions of a snapshot are decoded and restored on the threads of the pool if it is given
+RestoreStats RestoreGameState(std::string path, model::Game& game, util::WorkStealingPool* pool = nullptr);
+//writes the binary snapshot, see snapshot.h
 void SaveGameStateInFile(std::string path,  model::Game& game);
+//the text archive the state was saved in before the binary snapshot
+void SaveGameStateInTextFile(std::string path,  model::Game& game);
 
 }// namespace serialization
 
@@ -47,9 +64,11 @@ struct PlayerRepr {
     app::Speed speed;
     app::Direction direction;
     std::vector<model::Item> bag;
+    //0 in states saved before sessions were split
+    int session_id = 0;
 
     template <typename Archive>
-    void serialize(Archive& ar, [[maybe_unused]] const unsigned version) {
+    void serialize(Archive& ar, const unsigned version) {
         ar & name;
         ar & token;
         ar & map_id;
@@ -60,10 +79,15 @@ struct PlayerRepr {
         ar & speed;
         ar & direction;
         ar & bag;
+        if (version >= 1) {
+            ar & session_id;
+        }
     }
 };
 }// namespace model
 
+BOOST_CLASS_VERSION(model::PlayerRepr, 1)
+
 namespace app {
 
 template <typename Archive>
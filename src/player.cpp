@@ -1,15 +1,15 @@
 #include "player.h"
 #include "model.h"
+#include <algorithm>
 #include <map>
 
 int app::Players::player_id_counter_ = 0;
-app::TokenGenerator app::Players::token_generator_;
 
 namespace app{
 
     std::string TokenGenerator::GetToken() {
-        uint64_t a = generator1_();
-        uint64_t b = generator2_();
+        uint64_t a = seeded_random_ ? (*seeded_random_)() : generator1_();
+        uint64_t b = seeded_random_ ? (*seeded_random_)() : generator2_();
         std::stringstream stream;      
         stream << std::hex << a << b;
         std::string token;
@@ -32,12 +32,15 @@ namespace app{
     }
 
     std::shared_ptr<Player> Players::AddPlayer(std::string name, std::string token, int id, std::shared_ptr<model::GameSession> session) {        
-        std::shared_ptr<Player> player = std::make_shared<Player>(name, id, token);
-        player_id_counter_ = id;
+        std::shared_ptr<Player> player = MakePlayer(std::move(name), std::move(token), id);
         player->SetSession(session);
         session->AddPlayer(player);
-        token_to_player_.insert({token, player}); 
-        player_id_to_player_[player->GetId()] = player;  
+        RegisterPlayer(player);
+        return player;
+    }
+
+    std::shared_ptr<Player> Players::MakePlayer(std::string name, std::string token, int id) {
+        std::shared_ptr<Player> player = std::make_shared<Player>(std::move(name), id, token);
         player->DoOnLeave([this, token] { 
             this->DeletePlayer(token);
         });     
@@ -47,24 +50,31 @@ namespace app{
         return player;
     }
 
+    void Players::RegisterPlayer(const std::shared_ptr<Player>& player) {
+        //players may be restored in any order, new ones get ids after all of them
+        player_id_counter_ = std::max(player_id_counter_, player->GetId());
+        token_to_player_.insert({player->GetToken(), player}); 
+        player_id_to_player_[player->GetId()] = player;  
+    }
+
     void Player::SetSession(std::shared_ptr<model::GameSession> game_session) {
-        game_session_ =  game_session;    
+        game_session_ =  game_session;
+    }
+
+    void Player::RestorePlayerState(int score, double idle_time, double total_time, Coordinates coordinates, Speed speed, Direction direction, std::vector<model::Item> bag)  {
+        RestoreScore(score, std::move(bag));
         if (auto session = game_session_.lock()) {
-            coordinates_ = session->GetSpawnCoordinates();
+            session->RestoreDogState(dog_index_, idle_time, total_time, coordinates, speed, direction);
         }
     }
 
-    void Player::RestorePlayerState(int score, double idle_time, double total_time, Coordinates coordinates, Speed speed, Direction direction, std::vector<model::Item> bag)  {
+
+    void Player::RestoreScore(int score, std::vector<model::Item> bag) {
         score_ = score;
-        idle_time_ = idle_time;
-        total_play_time_ = total_time;
-        coordinates_ = coordinates;
-        speed_ = speed;
-        direction_ = direction;
-        bag_ = bag;
+        //the items are copied to keep the room reserved for the bag
+        bag_.assign(bag.begin(), bag.end());
     }
 
-
     std::string Player::GetMapID() {
         if (auto session = game_session_.lock()) {
             return session->GetMapID();
@@ -73,61 +83,44 @@ namespace app{
     }
 
     void Player::Move(std::string direction) {
-        direction_ = symbol_to_direction.at(direction);
+        if (!dogs_) {
+            return;
+        }
+        dogs_->direction[dog_index_] = symbol_to_direction.at(direction);
         if (auto session = game_session_.lock()) {
+            dogs_->Settle(dog_index_);
             double speed = session->GetMapSpeed();
+            Speed new_speed;
 
             if (direction == "") {
-                speed_ = {0, 0};
+                new_speed = {0, 0};
             } else if (direction == "U") {
-                speed_ = {0, -1. * speed};
-                idle_time_ = 0.;
+                new_speed = {0, -1. * speed};
+                dogs_->idle_time[dog_index_] = 0.;
             } else if (direction == "D") {
-                speed_ = {0, speed};
-                idle_time_ = 0.;
+                new_speed = {0, speed};
+                dogs_->idle_time[dog_index_] = 0.;
             } else if (direction == "L") {
-                speed_ = {-1. * speed, 0};
-                idle_time_ = 0.;
+                new_speed = {-1. * speed, 0};
+                dogs_->idle_time[dog_index_] = 0.;
             } else if (direction == "R") {
-                speed_ = {speed, 0};
-                idle_time_ = 0.;
+                new_speed = {speed, 0};
+                dogs_->idle_time[dog_index_] = 0.;
             }
+            dogs_->speed_x[dog_index_] = new_speed.x;
+            dogs_->speed_y[dog_index_] = new_speed.y;
+            dogs_->UpdateActivity(dog_index_);
+            dogs_->MarkMotionChanged(dog_index_);
+            dogs_->MarkChanged(dog_index_);
         }
     }
 
     void Player::LeaveGame() {
         // send signal to DB about leaving game
-        db_signal_(name_, total_play_time_, score_);
+        db_signal_(name_, GetTotalTime(), score_);
         leave_signal_();
     }
 
-    bool Player::UpdatePosition(double time_delta, const model::MoveInfo& move_info) {
-
-        double idle_time_limit;
-        if (auto session = game_session_.lock()) {
-            idle_time_limit = session->GetIdleTimeLimit();
-        }
-        double time_until_exclusion = idle_time_limit - idle_time_;
-
-        //update idle_time_  
-        idle_time_ += time_delta - move_info.movement_duration;
-
-        // update speed if player stopped
-        if (move_info.road_end_met) {
-            StopPlayer();
-        } 
-        SetPosition(move_info.end_coordinates);
-
-        //check if idle_time exceeded idle_time_limit
-        if (idle_time_ >= idle_time_limit) {
-            total_play_time_ += time_until_exclusion;
-            return false;
-        }
-
-        total_play_time_ += time_delta;
-        return true;
-    }
-
     Token Player::GetToken() const {
         return token_;
     }
@@ -145,43 +138,96 @@ namespace app{
     }
 
     Coordinates Player::GetCoordinates() const {
-        return coordinates_;
+        if (!dogs_) {
+            return {};
+        }
+        return dogs_->GetPosition(dog_index_);
     }
 
     void Player::SetPosition(app::Coordinates new_position) {
-        coordinates_ = new_position;
+        if (dogs_) {
+            dogs_->Settle(dog_index_);
+            dogs_->x[dog_index_] = new_position.x;
+            dogs_->y[dog_index_] = new_position.y;
+            dogs_->MarkMotionChanged(dog_index_);
+            dogs_->MarkChanged(dog_index_);
+        }
     }
 
     Speed Player::GetSpeed() const {
-        return speed_;
+        if (!dogs_) {
+            return {};
+        }
+        return {dogs_->speed_x[dog_index_], dogs_->speed_y[dog_index_]};
     }
 
     void Player::StopPlayer() {
-        speed_ = {};
+        if (dogs_) {
+            dogs_->Settle(dog_index_);
+            dogs_->speed_x[dog_index_] = 0.;
+            dogs_->speed_y[dog_index_] = 0.;
+            dogs_->UpdateActivity(dog_index_);
+            dogs_->MarkMotionChanged(dog_index_);
+            dogs_->MarkChanged(dog_index_);
+        }
+    }
+
+    double Player::GetIdleTime() const {
+        if (!dogs_) {
+            return 0.;
+        }
+        return dogs_->GetIdleTime(dog_index_);
+    }
+
+    double Player::GetTotalTime() const {
+        if (!dogs_) {
+            return total_play_time_;
+        }
+        return dogs_->GetPlayTime(dog_index_);
     }
 
     void Player::ClearBag() {
+        if (bag_.empty()) {
+            return;
+        }
         score_ += std::accumulate(bag_.begin(), bag_.end(), 0, 
             [](int sum, const model::Item& item) {
                 return sum + item.value;
             });
         bag_.clear();
+        if (dogs_) {
+            dogs_->MarkChanged(dog_index_);
+        }
     }
 
     Direction Player::GetDirection() const {
-        return direction_;
+        if (!dogs_) {
+            return Direction::NORTH;
+        }
+        return dogs_->direction[dog_index_];
     }
 
     std::vector<model::Item> Player::GetBag() const {
         return bag_;
     }
 
+    size_t Player::GetBagSize() const {
+        return bag_.size();
+    }
+
+    void Player::ReserveBag(size_t capacity) {
+        bag_.reserve(capacity);
+    }
+
     int Player::GetScore() const {
         return score_;
     }
 
     void Player::CollectItem(model::Item item) {
         bag_.push_back(item);
+        if (dogs_) {
+            dogs_->MarkChanged(dog_index_);
+        }
     }
 
     sig::connection Player::DoOnLeave(const LeaveSignal::slot_type& handler) {
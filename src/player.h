@@ -12,12 +12,13 @@
 #include <boost/asio/signal_set.hpp>
 #include <boost/signals2.hpp>
 #include "data_structures.h"
+#include "fast_random.h"
 
 
 namespace model {
     class GameSession;
+    class DogStore;
     struct Item;
-    struct MoveInfo;
 };
 
 namespace app {
@@ -62,41 +63,43 @@ public:
     Coordinates GetCoordinates() const;    
     Speed GetSpeed() const;
     Direction GetDirection() const;
-    double GetIdleTime() const {
-        return idle_time_;
-    }
-    double GetTotalTime() const {
-        return total_play_time_;
-    }
+    double GetIdleTime() const;
+    double GetTotalTime() const;
     std::vector<model::Item> GetBag() const;
+    size_t GetBagSize() const;
     int GetScore() const;
 
     void SetSession(std::shared_ptr<model::GameSession> game_session);
     void SetPosition(app::Coordinates new_position);
-    bool UpdatePosition(double time_delta, const model::MoveInfo& move_info);
     void LeaveGame();
     sig::connection DoOnLeave(const LeaveSignal::slot_type& handler);
     sig::connection BindDBHandler(const DBSignal::slot_type& handler);
 
     void ClearBag();
+    // makes room for capacity items, so that collecting them doesn't allocate
+    void ReserveBag(size_t capacity);
     void CollectItem(model::Item item);
     void Move(std::string direction);
     void StopPlayer();
     std::string GetMapID();
     void RestorePlayerState(int score, double idle_time, double total_time, Coordinates coordinates, Speed speed, Direction direction, std::vector<model::Item> bag);
+    // score and bag of a restored player whose dog is restored by the session
+    void RestoreScore(int score, std::vector<model::Item> bag);
 
 private:
+    friend class model::DogStore;
+
     std::weak_ptr<model::GameSession> game_session_;
     std::string name_;
     int id_;
     Token token_;
     int score_ = 0;
-    double idle_time_ = 0;          
+    // total play time of a dog which has already left the session
     double total_play_time_ = 0;
 
-    Coordinates coordinates_;
-    Speed speed_;
-    Direction direction_ = Direction::NORTH;  
+    // row of the dog in the session's DogStore, nullptr when the dog is not in a session
+    model::DogStore* dogs_ = nullptr;
+    size_t dog_index_ = 0;
     std::vector<model::Item> bag_;
     LeaveSignal leave_signal_;
     DBSignal db_signal_;
@@ -105,17 +108,22 @@ private:
 class TokenGenerator {
 public: 
     std::string GetToken();
+    // tokens are taken from the stream instead of std::random_device, so they repeat from run to run
+    void SetRandomStream(util::FastRandom random) {
+        seeded_random_ = random;
+    }
 
 private:
-    std::random_device random_device_;
-    std::mt19937_64 generator1_{[this] {
-        std::uniform_int_distribution<std::mt19937_64::result_type> dist;
-        return dist(random_device_);
-    }()};
-    std::mt19937_64 generator2_{[this] {
+    // the device is not kept, so that the generator and the game owning it stay movable
+    static std::mt19937_64::result_type MakeSeed() {
+        std::random_device random_device;
         std::uniform_int_distribution<std::mt19937_64::result_type> dist;
-        return dist(random_device_);
-    }()};   
+        return dist(random_device);
+    }
+
+    std::mt19937_64 generator1_{MakeSeed()};
+    std::mt19937_64 generator2_{MakeSeed()};   
+    std::optional<util::FastRandom> seeded_random_;
 };
 
 class Players {
@@ -124,6 +132,14 @@ public:
     Players(){}
     std::shared_ptr<Player> AddPlayer(std::string name, std::shared_ptr<model::GameSession> session);
     std::shared_ptr<Player> AddPlayer(std::string name, std::string token, int id, std::shared_ptr<model::GameSession> session);
+    // a player not yet added to a session nor registered, bound to the handlers of the registry;
+    // players can be made on several threads at once
+    std::shared_ptr<Player> MakePlayer(std::string name, std::string token, int id);
+    void RegisterPlayer(const std::shared_ptr<Player>& player);
+    // makes room for count more players
+    void Reserve(size_t count) {
+        token_to_player_.reserve(token_to_player_.size() + count);
+    }
     std::shared_ptr<Player> GetPlayerByToken(const Token& token) const;
     std::map<int, std::shared_ptr<Player>> GetPlayers () {
         return player_id_to_player_;
@@ -131,6 +147,9 @@ public:
     void SetOnLeaveHandler(const DBSignal::slot_type& handler) {
         on_leave_sig_handler_ = handler;
     }
+    void SetTokenRandomStream(util::FastRandom random) {
+        token_generator_.SetRandomStream(random);
+    }
     void DeletePlayer(std::string token) {
         int player_id = token_to_player_.at(token)->GetId();
         token_to_player_.erase(token);
@@ -139,7 +158,7 @@ public:
     
 private:
     static int player_id_counter_;
-    static TokenGenerator token_generator_;
+    TokenGenerator token_generator_;
     std::unordered_map<Token, std::shared_ptr<Player>> token_to_player_;
     std::map<int, std::shared_ptr<Player>> player_id_to_player_;
     std::optional<DBSignal::slot_type> on_leave_sig_handler_;
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+
+#include "fast_random.h"
+
+namespace util {
+
+// The source of all random streams of the game model. Every stream is derived from one master seed,
+// so a game given the same seed and the same requests plays the same way on every run.
+// Without a seed the master seed is taken from std::random_device.
+class RandomService {
+public:
+    enum class Purpose : uint64_t {
+        SESSION = 1,
+        TOKENS = 2,
+    };
+
+    RandomService()
+        : master_seed_{(static_cast<uint64_t>(std::random_device{}()) << 32) | std::random_device{}()} {
+    }
+
+    void SetSeed(uint64_t seed) {
+        master_seed_ = seed;
+        seeded_ = true;
+    }
+
+    bool IsSeeded() const noexcept {
+        return seeded_;
+    }
+
+    uint64_t GetSeed() const noexcept {
+        return master_seed_;
+    }
+
+    // the stream of the given purpose and number, e.g. the id of a session
+    FastRandom MakeStream(Purpose purpose, uint64_t id = 0) const {
+        return FastRandom{master_seed_, (static_cast<uint64_t>(purpose) << 56) ^ id};
+    }
+
+private:
+    uint64_t master_seed_;
+    bool seeded_ = false;
+};
+
+}  // namespace util
@@ -0,0 +1,115 @@
+#include <boost/program_options.hpp>
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "input_log.h"
+#include "json_loader.h"
+#include "model_serialization.h"
+
+using namespace std::literals;
+
+namespace {
+
+struct ReplayArgs {
+    std::string config_file_path;
+    std::string state_path;
+    std::string input_path;
+    unsigned tick_threads = 0;
+    size_t parallel_session_players = 0;
+    bool kinetic_events = false;
+};
+
+[[nodiscard]] std::optional<ReplayArgs> ParseCommandLine(int argc, const char* const argv[]) {
+    namespace po = boost::program_options;
+
+    po::options_description desc{"Replays an input log recorded by game_server --record-input.\nAllowed options"s};
+
+    ReplayArgs args;
+    desc.add_options()
+        ("help,h", "produce help message")
+        ("config-file,c", po::value(&args.config_file_path)->value_name("file"s), "config file the recorded server was started with")
+        ("state-file", po::value(&args.state_path)->value_name("state"s), "state file the recorded server was restored from")
+        ("input,i", po::value(&args.input_path)->value_name("file"s), "input log")
+        ("tick-threads", po::value(&args.tick_threads)->value_name("threads"s), "update game sessions in parallel on the given number of threads")
+        ("parallel-session-players", po::value(&args.parallel_session_players)->value_name("players"s), "split sessions with at least the given number of players between the tick threads")
+        ("kinetic-events", "move dogs by predicted events instead of every tick");
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.contains("help"s)) {
+        std::cout << desc;
+        return std::nullopt;
+    }
+    if (!vm.contains("config-file"s)) {
+        throw std::runtime_error("Config file is not specified"s);
+    }
+    if (!vm.contains("input"s)) {
+        throw std::runtime_error("Input log is not specified"s);
+    }
+    if (vm.contains("kinetic-events"s)) {
+        args.kinetic_events = true;
+    }
+    return args;
+}
+
+double ToMilliseconds(std::chrono::nanoseconds duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+    try {
+        auto args = ParseCommandLine(argc, argv);
+        if (!args) {
+            return EXIT_SUCCESS;
+        }
+
+        model::Game game = json_loader::LoadGame(args->config_file_path);
+        game.SetTickThreads(args->tick_threads);
+        game.SetParallelSessionSize(args->parallel_session_players);
+        game.SetKineticMode(args->kinetic_events);
+        if (!args->state_path.empty()) {
+            util::WorkStealingPool restore_pool{std::thread::hardware_concurrency()};
+            const serialization::RestoreStats restored =
+                serialization::RestoreGameState(args->state_path, game, &restore_pool);
+            std::cout << "restored players: "s << restored.players << ", sessions: "s << restored.sessions
+                      << ", journal ticks: "s << restored.journal_ticks << ", in "s
+                      << ToMilliseconds(restored.duration) << " ms\n"s;
+        }
+
+        std::ifstream input{args->input_path, std::ios::binary};
+        if (!input) {
+            throw std::runtime_error("Failed to open the input log "s + args->input_path);
+        }
+        replay::InputReader reader{input};
+        replay::InputReplayer replayer{game};
+        const replay::ReplayStats stats = replayer.Replay(reader);
+
+        long score = 0;
+        const auto players = game.GetPlayers();
+        for (const auto& [id, player] : players) {
+            score += player->GetScore();
+        }
+        std::cout << "joins: "s << stats.joins << ", moves: "s << stats.moves << ", ticks: "s << stats.ticks
+                  << ", game time: "s << stats.game_time << " ms\n"s;
+        std::cout << "total: "s << ToMilliseconds(stats.total_time) << " ms, ticks: "s
+                  << ToMilliseconds(stats.tick_time) << " ms"s;
+        if (stats.ticks > 0) {
+            std::cout << ", per tick: "s << ToMilliseconds(stats.tick_time) * 1e6 / stats.ticks << " ns"s;
+        }
+        std::cout << '\n';
+        std::cout << "players: "s << players.size() << ", score: "s << score << std::endl;
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -302,6 +302,15 @@ Response APIHandler::MakeJSONErrorResponse(http::status status, std::string erro
     }  
 
 
+    Strand& RequestHandler::GetSessionStrand(int session_id) {
+        std::lock_guard lock{session_strands_mutex_};
+        auto it = session_strands_.find(session_id);
+        if (it == session_strands_.end()) {
+            it = session_strands_.emplace(session_id, net::make_strand(strand_.get_inner_executor())).first;
+        }
+        return it->second;
+    }
+
     Response APIHandler::MakeJoinResponse(std::string user_name, std::string map_id, unsigned http_version, bool keep_alive) {
         
         Response response;
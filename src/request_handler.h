@@ -18,6 +18,7 @@
 #include <optional>
 #include <ostream>
 #include <thread>
+#include <unordered_map>
 #include <variant>
 #include <vector>
 
@@ -84,6 +85,17 @@ public:
     template <typename Request>
     Response MakeAPIResponse(Request&& req);
 
+    // id of the session a request of an authorized player is addressed to,
+    // nullopt for requests touching the whole game (join, maps, tick) or with an unknown token
+    template <typename Request>
+    std::optional<int> FindRequestSession(const Request& req);
+
+    // requests reading the records database only, they don't need any strand
+    template <typename Request>
+    bool IsRecordsRequest(const Request& req) const {
+        return std::string(req.target()).starts_with("/api/v1/game/records");
+    }
+
 private:
     std::shared_ptr<Application> application_;
     bool ticker_is_manual_;
@@ -147,8 +159,13 @@ public:
     private:
     std::shared_ptr<APIHandler> api_handler_;  
     fs::path path_to_static_;
+    // coordinator strand for requests touching the whole game
     Strand strand_;
-    
+    // requests of players of a session are serialized on the session's own strand
+    std::mutex session_strands_mutex_;
+    std::unordered_map<int, Strand> session_strands_;
+
+    Strand& GetSessionStrand(int session_id);
 
     template<typename Send>      
     void SendResponse(std::chrono::milliseconds ms, Send&& send, Response& r);       
@@ -169,6 +186,28 @@ RecordQueryParams ParseQueryParams(const std::string& query);
 
 // ====== Implementation of Template Methods for APIHandler ======
 
+template <typename Request>
+std::optional<int> APIHandler::FindRequestSession(const Request& req) {
+    std::string req_target(req.target());
+    if (req_target != "/api/v1/game/players" && 
+        req_target != "/api/v1/game/player/action" && 
+        !req_target.starts_with("/api/v1/game/state")) {
+        return std::nullopt;
+    }
+    std::string req_authorization = std::string(req[http::field::authorization]);
+    if (!IsAuthStringValid(req_authorization)) {
+        return std::nullopt;
+    }
+    std::shared_ptr<app::Player> player_ptr = application_->GetPlayerByToken(req_authorization.substr(7));
+    if (!player_ptr) {
+        return std::nullopt;
+    }
+    if (auto session = player_ptr->GetSession()) {
+        return session->GetId();
+    }
+    return std::nullopt;
+}
+
 template <typename Request>
 Response APIHandler::MakeAPIResponse(Request&& req) {
     std::string req_target(req.target());
@@ -435,6 +474,8 @@ void RequestHandler::operator()(http::request<Body, http::basic_fields<Allocator
     
     if (req_target.starts_with("/api")) {
         auto self = shared_from_this();
+        const bool is_records_request = api_handler_->IsRecordsRequest(req);
+        std::optional<int> session_id = api_handler_->FindRequestSession(req);
         auto api_req_handler = [this, self, send, req = std::forward<decltype(req)>(req), start](){
             Response r = self->api_handler_->MakeAPIResponse(std::move(req));
             
@@ -443,7 +484,14 @@ void RequestHandler::operator()(http::request<Body, http::basic_fields<Allocator
             
             self->SendResponse(ms, std::move(send), r);
         };
-        net::dispatch(strand_, api_req_handler);
+        if (is_records_request) {
+            //records are read from the database, the game state isn't touched
+            api_req_handler();
+        } else if (session_id) {
+            net::dispatch(GetSessionStrand(*session_id), api_req_handler);
+        } else {
+            net::dispatch(strand_, api_req_handler);
+        }
         
         return;
     } else {
@@ -0,0 +1,138 @@
+#include "road_graph.h"
+#include "model.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace model {
+
+RoadCell MakeRoadCell(app::Coordinates coordinates) {
+    RoadCell cell;
+    cell.x = static_cast<int>(std::round(coordinates.x));
+    cell.y = static_cast<int>(std::round(coordinates.y));
+    cell.find_vertical = !isFractionInRange(coordinates.x);
+    cell.find_horizontal = !isFractionInRange(coordinates.y);
+    return cell;
+}
+
+void RoadGraph::AddRoad(const Road& road) {
+    const size_t index = segments_.size();
+    Segment segment;
+    segment.horizontal = road.IsHorizontal();
+    if (segment.horizontal) {
+        segment.line = road.GetStart().y;
+        segment.min = std::min(road.GetStart().x, road.GetEnd().x);
+        segment.max = std::max(road.GetStart().x, road.GetEnd().x);
+    } else {
+        segment.line = road.GetStart().x;
+        segment.min = std::min(road.GetStart().y, road.GetEnd().y);
+        segment.max = std::max(road.GetStart().y, road.GetEnd().y);
+    }
+    segments_.push_back(segment);
+
+    for (int position = segment.min; position <= segment.max; ++position) {
+        if (segment.horizontal) {
+            PositionOnRoads& roads = cells_[MakeKey(position, segment.line)];
+            if (roads.horizontal == NO_ROAD) {
+                roads.horizontal = index;
+            }
+        } else {
+            PositionOnRoads& roads = cells_[MakeKey(segment.line, position)];
+            if (roads.vertical == NO_ROAD) {
+                roads.vertical = index;
+            }
+        }
+    }
+    // new segment invalidates the junctions
+    junctions_.clear();
+    junction_offsets_.assign(segments_.size() + 1, 0);
+    segment_junctions_.clear();
+}
+
+void RoadGraph::BuildJunctions() {
+    auto get_point = [](const Segment& segment, int position) {
+        return segment.horizontal ? Junction{position, segment.line} : Junction{segment.line, position};
+    };
+
+    std::unordered_map<uint64_t, size_t, KeyHasher> point_to_junction;
+    auto add_junction = [this, &point_to_junction](Junction point) {
+        if (point_to_junction.emplace(MakeKey(point.x, point.y), junctions_.size()).second) {
+            junctions_.push_back(point);
+        }
+    };
+
+    junctions_.clear();
+    for (const Segment& segment : segments_) {
+        add_junction(get_point(segment, segment.min));
+        for (int position = segment.min + 1; position < segment.max; ++position) {
+            Junction point = get_point(segment, position);
+            const PositionOnRoads& roads = cells_.at(MakeKey(point.x, point.y));
+            if (roads.horizontal != NO_ROAD && roads.vertical != NO_ROAD) {
+                add_junction(point);
+            }
+        }
+        add_junction(get_point(segment, segment.max));
+    }
+
+    junction_offsets_.assign(1, 0);
+    segment_junctions_.clear();
+    for (const Segment& segment : segments_) {
+        for (int position = segment.min; position <= segment.max; ++position) {
+            Junction point = get_point(segment, position);
+            if (auto it = point_to_junction.find(MakeKey(point.x, point.y)); it != point_to_junction.end()) {
+                segment_junctions_.push_back(it->second);
+            }
+        }
+        junction_offsets_.push_back(segment_junctions_.size());
+    }
+}
+
+double RoadGraph::FindNextJunctionBorder(size_t segment, double position, bool forward) const {
+    const Segment& line = segments_[segment];
+    auto get_position = [this, &line](size_t junction) {
+        return static_cast<double>(line.horizontal ? junctions_[junction].x : junctions_[junction].y);
+    };
+    const auto junctions = GetSegmentJunctions(segment);
+
+    if (forward) {
+        // the first junction whose far border is ahead
+        auto it = std::partition_point(junctions.begin(), junctions.end(), [&](size_t junction) {
+            return get_position(junction) + 0.5 <= position;
+        });
+        if (it == junctions.end()) {
+            return std::numeric_limits<double>::infinity();
+        }
+        const double near_border = get_position(*it) - 0.5;
+        return near_border > position ? near_border : get_position(*it) + 0.5;
+    }
+    // the last junction whose far border is behind
+    auto it = std::partition_point(junctions.begin(), junctions.end(), [&](size_t junction) {
+        return get_position(junction) - 0.5 < position;
+    });
+    if (it == junctions.begin()) {
+        return -std::numeric_limits<double>::infinity();
+    }
+    --it;
+    const double near_border = get_position(*it) + 0.5;
+    return near_border < position ? near_border : get_position(*it) - 0.5;
+}
+
+PositionOnRoads RoadGraph::Find(const RoadCell& cell) const {
+    PositionOnRoads roads;
+    if (!cell.find_vertical && !cell.find_horizontal) {
+        return roads;
+    }
+    auto it = cells_.find(MakeKey(cell.x, cell.y));
+    if (it == cells_.end()) {
+        return roads;
+    }
+    if (cell.find_vertical) {
+        roads.vertical = it->second.vertical;
+    }
+    if (cell.find_horizontal) {
+        roads.horizontal = it->second.horizontal;
+    }
+    return roads;
+}
+
+}  // namespace model
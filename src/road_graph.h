@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "player.h"
+
+namespace model {
+
+class Road;
+
+constexpr size_t NO_ROAD = std::numeric_limits<size_t>::max();
+
+// indices of the roads in Map::GetRoads() under the given point
+struct PositionOnRoads {
+    size_t vertical = NO_ROAD;
+    size_t horizontal = NO_ROAD;
+};
+
+// Integer point the coordinates are rounded to for the road lookup.
+// A point in the middle between two lines (fraction in (0.4, 0.6)) isn't looked up on that axis.
+struct RoadCell {
+    int x = 0;
+    int y = 0;
+    bool find_vertical = false;
+    bool find_horizontal = false;
+
+    bool operator==(const RoadCell&) const = default;
+};
+
+RoadCell MakeRoadCell(app::Coordinates coordinates);
+
+// Roads of a map as flat arrays of segments and junction nodes.
+// Every integer point covered by a road is hashed to the roads under it, so the lookup
+// costs one hash probe instead of a search over the roads lying on the same line.
+class RoadGraph {
+public:
+    struct Segment {
+        bool horizontal;
+        // y of a horizontal segment, x of a vertical one
+        int line;
+        // extent along the line
+        int min;
+        int max;
+    };
+
+    // road end or crossing of a horizontal and a vertical road
+    struct Junction {
+        int x;
+        int y;
+    };
+
+    // segments get the indices of the roads in Map::GetRoads(),
+    // where roads of one orientation overlap the road added first is found
+    void AddRoad(const Road& road);
+    // fills the junction lists, called once all roads are added
+    void BuildJunctions();
+
+    PositionOnRoads Find(const RoadCell& cell) const;
+
+    const std::vector<Segment>& GetSegments() const noexcept {
+        return segments_;
+    }
+
+    const std::vector<Junction>& GetJunctions() const noexcept {
+        return junctions_;
+    }
+
+    // indices in GetJunctions() of the junctions on the segment, ordered along it
+    std::span<const size_t> GetSegmentJunctions(size_t segment) const {
+        return {segment_junctions_.data() + junction_offsets_[segment],
+                segment_junctions_.data() + junction_offsets_[segment + 1]};
+    }
+
+    // Coordinate along the segment of the nearest cell border strictly after position in the direction
+    // of motion that has a junction cell on one of its sides, infinity (with the sign of the direction)
+    // if there is none. Roads found along a line can change only at such borders.
+    double FindNextJunctionBorder(size_t segment, double position, bool forward) const;
+
+private:
+    static uint64_t MakeKey(int x, int y) noexcept {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+    }
+
+    struct KeyHasher {
+        size_t operator()(uint64_t key) const noexcept {
+            // mixes both halves of the key, the identity hash of a packed point clusters badly
+            key ^= key >> 33;
+            key *= 0xff51afd7ed558ccdULL;
+            key ^= key >> 33;
+            return static_cast<size_t>(key);
+        }
+    };
+
+    std::vector<Segment> segments_;
+    std::unordered_map<uint64_t, PositionOnRoads, KeyHasher> cells_;
+
+    std::vector<Junction> junctions_;
+    // junctions of segment i are segment_junctions_[junction_offsets_[i] .. junction_offsets_[i + 1])
+    std::vector<size_t> junction_offsets_{0};
+    std::vector<size_t> segment_junctions_;
+};
+
+}  // namespace model
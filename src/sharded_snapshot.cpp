@@ -0,0 +1,230 @@
+#include "sharded_snapshot.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <string_view>
+#include <utility>
+
+#include "little_endian.h"
+
+namespace serialization {
+
+using namespace std::literals;
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr std::string_view SESSION_SUFFIX = ".session."sv;
+
+namespace manifest_header {
+constexpr size_t VERSION = 4;
+constexpr size_t SAVE = 8;
+constexpr size_t JOURNAL_GENERATION = 16;
+constexpr size_t SESSIONS = 24;
+constexpr size_t SIZE = 28;
+}  // namespace manifest_header
+
+namespace manifest_session {
+constexpr size_t ID = 0;
+constexpr size_t FILE_SAVE = 4;
+constexpr size_t FILE_TIME = 12;
+constexpr size_t TIME = 20;
+constexpr size_t SIZE = 28;
+}  // namespace manifest_session
+
+using little_endian::Load;
+using little_endian::Store;
+
+std::vector<char> EncodeManifest(const ShardedSnapshot& snapshot) {
+    std::vector<char> data(manifest_header::SIZE + snapshot.sessions.size() * manifest_session::SIZE);
+    std::copy(std::begin(MANIFEST_MAGIC), std::end(MANIFEST_MAGIC), data.begin());
+    Store<uint32_t>(data.data() + manifest_header::VERSION, MANIFEST_VERSION);
+    Store<uint64_t>(data.data() + manifest_header::SAVE, snapshot.save);
+    Store<uint64_t>(data.data() + manifest_header::JOURNAL_GENERATION, snapshot.journal_generation);
+    Store<uint32_t>(data.data() + manifest_header::SESSIONS, static_cast<uint32_t>(snapshot.sessions.size()));
+    char* record = data.data() + manifest_header::SIZE;
+    for (const ShardedSnapshot::Session& session : snapshot.sessions) {
+        Store<int32_t>(record + manifest_session::ID, session.id);
+        Store<uint64_t>(record + manifest_session::FILE_SAVE, session.file_save);
+        Store<double>(record + manifest_session::FILE_TIME, session.file_time);
+        Store<double>(record + manifest_session::TIME, session.time);
+        record += manifest_session::SIZE;
+    }
+    return data;
+}
+
+// the sessions come without the data and versions, which aren't kept in the manifest
+ShardedSnapshot DecodeManifest(std::span<const char> data) {
+    if (!IsManifest(data)) {
+        throw SnapshotError("Not a snapshot manifest"s);
+    }
+    const uint32_t version = Load<uint32_t>(data.data() + manifest_header::VERSION);
+    if (version == 0 || version > MANIFEST_VERSION) {
+        throw SnapshotError("Unsupported manifest version "s + std::to_string(version));
+    }
+    ShardedSnapshot snapshot;
+    snapshot.save = Load<uint64_t>(data.data() + manifest_header::SAVE);
+    snapshot.journal_generation = Load<uint64_t>(data.data() + manifest_header::JOURNAL_GENERATION);
+    const size_t sessions_count = Load<uint32_t>(data.data() + manifest_header::SESSIONS);
+    if ((data.size() - manifest_header::SIZE) / manifest_session::SIZE < sessions_count) {
+        throw SnapshotError("Manifest is truncated"s);
+    }
+    snapshot.sessions.resize(sessions_count);
+    const char* record = data.data() + manifest_header::SIZE;
+    for (ShardedSnapshot::Session& session : snapshot.sessions) {
+        session.id = Load<int32_t>(record + manifest_session::ID);
+        session.file_save = Load<uint64_t>(record + manifest_session::FILE_SAVE);
+        session.file_time = Load<double>(record + manifest_session::FILE_TIME);
+        session.time = Load<double>(record + manifest_session::TIME);
+        record += manifest_session::SIZE;
+    }
+    return snapshot;
+}
+
+ShardedSnapshot ReadManifest(const std::string& path) {
+    std::ifstream file{path, std::ios::binary};
+    if (!file) {
+        throw SnapshotError("Failed to open "s + path);
+    }
+    const std::vector<char> data{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    return DecodeManifest(data);
+}
+
+// removes the session files, finished or not, the snapshot doesn't refer to
+void RemoveUnusedSessionFiles(const std::string& path, const ShardedSnapshot& snapshot) {
+    std::set<std::string> used;
+    for (const ShardedSnapshot::Session& session : snapshot.sessions) {
+        used.insert(fs::path{GetSessionFilePath(path, session.id, session.file_save)}.filename().string());
+    }
+    const fs::path state_path{path};
+    const fs::path directory = state_path.has_parent_path() ? state_path.parent_path() : fs::path{"."};
+    const std::string prefix = state_path.filename().string() + std::string(SESSION_SUFFIX);
+
+    std::vector<fs::path> unused;
+    std::error_code error;
+    for (const auto& file : fs::directory_iterator{directory, error}) {
+        const std::string file_name = file.path().filename().string();
+        if (file_name.starts_with(prefix) && !used.contains(file_name)) {
+            unused.push_back(file.path());
+        }
+    }
+    for (const fs::path& file : unused) {
+        fs::remove(file, error);
+    }
+}
+
+}  // namespace
+
+ShardedSnapshotWriter::ShardedSnapshotWriter(std::string path, unsigned io_threads)
+    : path_(std::move(path))
+    , io_pool_(io_threads) {
+    if (IsManifestFile(path_)) {
+        next_save_ = ReadManifest(path_).save + 1;
+    }
+}
+
+ShardedSnapshot ShardedSnapshotWriter::Capture(const model::Game& game, uint64_t journal_generation) {
+    ShardedSnapshot snapshot;
+    snapshot.save = next_save_++;
+    snapshot.journal_generation = journal_generation;
+    snapshot.sessions.reserve(game.GetSessions().size());
+
+    std::lock_guard lock{mutex_};
+    for (const auto& [id, session] : game.GetSessions()) {
+        ShardedSnapshot::Session& entry = snapshot.sessions.emplace_back();
+        entry.id = id;
+        entry.version = session->GetVersion();
+        entry.time = session->GetTime();
+        if (auto it = written_.find(id); it != written_.end() && it->second.version == entry.version) {
+            entry.file_save = it->second.save;
+            entry.file_time = it->second.time;
+        } else {
+            entry.file_save = snapshot.save;
+            entry.file_time = entry.time;
+            entry.data = EncodeSessionSnapshot(*session);
+        }
+    }
+    return snapshot;
+}
+
+void ShardedSnapshotWriter::Write(const ShardedSnapshot& snapshot) {
+    std::vector<const ShardedSnapshot::Session*> changed;
+    for (const ShardedSnapshot::Session& session : snapshot.sessions) {
+        if (!session.data.empty()) {
+            changed.push_back(&session);
+        }
+    }
+    io_pool_.ParallelFor(changed.size(), [this, &changed](size_t i) {
+        WriteSnapshotFile(GetSessionFilePath(path_, changed[i]->id, changed[i]->file_save), changed[i]->data);
+    });
+    //the new manifest and the files it refers to are in place at once
+    WriteSnapshotFile(path_, EncodeManifest(snapshot));
+
+    {
+        std::lock_guard lock{mutex_};
+        written_.clear();
+        for (const ShardedSnapshot::Session& session : snapshot.sessions) {
+            written_[session.id] = {session.file_save, session.version, session.file_time};
+        }
+        stats_.sessions_written += changed.size();
+        stats_.sessions_kept += snapshot.sessions.size() - changed.size();
+    }
+    RemoveUnusedSessionFiles(path_, snapshot);
+}
+
+ShardedSnapshotWriter::Stats ShardedSnapshotWriter::GetStats() const {
+    std::lock_guard lock{mutex_};
+    return stats_;
+}
+
+std::string GetSessionFilePath(const std::string& state_path, int session_id, uint64_t save) {
+    return state_path + std::string(SESSION_SUFFIX) + std::to_string(session_id) + '.' + std::to_string(save);
+}
+
+bool IsManifest(std::span<const char> data) noexcept {
+    return data.size() >= manifest_header::SIZE &&
+           std::equal(std::begin(MANIFEST_MAGIC), std::end(MANIFEST_MAGIC), data.begin());
+}
+
+bool IsManifestFile(const std::string& path) {
+    std::ifstream ifs(path, std::ios::binary);
+    char magic[sizeof(MANIFEST_MAGIC)] = {};
+    return ifs.read(magic, sizeof(magic)) && std::equal(std::begin(magic), std::end(magic), std::begin(MANIFEST_MAGIC));
+}
+
+GameState ReadShardedSnapshot(const std::string& path, util::WorkStealingPool* pool) {
+    const ShardedSnapshot manifest = ReadManifest(path);
+
+    std::vector<GameState> sessions(manifest.sessions.size());
+    auto read_session = [&path, &manifest, &sessions](size_t i) {
+        const ShardedSnapshot::Session& entry = manifest.sessions[i];
+        sessions[i] = ReadSnapshotFile(GetSessionFilePath(path, entry.id, entry.file_save));
+        for (auto& [id, session] : sessions[i].sessions) {
+            if (id != entry.id) {
+                throw SnapshotError("Session file has another session "s + std::to_string(id));
+            }
+            for (PlayerState& player : session.players) {
+                AdvancePlayer(player, entry.time - entry.file_time);
+            }
+        }
+    };
+    if (pool) {
+        pool->ParallelFor(sessions.size(), read_session);
+    } else {
+        for (size_t i = 0; i < sessions.size(); ++i) {
+            read_session(i);
+        }
+    }
+
+    GameState state;
+    state.journal_generation = manifest.journal_generation;
+    for (GameState& session_state : sessions) {
+        state.sessions.merge(session_state.sessions);
+    }
+    return state;
+}
+
+}  // namespace serialization
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "model.h"
+#include "snapshot.h"
+#include "thread_pool.h"
+
+namespace serialization {
+
+// Snapshot of the game split by sessions.
+//
+// The file at the state path is a manifest of the sessions, every session is a snapshot of its own
+// (see snapshot.h) in the file <state path>.session.<session id>.<save>, where save is the number of
+// the save that wrote it. A session file is never changed once written. A session whose version hasn't
+// changed since its file was written isn't written again: its dogs have only gone straight or stood
+// still since then (see GameSession::GetVersion), so the manifest refers to the old file and keeps the
+// session time of the file next to the current one. The new session files are written in parallel and
+// then the manifest is replaced by rename, a crash in the middle leaves the previous manifest with all
+// its files. The session files no manifest refers to are removed after the swap.
+//
+// Manifest, little-endian as the snapshot:
+//   magic | u32 version | u64 save | u64 journal generation | u32 sessions count | sessions
+// where a session is its i32 id, the u64 save of its file, the f64 session time of the file
+// and the f64 session time of the manifest.
+constexpr char MANIFEST_MAGIC[4] = {'G', 'S', 'M', 'F'};
+constexpr uint32_t MANIFEST_VERSION = 1;
+
+// sessions of the game taken by ShardedSnapshotWriter::Capture
+struct ShardedSnapshot {
+    struct Session {
+        int id = 0;
+        uint64_t version = 0;
+        // the save that wrote the file of the session
+        uint64_t file_save = 0;
+        double file_time = 0.;
+        double time = 0.;
+        // the file to write, empty if the session keeps the file of an earlier save
+        std::vector<char> data;
+    };
+
+    uint64_t save = 0;
+    uint64_t journal_generation = 0;
+    std::vector<Session> sessions;
+};
+
+class ShardedSnapshotWriter {
+public:
+    struct Stats {
+        size_t sessions_written = 0;
+        size_t sessions_kept = 0;
+    };
+
+    // the saves go on after the one of the manifest found at the path
+    ShardedSnapshotWriter(std::string path, unsigned io_threads);
+
+    ShardedSnapshotWriter(const ShardedSnapshotWriter&) = delete;
+    ShardedSnapshotWriter& operator=(const ShardedSnapshotWriter&) = delete;
+
+    // Encodes the sessions changed since their files were written by the last written snapshot,
+    // the other sessions only get their time. Called under the lock of the game.
+    ShardedSnapshot Capture(const model::Game& game, uint64_t journal_generation = 0);
+    // Writes the new session files on the I/O threads, swaps the manifest and removes the files
+    // of the sessions it doesn't refer to. Snapshots are written one at a time in the order they
+    // were captured in; the ones not written, failed or dropped, do no harm to the later ones.
+    void Write(const ShardedSnapshot& snapshot);
+    Stats GetStats() const;
+
+private:
+    struct SessionFile {
+        uint64_t save = 0;
+        uint64_t version = 0;
+        double time = 0.;
+    };
+
+    const std::string path_;
+    util::WorkStealingPool io_pool_;
+    uint64_t next_save_ = 1;
+
+    mutable std::mutex mutex_;
+    // the session files of the last written manifest
+    std::map<int, SessionFile> written_;
+    Stats stats_;
+};
+
+std::string GetSessionFilePath(const std::string& state_path, int session_id, uint64_t save);
+bool IsManifest(std::span<const char> data) noexcept;
+bool IsManifestFile(const std::string& path);
+// Reads the session files of the manifest, on the threads of the pool if it is given,
+// and moves the dogs of the sessions kept from earlier saves to the time of the manifest.
+GameState ReadShardedSnapshot(const std::string& path, util::WorkStealingPool* pool = nullptr);
+
+}  // namespace serialization
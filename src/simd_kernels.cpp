@@ -0,0 +1,263 @@
+#include "simd_kernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+namespace simd {
+
+namespace {
+
+// ====== Scalar kernels, also used for the tails of the vector ones ======
+
+inline void CalculateNewPositionScalar(const MoveBatch& b, size_t i, double t, double epsilon) {
+    const double destination_x = b.x[i] + b.speed_x[i] * t;
+    const double destination_y = b.y[i] + b.speed_y[i] * t;
+    const double actual_x = std::clamp(destination_x, b.min_x[i], b.max_x[i]);
+    const double actual_y = std::clamp(destination_y, b.min_y[i], b.max_y[i]);
+
+    const bool road_end_met = (std::abs(actual_x - destination_x) > epsilon) ||
+                              (std::abs(actual_y - destination_y) > epsilon);
+    double duration;
+    if (road_end_met) {
+        const double distance_x = actual_x - b.x[i];
+        const double distance_y = actual_y - b.y[i];
+        const double distance_traveled = std::sqrt(distance_x * distance_x + distance_y * distance_y);
+        const double speed = std::sqrt(b.speed_x[i] * b.speed_x[i] + b.speed_y[i] * b.speed_y[i]);
+        duration = speed > 0 ? distance_traveled / speed : 0.0;
+    } else if (b.speed_x[i] == 0. && b.speed_y[i] == 0) {
+        duration = 0.;
+    } else {
+        duration = t;
+    }
+
+    b.end_x[i] = actual_x;
+    b.end_y[i] = actual_y;
+    b.movement_duration[i] = duration;
+    b.road_end_met[i] = road_end_met;
+}
+
+void CalculateNewPositionsScalar(const MoveBatch& batch, size_t from, double t, double epsilon) {
+    for (size_t i = from; i < batch.count; ++i) {
+        CalculateNewPositionScalar(batch, i, t, epsilon);
+    }
+}
+
+inline void TryCollectPointScalar(geom::Point2D a, geom::Point2D b, size_t i, const double* x, const double* y,
+                                  double* sq_distance, double* proj_ratio) {
+    const double u_x = x[i] - a.x;
+    const double u_y = y[i] - a.y;
+    const double v_x = b.x - a.x;
+    const double v_y = b.y - a.y;
+    const double u_dot_v = u_x * v_x + u_y * v_y;
+    const double u_len2 = u_x * u_x + u_y * u_y;
+    const double v_len2 = v_x * v_x + v_y * v_y;
+    proj_ratio[i] = u_dot_v / v_len2;
+    sq_distance[i] = u_len2 - (u_dot_v * u_dot_v) / v_len2;
+}
+
+void TryCollectPointsScalar(geom::Point2D a, geom::Point2D b, size_t from, size_t count, const double* x, const double* y,
+                            double* sq_distance, double* proj_ratio) {
+    for (size_t i = from; i < count; ++i) {
+        TryCollectPointScalar(a, b, i, x, y, sq_distance, proj_ratio);
+    }
+}
+
+#ifdef SIMD_KERNELS_X86
+
+// ====== SSE2 kernels, 2 lanes ======
+
+__attribute__((target("sse2")))
+size_t CalculateNewPositionsSse2(const MoveBatch& b, double t, double epsilon) {
+    const __m128d time = _mm_set1_pd(t);
+    const __m128d eps = _mm_set1_pd(epsilon);
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d sign_mask = _mm_set1_pd(-0.0);
+    size_t i = 0;
+    for (; i + 2 <= b.count; i += 2) {
+        const __m128d x = _mm_loadu_pd(b.x + i);
+        const __m128d y = _mm_loadu_pd(b.y + i);
+        const __m128d vx = _mm_loadu_pd(b.speed_x + i);
+        const __m128d vy = _mm_loadu_pd(b.speed_y + i);
+        const __m128d destination_x = _mm_add_pd(x, _mm_mul_pd(vx, time));
+        const __m128d destination_y = _mm_add_pd(y, _mm_mul_pd(vy, time));
+        const __m128d actual_x = _mm_min_pd(_mm_max_pd(destination_x, _mm_loadu_pd(b.min_x + i)), _mm_loadu_pd(b.max_x + i));
+        const __m128d actual_y = _mm_min_pd(_mm_max_pd(destination_y, _mm_loadu_pd(b.min_y + i)), _mm_loadu_pd(b.max_y + i));
+
+        const __m128d met = _mm_or_pd(_mm_cmpgt_pd(_mm_andnot_pd(sign_mask, _mm_sub_pd(actual_x, destination_x)), eps),
+                                      _mm_cmpgt_pd(_mm_andnot_pd(sign_mask, _mm_sub_pd(actual_y, destination_y)), eps));
+        const __m128d distance_x = _mm_sub_pd(actual_x, x);
+        const __m128d distance_y = _mm_sub_pd(actual_y, y);
+        const __m128d distance = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(distance_x, distance_x), _mm_mul_pd(distance_y, distance_y)));
+        const __m128d speed = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(vx, vx), _mm_mul_pd(vy, vy)));
+        const __m128d duration_met = _mm_and_pd(_mm_cmpgt_pd(speed, zero), _mm_div_pd(distance, speed));
+        const __m128d standing = _mm_and_pd(_mm_cmpeq_pd(vx, zero), _mm_cmpeq_pd(vy, zero));
+        const __m128d duration_free = _mm_andnot_pd(standing, time);
+        const __m128d duration = _mm_or_pd(_mm_and_pd(met, duration_met), _mm_andnot_pd(met, duration_free));
+
+        _mm_storeu_pd(b.end_x + i, actual_x);
+        _mm_storeu_pd(b.end_y + i, actual_y);
+        _mm_storeu_pd(b.movement_duration + i, duration);
+        const int met_bits = _mm_movemask_pd(met);
+        b.road_end_met[i] = met_bits & 1;
+        b.road_end_met[i + 1] = (met_bits >> 1) & 1;
+    }
+    return i;
+}
+
+__attribute__((target("sse2")))
+size_t TryCollectPointsSse2(geom::Point2D a, geom::Point2D b, size_t count, const double* x, const double* y,
+                            double* sq_distance, double* proj_ratio) {
+    const __m128d a_x = _mm_set1_pd(a.x);
+    const __m128d a_y = _mm_set1_pd(a.y);
+    const double v_x = b.x - a.x;
+    const double v_y = b.y - a.y;
+    const __m128d vx = _mm_set1_pd(v_x);
+    const __m128d vy = _mm_set1_pd(v_y);
+    const __m128d v_len2 = _mm_set1_pd(v_x * v_x + v_y * v_y);
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        const __m128d u_x = _mm_sub_pd(_mm_loadu_pd(x + i), a_x);
+        const __m128d u_y = _mm_sub_pd(_mm_loadu_pd(y + i), a_y);
+        const __m128d u_dot_v = _mm_add_pd(_mm_mul_pd(u_x, vx), _mm_mul_pd(u_y, vy));
+        const __m128d u_len2 = _mm_add_pd(_mm_mul_pd(u_x, u_x), _mm_mul_pd(u_y, u_y));
+        _mm_storeu_pd(proj_ratio + i, _mm_div_pd(u_dot_v, v_len2));
+        _mm_storeu_pd(sq_distance + i, _mm_sub_pd(u_len2, _mm_div_pd(_mm_mul_pd(u_dot_v, u_dot_v), v_len2)));
+    }
+    return i;
+}
+
+// ====== AVX2 kernels, 4 lanes ======
+
+__attribute__((target("avx2")))
+size_t CalculateNewPositionsAvx2(const MoveBatch& b, double t, double epsilon) {
+    const __m256d time = _mm256_set1_pd(t);
+    const __m256d eps = _mm256_set1_pd(epsilon);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d sign_mask = _mm256_set1_pd(-0.0);
+    size_t i = 0;
+    for (; i + 4 <= b.count; i += 4) {
+        const __m256d x = _mm256_loadu_pd(b.x + i);
+        const __m256d y = _mm256_loadu_pd(b.y + i);
+        const __m256d vx = _mm256_loadu_pd(b.speed_x + i);
+        const __m256d vy = _mm256_loadu_pd(b.speed_y + i);
+        const __m256d destination_x = _mm256_add_pd(x, _mm256_mul_pd(vx, time));
+        const __m256d destination_y = _mm256_add_pd(y, _mm256_mul_pd(vy, time));
+        const __m256d actual_x = _mm256_min_pd(_mm256_max_pd(destination_x, _mm256_loadu_pd(b.min_x + i)),
+                                               _mm256_loadu_pd(b.max_x + i));
+        const __m256d actual_y = _mm256_min_pd(_mm256_max_pd(destination_y, _mm256_loadu_pd(b.min_y + i)),
+                                               _mm256_loadu_pd(b.max_y + i));
+
+        const __m256d met = _mm256_or_pd(
+            _mm256_cmp_pd(_mm256_andnot_pd(sign_mask, _mm256_sub_pd(actual_x, destination_x)), eps, _CMP_GT_OQ),
+            _mm256_cmp_pd(_mm256_andnot_pd(sign_mask, _mm256_sub_pd(actual_y, destination_y)), eps, _CMP_GT_OQ));
+        const __m256d distance_x = _mm256_sub_pd(actual_x, x);
+        const __m256d distance_y = _mm256_sub_pd(actual_y, y);
+        const __m256d distance = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(distance_x, distance_x),
+                                                              _mm256_mul_pd(distance_y, distance_y)));
+        const __m256d speed = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(vx, vx), _mm256_mul_pd(vy, vy)));
+        const __m256d duration_met = _mm256_and_pd(_mm256_cmp_pd(speed, zero, _CMP_GT_OQ), _mm256_div_pd(distance, speed));
+        const __m256d standing = _mm256_and_pd(_mm256_cmp_pd(vx, zero, _CMP_EQ_OQ), _mm256_cmp_pd(vy, zero, _CMP_EQ_OQ));
+        const __m256d duration_free = _mm256_andnot_pd(standing, time);
+        const __m256d duration = _mm256_blendv_pd(duration_free, duration_met, met);
+
+        _mm256_storeu_pd(b.end_x + i, actual_x);
+        _mm256_storeu_pd(b.end_y + i, actual_y);
+        _mm256_storeu_pd(b.movement_duration + i, duration);
+        const int met_bits = _mm256_movemask_pd(met);
+        for (size_t lane = 0; lane < 4; ++lane) {
+            b.road_end_met[i + lane] = (met_bits >> lane) & 1;
+        }
+    }
+    return i;
+}
+
+__attribute__((target("avx2")))
+size_t TryCollectPointsAvx2(geom::Point2D a, geom::Point2D b, size_t count, const double* x, const double* y,
+                            double* sq_distance, double* proj_ratio) {
+    const __m256d a_x = _mm256_set1_pd(a.x);
+    const __m256d a_y = _mm256_set1_pd(a.y);
+    const double v_x = b.x - a.x;
+    const double v_y = b.y - a.y;
+    const __m256d vx = _mm256_set1_pd(v_x);
+    const __m256d vy = _mm256_set1_pd(v_y);
+    const __m256d v_len2 = _mm256_set1_pd(v_x * v_x + v_y * v_y);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m256d u_x = _mm256_sub_pd(_mm256_loadu_pd(x + i), a_x);
+        const __m256d u_y = _mm256_sub_pd(_mm256_loadu_pd(y + i), a_y);
+        const __m256d u_dot_v = _mm256_add_pd(_mm256_mul_pd(u_x, vx), _mm256_mul_pd(u_y, vy));
+        const __m256d u_len2 = _mm256_add_pd(_mm256_mul_pd(u_x, u_x), _mm256_mul_pd(u_y, u_y));
+        _mm256_storeu_pd(proj_ratio + i, _mm256_div_pd(u_dot_v, v_len2));
+        _mm256_storeu_pd(sq_distance + i, _mm256_sub_pd(u_len2, _mm256_div_pd(_mm256_mul_pd(u_dot_v, u_dot_v), v_len2)));
+    }
+    return i;
+}
+
+InstructionSet DetectInstructionSet() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return InstructionSet::AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return InstructionSet::SSE2;
+    }
+    return InstructionSet::SCALAR;
+}
+
+#else
+
+InstructionSet DetectInstructionSet() {
+    return InstructionSet::SCALAR;
+}
+
+#endif
+
+}  // namespace
+
+InstructionSet GetSupportedInstructionSet() {
+    static const InstructionSet instruction_set = DetectInstructionSet();
+    return instruction_set;
+}
+
+void CalculateNewPositions(const MoveBatch& batch, double time_delta, double epsilon) {
+    CalculateNewPositions(batch, time_delta, epsilon, GetSupportedInstructionSet());
+}
+
+void CalculateNewPositions(const MoveBatch& batch, double time_delta, double epsilon, InstructionSet instruction_set) {
+    instruction_set = std::min(instruction_set, GetSupportedInstructionSet());
+    size_t done = 0;
+#ifdef SIMD_KERNELS_X86
+    if (instruction_set == InstructionSet::AVX2) {
+        done = CalculateNewPositionsAvx2(batch, time_delta, epsilon);
+    } else if (instruction_set == InstructionSet::SSE2) {
+        done = CalculateNewPositionsSse2(batch, time_delta, epsilon);
+    }
+#endif
+    CalculateNewPositionsScalar(batch, done, time_delta, epsilon);
+}
+
+void TryCollectPoints(geom::Point2D a, geom::Point2D b, size_t count, const double* x, const double* y,
+                      double* sq_distance, double* proj_ratio) {
+    TryCollectPoints(a, b, count, x, y, sq_distance, proj_ratio, GetSupportedInstructionSet());
+}
+
+void TryCollectPoints(geom::Point2D a, geom::Point2D b, size_t count, const double* x, const double* y,
+                      double* sq_distance, double* proj_ratio, InstructionSet instruction_set) {
+    instruction_set = std::min(instruction_set, GetSupportedInstructionSet());
+    size_t done = 0;
+#ifdef SIMD_KERNELS_X86
+    if (instruction_set == InstructionSet::AVX2) {
+        done = TryCollectPointsAvx2(a, b, count, x, y, sq_distance, proj_ratio);
+    } else if (instruction_set == InstructionSet::SSE2) {
+        done = TryCollectPointsSse2(a, b, count, x, y, sq_distance, proj_ratio);
+    }
+#endif
+    TryCollectPointsScalar(a, b, done, count, x, y, sq_distance, proj_ratio);
+}
+
+}  // namespace simd
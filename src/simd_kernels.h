@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "geom.h"
+
+// Batch versions of the per-tick arithmetic working on arrays (structure of arrays).
+// Each kernel has AVX2, SSE2 and scalar implementations selected at runtime by the CPU.
+// The vector implementations do the same IEEE operations in the same order as the scalar
+// ones (no fused multiply-add), so all of them give bit-identical results.
+namespace simd {
+
+enum class InstructionSet {
+    SCALAR,
+    SSE2,
+    AVX2,
+};
+
+// the best instruction set supported by this CPU, detected once
+InstructionSet GetSupportedInstructionSet();
+
+// Movement of dogs along their roads during time_delta.
+// Road bounds already include the road width.
+struct MoveBatch {
+    size_t count = 0;
+    const double* x = nullptr;
+    const double* y = nullptr;
+    const double* speed_x = nullptr;
+    const double* speed_y = nullptr;
+    const double* min_x = nullptr;
+    const double* max_x = nullptr;
+    const double* min_y = nullptr;
+    const double* max_y = nullptr;
+
+    double* end_x = nullptr;
+    double* end_y = nullptr;
+    double* movement_duration = nullptr;
+    uint8_t* road_end_met = nullptr;
+};
+
+// same math as model::GameSession::CalculateNewPosition for every element of the batch
+void CalculateNewPositions(const MoveBatch& batch, double time_delta, double epsilon);
+void CalculateNewPositions(const MoveBatch& batch, double time_delta, double epsilon, InstructionSet instruction_set);
+
+// same math as collision_detector::TryCollectPoint(a, b, c) for every point c of the batch
+void TryCollectPoints(geom::Point2D a, geom::Point2D b, size_t count, const double* x, const double* y,
+                      double* sq_distance, double* proj_ratio);
+void TryCollectPoints(geom::Point2D a, geom::Point2D b, size_t count, const double* x, const double* y,
+                      double* sq_distance, double* proj_ratio, InstructionSet instruction_set);
+
+}  // namespace simd
@@ -0,0 +1,513 @@
+#include "snapshot.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+#include "little_endian.h"
+
+namespace serialization {
+
+using namespace std::literals;
+
+namespace {
+
+// sizes and field offsets of the records of version 1
+namespace header {
+constexpr size_t VERSION = 4;
+constexpr size_t PLAYERS = 8;
+constexpr size_t BAG_ITEMS = 12;
+constexpr size_t LOOT = 16;
+constexpr size_t STRINGS = 20;
+// zero in the snapshots written without the journal
+constexpr size_t JOURNAL_GENERATION = 24;
+constexpr size_t SIZE = 32;
+}  // namespace header
+
+namespace player_record {
+constexpr size_t ID = 0;
+constexpr size_t SESSION = 4;
+constexpr size_t NAME = 8;
+constexpr size_t TOKEN = 12;
+constexpr size_t MAP = 16;
+constexpr size_t SCORE = 20;
+constexpr size_t IDLE_TIME = 24;
+constexpr size_t TOTAL_TIME = 32;
+constexpr size_t X = 40;
+constexpr size_t Y = 48;
+constexpr size_t SPEED_X = 56;
+constexpr size_t SPEED_Y = 64;
+constexpr size_t BAG_FIRST = 72;
+constexpr size_t BAG_COUNT = 76;
+constexpr size_t DIRECTION = 80;
+constexpr size_t SIZE = 88;
+}  // namespace player_record
+
+namespace item_record {
+constexpr size_t ID = 0;
+constexpr size_t TYPE = 4;
+constexpr size_t VALUE = 8;
+constexpr size_t SIZE = 12;
+}  // namespace item_record
+
+namespace loot_record {
+constexpr size_t SESSION = 0;
+constexpr size_t ITEM = 4;
+constexpr size_t X = 16;
+constexpr size_t Y = 24;
+constexpr size_t SIZE = 32;
+}  // namespace loot_record
+
+using little_endian::Load;
+using little_endian::Store;
+
+class SnapshotWriter {
+public:
+    explicit SnapshotWriter(size_t players_count) {
+        players_.reserve(players_count * player_record::SIZE);
+        bag_items_.reserve(players_count * item_record::SIZE);
+    }
+
+    void AddPlayer(const app::Player& player, int session_id, const std::string& map_id) {
+        char* record = AddRecord(players_, player_record::SIZE);
+        const std::vector<model::Item> bag = player.GetBag();
+        const app::Coordinates coordinates = player.GetCoordinates();
+        const app::Speed speed = player.GetSpeed();
+        Store<int32_t>(record + player_record::ID, player.GetId());
+        Store<int32_t>(record + player_record::SESSION, session_id);
+        Store<uint32_t>(record + player_record::NAME, AddString(player.GetName()));
+        Store<uint32_t>(record + player_record::TOKEN, AddString(player.GetToken()));
+        Store<uint32_t>(record + player_record::MAP, AddSharedString(map_id));
+        Store<int32_t>(record + player_record::SCORE, player.GetScore());
+        Store<double>(record + player_record::IDLE_TIME, player.GetIdleTime());
+        Store<double>(record + player_record::TOTAL_TIME, player.GetTotalTime());
+        Store<double>(record + player_record::X, coordinates.x);
+        Store<double>(record + player_record::Y, coordinates.y);
+        Store<double>(record + player_record::SPEED_X, speed.x);
+        Store<double>(record + player_record::SPEED_Y, speed.y);
+        Store<uint32_t>(record + player_record::BAG_FIRST, static_cast<uint32_t>(bag_items_.size() / item_record::SIZE));
+        Store<uint32_t>(record + player_record::BAG_COUNT, static_cast<uint32_t>(bag.size()));
+        Store<uint8_t>(record + player_record::DIRECTION, static_cast<uint8_t>(player.GetDirection()));
+        for (const model::Item& item : bag) {
+            StoreItem(AddRecord(bag_items_, item_record::SIZE), item);
+        }
+    }
+
+    void AddLoot(int session_id, const model::LostObject& object) {
+        char* record = AddRecord(loot_, loot_record::SIZE);
+        Store<int32_t>(record + loot_record::SESSION, session_id);
+        StoreItem(record + loot_record::ITEM, object.item);
+        Store<double>(record + loot_record::X, object.coordinates.x);
+        Store<double>(record + loot_record::Y, object.coordinates.y);
+    }
+
+    std::vector<char> Finish(uint64_t journal_generation) const {
+        std::vector<char> data(header::SIZE);
+        data.reserve(header::SIZE + players_.size() + bag_items_.size() + loot_.size() + strings_.size());
+        std::copy(std::begin(SNAPSHOT_MAGIC), std::end(SNAPSHOT_MAGIC), data.begin());
+        Store<uint32_t>(data.data() + header::VERSION, SNAPSHOT_VERSION);
+        Store<uint32_t>(data.data() + header::PLAYERS, static_cast<uint32_t>(players_.size() / player_record::SIZE));
+        Store<uint32_t>(data.data() + header::BAG_ITEMS, static_cast<uint32_t>(bag_items_.size() / item_record::SIZE));
+        Store<uint32_t>(data.data() + header::LOOT, static_cast<uint32_t>(loot_.size() / loot_record::SIZE));
+        Store<uint32_t>(data.data() + header::STRINGS, static_cast<uint32_t>(strings_.size()));
+        Store<uint64_t>(data.data() + header::JOURNAL_GENERATION, journal_generation);
+        data.insert(data.end(), players_.begin(), players_.end());
+        data.insert(data.end(), bag_items_.begin(), bag_items_.end());
+        data.insert(data.end(), loot_.begin(), loot_.end());
+        data.insert(data.end(), strings_.begin(), strings_.end());
+        return data;
+    }
+
+private:
+    static char* AddRecord(std::vector<char>& section, size_t size) {
+        section.resize(section.size() + size);
+        return section.data() + section.size() - size;
+    }
+
+    static void StoreItem(char* record, const model::Item& item) {
+        Store<int32_t>(record + item_record::ID, item.id);
+        Store<int32_t>(record + item_record::TYPE, item.type);
+        Store<int32_t>(record + item_record::VALUE, item.value);
+    }
+
+    uint32_t AddString(const std::string& value) {
+        const auto offset = static_cast<uint32_t>(strings_.size());
+        Store<uint32_t>(AddRecord(strings_, sizeof(uint32_t)), static_cast<uint32_t>(value.size()));
+        strings_.insert(strings_.end(), value.begin(), value.end());
+        return offset;
+    }
+
+    // map ids are stored once for all players of the map
+    uint32_t AddSharedString(const std::string& value) {
+        if (auto it = shared_strings_.find(value); it != shared_strings_.end()) {
+            return it->second;
+        }
+        return shared_strings_[value] = AddString(value);
+    }
+
+    std::vector<char> players_;
+    std::vector<char> bag_items_;
+    std::vector<char> loot_;
+    std::vector<char> strings_;
+    std::unordered_map<std::string, uint32_t> shared_strings_;
+};
+
+class SnapshotReader {
+public:
+    explicit SnapshotReader(std::span<const char> data) : data_(data) {
+        if (!IsSnapshot(data)) {
+            throw SnapshotError("Not a game snapshot"s);
+        }
+        version_ = Load<uint32_t>(data.data() + header::VERSION);
+        if (version_ == 0 || version_ > SNAPSHOT_VERSION) {
+            throw SnapshotError("Unsupported snapshot version "s + std::to_string(version_));
+        }
+        players_count_ = Load<uint32_t>(data.data() + header::PLAYERS);
+        bag_items_count_ = Load<uint32_t>(data.data() + header::BAG_ITEMS);
+        loot_count_ = Load<uint32_t>(data.data() + header::LOOT);
+        strings_size_ = Load<uint32_t>(data.data() + header::STRINGS);
+        journal_generation_ = Load<uint64_t>(data.data() + header::JOURNAL_GENERATION);
+
+        players_ = header::SIZE;
+        bag_items_ = players_ + players_count_ * player_record::SIZE;
+        loot_ = bag_items_ + bag_items_count_ * item_record::SIZE;
+        strings_ = loot_ + loot_count_ * loot_record::SIZE;
+        if (strings_ + strings_size_ > data.size()) {
+            throw SnapshotError("Snapshot is truncated"s);
+        }
+    }
+
+    size_t GetPlayersCount() const noexcept {
+        return players_count_;
+    }
+    uint64_t GetJournalGeneration() const noexcept {
+        return journal_generation_;
+    }
+    size_t GetLootCount() const noexcept {
+        return loot_count_;
+    }
+
+    const char* Player(size_t index) const noexcept {
+        return data_.data() + players_ + index * player_record::SIZE;
+    }
+    const char* Loot(size_t index) const noexcept {
+        return data_.data() + loot_ + index * loot_record::SIZE;
+    }
+
+    std::string_view String(const char* field) const {
+        const uint32_t offset = Load<uint32_t>(field);
+        if (offset > strings_size_ || strings_size_ - offset < sizeof(uint32_t)) {
+            throw SnapshotError("Snapshot string is out of the string table"s);
+        }
+        const char* at = data_.data() + strings_ + offset;
+        const uint32_t length = Load<uint32_t>(at);
+        if (length > strings_size_ - offset - sizeof(uint32_t)) {
+            throw SnapshotError("Snapshot string is out of the string table"s);
+        }
+        return {at + sizeof(uint32_t), length};
+    }
+
+    std::vector<model::Item> Bag(const char* player) const {
+        const uint32_t first = Load<uint32_t>(player + player_record::BAG_FIRST);
+        const uint32_t count = Load<uint32_t>(player + player_record::BAG_COUNT);
+        if (first > bag_items_count_ || count > bag_items_count_ - first) {
+            throw SnapshotError("Snapshot bag is out of the bag items"s);
+        }
+        std::vector<model::Item> bag;
+        bag.reserve(count);
+        for (uint32_t i = first; i < first + count; ++i) {
+            bag.push_back(LoadItem(data_.data() + bag_items_ + i * item_record::SIZE));
+        }
+        return bag;
+    }
+
+    static model::Item LoadItem(const char* record) {
+        return {Load<int32_t>(record + item_record::ID), Load<int32_t>(record + item_record::TYPE),
+                Load<int32_t>(record + item_record::VALUE)};
+    }
+
+private:
+    std::span<const char> data_;
+    uint32_t version_ = 0;
+    uint64_t journal_generation_ = 0;
+    // counts and sizes are 32-bit in the file, the offsets are computed in size_t so they can't wrap
+    size_t players_count_ = 0;
+    size_t bag_items_count_ = 0;
+    size_t loot_count_ = 0;
+    size_t strings_size_ = 0;
+    size_t players_ = 0;
+    size_t bag_items_ = 0;
+    size_t loot_ = 0;
+    size_t strings_ = 0;
+};
+
+// read-only private mapping of a whole file
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd_ < 0) {
+            throw SnapshotError("Failed to open "s + path);
+        }
+        struct stat info {};
+        if (::fstat(fd_, &info) != 0) {
+            ::close(fd_);
+            throw SnapshotError("Failed to read the size of "s + path);
+        }
+        size_ = static_cast<size_t>(info.st_size);
+        if (size_ == 0) {
+            return;
+        }
+        data_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+        if (data_ == MAP_FAILED) {
+            ::close(fd_);
+            throw SnapshotError("Failed to map "s + path);
+        }
+        // the whole snapshot is read at once, the sessions of it in parallel
+        ::madvise(data_, size_, MADV_WILLNEED);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+        if (size_ != 0) {
+            ::munmap(data_, size_);
+        }
+        ::close(fd_);
+    }
+
+    std::span<const char> GetData() const noexcept {
+        if (size_ == 0) {
+            return {};
+        }
+        return {static_cast<const char*>(data_), size_};
+    }
+
+private:
+    int fd_ = -1;
+    void* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+void AddSession(SnapshotWriter& writer, const model::GameSession& session) {
+    const int id = session.GetId();
+    const std::string map_id = session.GetMapID();
+    for (const auto& player : session.GetPlayers()) {
+        writer.AddPlayer(*player, id, map_id);
+    }
+    for (const auto& [loot_id, object] : session.GetLostObjects()) {
+        writer.AddLoot(id, object);
+    }
+}
+
+}  // namespace
+
+std::vector<char> EncodeSnapshot(const model::Game& game, uint64_t journal_generation) {
+    size_t players_count = 0;
+    for (const auto& [id, session] : game.GetSessions()) {
+        players_count += session->GetPlayersCount();
+    }
+
+    SnapshotWriter writer{players_count};
+    for (const auto& [id, session] : game.GetSessions()) {
+        AddSession(writer, *session);
+    }
+    return writer.Finish(journal_generation);
+}
+
+std::vector<char> EncodeSessionSnapshot(const model::GameSession& session) {
+    SnapshotWriter writer{session.GetPlayersCount()};
+    AddSession(writer, session);
+    return writer.Finish(0);
+}
+
+void AdvancePlayer(PlayerState& player, double elapsed) {
+    if (elapsed <= 0.) {
+        return;
+    }
+    if (player.speed.x != 0. || player.speed.y != 0.) {
+        player.coordinates.x += player.speed.x * elapsed;
+        player.coordinates.y += player.speed.y * elapsed;
+    } else {
+        player.idle_time += elapsed;
+    }
+    player.total_time += elapsed;
+}
+
+namespace {
+
+// records of a session as ranges of record indices, a session written by EncodeSnapshot has one range of each kind
+struct SessionRecords {
+    using Range = std::pair<size_t, size_t>;
+
+    SessionState* session = nullptr;
+    std::vector<Range> players;
+    std::vector<Range> loot;
+};
+
+// the session id of every record is read to split the records between the sessions, nothing else is decoded
+template <typename GetSessionId>
+void FindSessionRecords(size_t records_count, GetSessionId get_session_id, std::map<int, SessionRecords>& sessions,
+                        std::vector<SessionRecords::Range> SessionRecords::*ranges) {
+    SessionRecords* current = nullptr;
+    int current_id = 0;
+    for (size_t i = 0; i < records_count; ++i) {
+        const int session_id = get_session_id(i);
+        if (!current || current_id != session_id) {
+            current = &sessions[session_id];
+            current_id = session_id;
+            (current->*ranges).emplace_back(i, i);
+        }
+        ++(current->*ranges).back().second;
+    }
+}
+
+void DecodePlayer(const SnapshotReader& reader, const char* record, PlayerState& player) {
+    const uint8_t direction = Load<uint8_t>(record + player_record::DIRECTION);
+    if (direction > static_cast<uint8_t>(app::Direction::EAST)) {
+        throw SnapshotError("Snapshot has a wrong direction"s);
+    }
+    player.id = Load<int32_t>(record + player_record::ID);
+    player.name = reader.String(record + player_record::NAME);
+    player.token = reader.String(record + player_record::TOKEN);
+    player.score = Load<int32_t>(record + player_record::SCORE);
+    player.idle_time = Load<double>(record + player_record::IDLE_TIME);
+    player.total_time = Load<double>(record + player_record::TOTAL_TIME);
+    player.coordinates = {Load<double>(record + player_record::X), Load<double>(record + player_record::Y)};
+    player.speed = {Load<double>(record + player_record::SPEED_X), Load<double>(record + player_record::SPEED_Y)};
+    player.direction = static_cast<app::Direction>(direction);
+    player.bag = reader.Bag(record);
+}
+
+void DecodeSession(const SnapshotReader& reader, const SessionRecords& records) {
+    SessionState& session = *records.session;
+    size_t players_count = 0;
+    for (const auto& [first, last] : records.players) {
+        players_count += last - first;
+    }
+    session.players.reserve(players_count);
+    if (!records.players.empty()) {
+        session.map_id = reader.String(reader.Player(records.players.front().first) + player_record::MAP);
+    }
+    for (const auto& [first, last] : records.players) {
+        for (size_t i = first; i < last; ++i) {
+            DecodePlayer(reader, reader.Player(i), session.players.emplace_back());
+        }
+    }
+    //loot is written in the order of ids, so every item goes to the end of the map
+    for (const auto& [first, last] : records.loot) {
+        for (size_t i = first; i < last; ++i) {
+            const char* record = reader.Loot(i);
+            const model::Item item = SnapshotReader::LoadItem(record + loot_record::ITEM);
+            session.loot.insert_or_assign(session.loot.end(), item.id,
+                                          model::LostObject{item, {Load<double>(record + loot_record::X),
+                                                                   Load<double>(record + loot_record::Y)}});
+        }
+    }
+}
+
+}  // namespace
+
+GameState DecodeSnapshot(std::span<const char> data, util::WorkStealingPool* pool) {
+    const SnapshotReader reader{data};
+
+    GameState state;
+    state.journal_generation = reader.GetJournalGeneration();
+
+    std::map<int, SessionRecords> records;
+    FindSessionRecords(
+        reader.GetPlayersCount(),
+        [&reader](size_t i) {
+            return Load<int32_t>(reader.Player(i) + player_record::SESSION);
+        },
+        records, &SessionRecords::players);
+    FindSessionRecords(
+        reader.GetLootCount(),
+        [&reader](size_t i) {
+            return Load<int32_t>(reader.Loot(i) + loot_record::SESSION);
+        },
+        records, &SessionRecords::loot);
+
+    //the sessions of the state are created beforehand, the tasks fill them without touching the map
+    std::vector<const SessionRecords*> tasks;
+    tasks.reserve(records.size());
+    for (auto& [session_id, session_records] : records) {
+        SessionState& session = state.sessions[session_id];
+        session.id = session_id;
+        session_records.session = &session;
+        tasks.push_back(&session_records);
+    }
+    auto decode_session = [&reader, &tasks](size_t i) {
+        DecodeSession(reader, *tasks[i]);
+    };
+    if (pool) {
+        pool->ParallelFor(tasks.size(), decode_session);
+    } else {
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            decode_session(i);
+        }
+    }
+    return state;
+}
+
+void RestoreState(GameState state, model::Game& game, util::WorkStealingPool* pool) {
+    std::vector<model::RestoredSession> sessions;
+    sessions.reserve(state.sessions.size());
+    for (auto& [session_id, session] : state.sessions) {
+        //sessions are restored with their players, loot of a session left without players is dropped
+        if (session.players.empty()) {
+            continue;
+        }
+        const model::Map* map = game.FindMap(model::Map::Id{session.map_id});
+        if (!map) {
+            throw SnapshotError("Snapshot refers to an unknown map "s + session.map_id);
+        }
+        sessions.push_back({session_id, map, std::move(session.players), std::move(session.loot)});
+    }
+    game.RestoreSessions(std::move(sessions), pool);
+}
+
+void DecodeSnapshot(std::span<const char> data, model::Game& game) {
+    RestoreState(DecodeSnapshot(data), game);
+}
+
+bool IsSnapshot(std::span<const char> data) noexcept {
+    return data.size() >= header::SIZE && std::equal(std::begin(SNAPSHOT_MAGIC), std::end(SNAPSHOT_MAGIC), data.begin());
+}
+
+bool IsSnapshotFile(const std::string& path) {
+    std::ifstream ifs(path, std::ios::binary);
+    char magic[sizeof(SNAPSHOT_MAGIC)] = {};
+    return ifs.read(magic, sizeof(magic)) && std::equal(std::begin(magic), std::end(magic), std::begin(SNAPSHOT_MAGIC));
+}
+
+void WriteSnapshotFile(const std::string& path, std::span<const char> data) {
+    namespace fs = std::filesystem;
+
+    const std::string temp_path = path + ".tmp";
+    {
+        // the snapshot is already in memory, so it goes to the file in one write
+        std::ofstream ofs(temp_path, std::ios::binary | std::ios::trunc);
+        if (!ofs.write(data.data(), static_cast<std::streamsize>(data.size())) || !ofs.flush()) {
+            throw SnapshotError("Failed to write "s + temp_path);
+        }
+    }
+    // rename replaces the old snapshot at once, a reader sees either the old file or the new one
+    fs::rename(temp_path, path);
+}
+
+GameState ReadSnapshotFile(const std::string& path, util::WorkStealingPool* pool) {
+    const MappedFile file{path};
+    return DecodeSnapshot(file.GetData(), pool);
+}
+
+}  // namespace serialization
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "model.h"
+#include "thread_pool.h"
+
+namespace serialization {
+
+// Binary snapshot of the game state.
+//
+// All numbers are little-endian, whatever the byte order of the machine. A snapshot is
+//   header | player records | bag item records | loot records | string table
+// where the records of each kind have the same size, so a record is found by its index.
+// Strings of the records are offsets into the string table, where each one is its u32 length
+// and bytes. Players are stored session by session in the order of their dogs, a restored
+// session ticks the same way as the saved one. The header keeps the generation of the journal
+// segment started together with the snapshot, see journal.h.
+constexpr char SNAPSHOT_MAGIC[4] = {'G', 'S', 'S', 'N'};
+constexpr uint32_t SNAPSHOT_VERSION = 1;
+
+class SnapshotError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// players and loot of the game as they are stored in a snapshot
+using model::PlayerState;
+
+struct SessionState {
+    int id = 0;
+    // empty for a session with loot and no players
+    std::string map_id;
+    // in the order of the dogs of the session
+    std::vector<PlayerState> players;
+    model::Game::LostObjects loot;
+};
+
+struct GameState {
+    // the journal segments of this generation and the later ones go on top of the snapshot
+    uint64_t journal_generation = 0;
+    std::map<int, SessionState> sessions;
+};
+
+std::vector<char> EncodeSnapshot(const model::Game& game, uint64_t journal_generation = 0);
+// snapshot of one session, see sharded_snapshot.h
+std::vector<char> EncodeSessionSnapshot(const model::GameSession& session);
+// sessions are decoded independently of each other, on the threads of the pool if it is given
+GameState DecodeSnapshot(std::span<const char> data, util::WorkStealingPool* pool = nullptr);
+// adds the players and loot of the state to the game, its maps should be loaded already,
+// see Game::RestoreSessions
+void RestoreState(GameState state, model::Game& game, util::WorkStealingPool* pool = nullptr);
+void DecodeSnapshot(std::span<const char> data, model::Game& game);
+
+// moves the player elapsed milliseconds on, its dog goes straight or stands still all that time
+void AdvancePlayer(PlayerState& player, double elapsed);
+
+bool IsSnapshot(std::span<const char> data) noexcept;
+bool IsSnapshotFile(const std::string& path);
+
+// the data is written to path.tmp first and then renamed to path
+void WriteSnapshotFile(const std::string& path, std::span<const char> data);
+// the file is memory-mapped and decoded in place
+GameState ReadSnapshotFile(const std::string& path, util::WorkStealingPool* pool = nullptr);
+
+}  // namespace serialization
@@ -0,0 +1,96 @@
+#include "snapshot_saver.h"
+
+#include <utility>
+
+#include "snapshot.h"
+
+namespace serialization {
+
+SnapshotSaver::SnapshotSaver(std::string path, ErrorHandler on_error)
+    : path_(std::move(path))
+    , on_error_(std::move(on_error))
+    , thread_([this] {
+        Run();
+    }) {
+}
+
+SnapshotSaver::~SnapshotSaver() {
+    {
+        std::lock_guard lock{mutex_};
+        stop_ = true;
+    }
+    work_cv_.notify_one();
+    thread_.join();
+}
+
+void SnapshotSaver::Save(std::vector<char> snapshot, std::function<void()> on_written) {
+    SaveWith(
+        [this, snapshot = std::move(snapshot)] {
+            WriteSnapshotFile(path_, snapshot);
+        },
+        std::move(on_written));
+}
+
+void SnapshotSaver::SaveWith(std::function<void()> write, std::function<void()> on_written) {
+    {
+        std::lock_guard lock{mutex_};
+        if (queued_) {
+            ++stats_.coalesced;
+        }
+        queued_ = QueuedSnapshot{std::move(write), std::move(on_written)};
+    }
+    work_cv_.notify_one();
+}
+
+bool SnapshotSaver::IsBusy() const {
+    std::lock_guard lock{mutex_};
+    return queued_ || writing_;
+}
+
+void SnapshotSaver::Wait() {
+    std::unique_lock lock{mutex_};
+    done_cv_.wait(lock, [this] {
+        return !queued_ && !writing_;
+    });
+}
+
+SnapshotSaver::Stats SnapshotSaver::GetStats() const {
+    std::lock_guard lock{mutex_};
+    return stats_;
+}
+
+void SnapshotSaver::Run() {
+    std::unique_lock lock{mutex_};
+    while (true) {
+        work_cv_.wait(lock, [this] {
+            return queued_ || stop_;
+        });
+        if (!queued_) {
+            return;
+        }
+        QueuedSnapshot snapshot = std::move(*queued_);
+        queued_.reset();
+        writing_ = true;
+        lock.unlock();
+
+        bool written = true;
+        try {
+            snapshot.write();
+            if (snapshot.on_written) {
+                snapshot.on_written();
+            }
+        } catch (const std::exception& error) {
+            written = false;
+            if (on_error_) {
+                on_error_(error);
+            }
+        }
+
+        lock.lock();
+        writing_ = false;
+        ++(written ? stats_.written : stats_.failed);
+        done_cv_.notify_all();
+    }
+}
+
+}  // namespace serialization
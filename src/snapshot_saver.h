@@ -0,0 +1,69 @@
+#pragma once
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace serialization {
+
+// Writes snapshots to a file on its own thread, so the caller only pays for capturing the state.
+// One snapshot is written at a time; a snapshot queued while another one is being written
+// replaces the one queued before it, only the newest state reaches the file.
+class SnapshotSaver {
+public:
+    using ErrorHandler = std::function<void(const std::exception& error)>;
+
+    struct Stats {
+        size_t written = 0;
+        // snapshots replaced by a newer one before they were written
+        size_t coalesced = 0;
+        size_t failed = 0;
+    };
+
+    // on_error is called on the saver thread when a snapshot can't be written
+    explicit SnapshotSaver(std::string path, ErrorHandler on_error = {});
+    // writes the queued snapshot before the thread stops
+    ~SnapshotSaver();
+
+    SnapshotSaver(const SnapshotSaver&) = delete;
+    SnapshotSaver& operator=(const SnapshotSaver&) = delete;
+
+    // on_written is called on the saver thread after the snapshot has replaced the file,
+    // it is dropped together with a snapshot replaced by a newer one
+    void Save(std::vector<char> snapshot, std::function<void()> on_written = {});
+    // the same for a state written some other way, e.g. split between several files,
+    // write is called on the saver thread and reports a failure by an exception
+    void SaveWith(std::function<void()> write, std::function<void()> on_written = {});
+    // true while a snapshot is queued or being written
+    bool IsBusy() const;
+    // returns when the snapshots queued before the call are written
+    void Wait();
+    Stats GetStats() const;
+
+private:
+    struct QueuedSnapshot {
+        std::function<void()> write;
+        std::function<void()> on_written;
+    };
+
+    void Run();
+
+    const std::string path_;
+    const ErrorHandler on_error_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+    std::optional<QueuedSnapshot> queued_;
+    bool writing_ = false;
+    bool stop_ = false;
+    Stats stats_;
+    std::jthread thread_;
+};
+
+}  // namespace serialization
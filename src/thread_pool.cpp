@@ -0,0 +1,132 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace util {
+
+WorkStealingPool::WorkStealingPool(unsigned threads_count) {
+    threads_count = std::max(1u, threads_count);
+    queues_.reserve(threads_count);
+    for (unsigned i = 0; i < threads_count; ++i) {
+        queues_.push_back(std::make_unique<TaskQueue>());
+    }
+    // queue 0 belongs to the thread calling ParallelFor
+    workers_.reserve(threads_count - 1);
+    for (unsigned i = 1; i < threads_count; ++i) {
+        workers_.emplace_back([this, i] {
+            WorkerLoop(i);
+        });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard lock{mutex_};
+        stop_ = true;
+    }
+    work_cv_.notify_all();
+    workers_.clear();
+}
+
+void WorkStealingPool::ParallelFor(size_t tasks_count, const TaskBody& body) {
+    if (tasks_count == 0) {
+        return;
+    }
+    std::lock_guard run_lock{run_mutex_};
+
+    {
+        std::lock_guard lock{mutex_};
+        body_ = &body;
+        error_ = nullptr;
+        pending_tasks_ = tasks_count;
+    }
+    for (size_t task = 0; task < tasks_count; ++task) {
+        TaskQueue& queue = *queues_[task % queues_.size()];
+        std::lock_guard lock{queue.mutex};
+        queue.tasks.push_back(task);
+    }
+    {
+        std::lock_guard lock{mutex_};
+        ++generation_;
+    }
+    work_cv_.notify_all();
+
+    while (TryRunTask(0)) {
+    }
+
+    std::unique_lock lock{mutex_};
+    done_cv_.wait(lock, [this] {
+        return pending_tasks_ == 0;
+    });
+    body_ = nullptr;
+    if (error_) {
+        std::rethrow_exception(std::exchange(error_, nullptr));
+    }
+}
+
+void WorkStealingPool::WorkerLoop(size_t worker) {
+    uint64_t seen_generation = 0;
+    while (true) {
+        {
+            std::unique_lock lock{mutex_};
+            work_cv_.wait(lock, [this, seen_generation] {
+                return stop_ || generation_ != seen_generation;
+            });
+            if (stop_) {
+                return;
+            }
+            seen_generation = generation_;
+        }
+        while (TryRunTask(worker)) {
+        }
+    }
+}
+
+bool WorkStealingPool::TryRunTask(size_t worker) {
+    size_t task;
+    if (!TryPopOwn(worker, task) && !TrySteal(worker, task)) {
+        return false;
+    }
+
+    try {
+        (*body_)(task);
+    } catch (...) {
+        std::lock_guard lock{mutex_};
+        if (!error_) {
+            error_ = std::current_exception();
+        }
+    }
+
+    if (pending_tasks_.fetch_sub(1) == 1) {
+        std::lock_guard lock{mutex_};
+        done_cv_.notify_all();
+    }
+    return true;
+}
+
+bool WorkStealingPool::TryPopOwn(size_t worker, size_t& task) {
+    TaskQueue& queue = *queues_[worker];
+    std::lock_guard lock{queue.mutex};
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task = queue.tasks.back();
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::TrySteal(size_t worker, size_t& task) {
+    for (size_t shift = 1; shift < queues_.size(); ++shift) {
+        TaskQueue& queue = *queues_[(worker + shift) % queues_.size()];
+        std::lock_guard lock{queue.mutex};
+        if (!queue.tasks.empty()) {
+            task = queue.tasks.front();
+            queue.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace util
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace util {
+
+// Fixed set of threads running index-parallel loops.
+// Each thread owns a queue of task indices; a thread that runs out of work steals
+// from the other queues, so tasks of uneven cost (e.g. sessions of different size)
+// still keep all threads busy. The calling thread takes part in the work.
+class WorkStealingPool {
+public:
+    using TaskBody = std::function<void(size_t task_index)>;
+
+    // threads_count includes the calling thread, so 1 means no extra threads
+    explicit WorkStealingPool(unsigned threads_count);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    unsigned GetThreadsCount() const noexcept {
+        return static_cast<unsigned>(queues_.size());
+    }
+
+    // runs body(i) for every i in [0, tasks_count) and returns when all of them have finished,
+    // the first exception thrown by a task is rethrown here
+    void ParallelFor(size_t tasks_count, const TaskBody& body);
+
+private:
+    struct TaskQueue {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    void WorkerLoop(size_t worker);
+    // runs one task from the worker's own queue or a stolen one, returns false if there is none
+    bool TryRunTask(size_t worker);
+    bool TryPopOwn(size_t worker, size_t& task);
+    bool TrySteal(size_t worker, size_t& task);
+
+    std::vector<std::unique_ptr<TaskQueue>> queues_;
+    std::vector<std::jthread> workers_;
+
+    std::mutex run_mutex_;
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+    const TaskBody* body_ = nullptr;
+    std::atomic<size_t> pending_tasks_ = 0;
+    uint64_t generation_ = 0;
+    bool stop_ = false;
+    std::exception_ptr error_;
+};
+
+}  // namespace util
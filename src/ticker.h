@@ -2,7 +2,10 @@
 #include <boost/program_options.hpp>
 #include <boost/asio/strand.hpp>
 
+#include <algorithm>
+#include <chrono>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <optional>
 #include <vector>
@@ -16,10 +19,21 @@ struct Args {
     std::string config_file_path;
     std::string static_data_path;   
     std::string state_path; 
+    std::string record_input_path;
     int tick_period;
     int save_state_period;
+    double fixed_step = 0.;
+    int max_substeps = 5;
+    unsigned tick_threads = 0;
+    size_t parallel_session_players = 0;
+    std::optional<uint64_t> random_seed;
     bool randomize_spawn_points = false;
+    bool kinetic_events = false;
+    bool state_journal = false;
+    // 0 keeps the whole state in one file
+    unsigned state_io_threads = 0;
     bool tick_period_specified = false;
+    bool fixed_step_specified = false;
     bool state_path_specified = false;
     bool save_state_period_specified = false;
 };
@@ -37,7 +51,16 @@ struct Args {
         ("config-file,c", po::value(&args.config_file_path)->value_name("file"s), "set config file path")
         ("www-root,w", po::value(&args.static_data_path)->value_name("dir"s), "set static files root")
         ("state-file", po::value(&args.state_path)->value_name("state"s), "set state file path")
-        ("randomize-spawn-points", "spawn dogs at random positions");
+        ("state-journal", "append the changes of every tick to a journal next to the state file, the state is saved in full only every save state period")
+        ("state-shards", po::value(&args.state_io_threads)->value_name("threads"s), "save the state as a file per game session written on the given number of threads, the sessions not changed since the previous save are not written again")
+        ("record-input", po::value(&args.record_input_path)->value_name("file"s), "write the inputs of the game to a log for game_replay")
+        ("fixed-step", po::value(&args.fixed_step)->value_name("milliseconds"s), "update the game in steps of fixed duration")
+        ("max-substeps", po::value(&args.max_substeps)->value_name("steps"s), "max fixed steps made per tick, the time left is dropped")
+        ("tick-threads", po::value(&args.tick_threads)->value_name("threads"s), "update game sessions in parallel on the given number of threads")
+        ("parallel-session-players", po::value(&args.parallel_session_players)->value_name("players"s), "split sessions with at least the given number of players between the tick threads")
+        ("randomize-spawn-points", "spawn dogs at random positions")
+        ("random-seed", po::value<uint64_t>()->value_name("seed"s), "seed of loot, spawn points and tokens, overrides randomSeed of the config")
+        ("kinetic-events", "move dogs by predicted events instead of every tick");
 
     po::variables_map vm;
     po::store(po::parse_command_line(argc, argv, desc), vm);
@@ -51,14 +74,37 @@ struct Args {
     if (vm.contains("randomize-spawn-points"s)) {
         args.randomize_spawn_points = true;
     }   
+    if (vm.contains("kinetic-events"s)) {
+        args.kinetic_events = true;
+    }
+    if (vm.contains("random-seed"s)) {
+        args.random_seed = vm["random-seed"s].as<uint64_t>();
+    }
     if (vm.contains("tick-period"s)) {
         args.tick_period_specified = true;    
     }
+    if (vm.contains("fixed-step"s)) {
+        if (!args.tick_period_specified) {
+            throw std::runtime_error("fixed step requires the tick period"s);
+        }
+        if (args.fixed_step <= 0.) {
+            throw std::runtime_error("fixed step should be positive"s);
+        }
+        args.fixed_step_specified = true;
+    }
     if (vm.contains("state-file"s)) {
         args.state_path_specified = true; 
         if (vm.contains("save-state-period"s)) {
             args.save_state_period_specified = true;    
         }   
+        args.state_journal = vm.contains("state-journal"s);
+        if (vm.contains("state-shards"s) && args.state_io_threads == 0) {
+            throw std::runtime_error("state shards should be written on at least one thread"s);
+        }
+    } else if (vm.contains("state-journal"s)) {
+        throw std::runtime_error("state journal requires the state file"s);
+    } else if (vm.contains("state-shards"s)) {
+        throw std::runtime_error("state shards require the state file"s);
     }
     if (!vm.contains("config-file"s)) {
         throw std::runtime_error("path to config file has not been specified"s);
@@ -70,10 +116,67 @@ struct Args {
     return args;
 }
 
+// Spends the elapsed time in equal steps. The time left after a whole step is kept for the
+// next call, so the steps stay in phase with the clock. At most max_substeps steps are made
+// per call, the whole steps that didn't fit are dropped and reported as an overrun.
+class FixedSteps {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Overrun {
+        int substeps;
+        int dropped_steps;
+        // milliseconds
+        double dropped_time;
+    };
+
+    FixedSteps(Clock::duration step, int max_substeps)
+        : step_{step}
+        , max_substeps_{std::max(1, max_substeps)} {
+    }
+
+    // returns the number of steps to make now
+    int Advance(Clock::duration elapsed, std::optional<Overrun>& overrun) {
+        accumulated_ += elapsed;
+        int substeps = 0;
+        while (accumulated_ >= step_ && substeps < max_substeps_) {
+            accumulated_ -= step_;
+            ++substeps;
+        }
+        overrun.reset();
+        if (accumulated_ >= step_) {
+            const auto dropped_steps = accumulated_ / step_;
+            accumulated_ %= step_;
+            overrun = Overrun{substeps, static_cast<int>(dropped_steps),
+                              std::chrono::duration<double, std::milli>(dropped_steps * step_).count()};
+        }
+        return substeps;
+    }
+
+    Clock::duration GetStep() const noexcept {
+        return step_;
+    }
+
+    Clock::duration GetAccumulated() const noexcept {
+        return accumulated_;
+    }
+
+private:
+    Clock::duration step_;
+    int max_substeps_;
+    Clock::duration accumulated_{0};
+};
+
 class Ticker : public std::enable_shared_from_this<Ticker> {
 public:
     using Strand = net::strand<net::io_context::executor_type>;
-    using Handler = std::function<void(std::chrono::milliseconds delta)>;
+    using Clock = std::chrono::steady_clock;
+    // delta is in milliseconds
+    using Handler = std::function<void(double delta)>;
+
+    // catch-up limit hit in the fixed step mode, the time that didn't fit is dropped
+    using Overrun = FixedSteps::Overrun;
+    using OverrunHandler = std::function<void(const Overrun& overrun)>;
 
     Ticker(Strand strand, std::chrono::milliseconds period, Handler handler)
         : strand_{strand}
@@ -81,6 +184,13 @@ public:
         , handler_{std::move(handler)} {
     }
 
+    // Instead of the elapsed time the handler gets equal steps, the elapsed time is accumulated
+    // and spent in whole steps. At most max_substeps steps are made per wakeup.
+    void SetFixedStep(Clock::duration step, int max_substeps, OverrunHandler overrun_handler = {}) {
+        fixed_steps_.emplace(step, max_substeps);
+        overrun_handler_ = std::move(overrun_handler);
+    }
+
     void Start() {
         net::dispatch(strand_, [self = shared_from_this()] {
             self->last_tick_ = Clock::now();
@@ -98,26 +208,49 @@ private:
     }
 
     void OnTick(sys::error_code ec) {
-        using namespace std::chrono;
         assert(strand_.running_in_this_thread());
 
         if (!ec) {
             auto this_tick = Clock::now();
-            auto delta = duration_cast<milliseconds>(this_tick - last_tick_);
+            auto delta = this_tick - last_tick_;
             last_tick_ = this_tick;
-            try {
-                handler_(delta);
-            } catch (...) {
+            if (fixed_steps_) {
+                RunFixedSteps(delta);
+            } else {
+                RunHandler(ToMilliseconds(delta));
             }
             ScheduleTick();
         }
     }
 
-    using Clock = std::chrono::steady_clock;
+    void RunFixedSteps(Clock::duration delta) {
+        std::optional<Overrun> overrun;
+        const int substeps = fixed_steps_->Advance(delta, overrun);
+        for (int i = 0; i < substeps; ++i) {
+            RunHandler(ToMilliseconds(fixed_steps_->GetStep()));
+        }
+        if (overrun && overrun_handler_) {
+            overrun_handler_(*overrun);
+        }
+    }
+
+    void RunHandler(double delta) {
+        try {
+            handler_(delta);
+        } catch (...) {
+        }
+    }
+
+    static double ToMilliseconds(Clock::duration duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
 
     Strand strand_;
     std::chrono::milliseconds period_;
     net::steady_timer timer_{strand_};
     Handler handler_;
-    std::chrono::steady_clock::time_point last_tick_;
-};
\ No newline at end of file
+    Clock::time_point last_tick_;
+
+    std::optional<FixedSteps> fixed_steps_;
+    OverrunHandler overrun_handler_;
+};
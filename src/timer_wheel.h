@@ -0,0 +1,308 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace util {
+
+// Hierarchical timing wheel: timers keyed by Id fire when the clock passes their deadlines.
+// Time is split into slots of the given resolution. The lowest level has a bucket per slot,
+// every next level has a bucket per 256 buckets of the previous one, and its timers move
+// down a level when the clock reaches their bucket. Scheduling and cancelling are O(1).
+// Every level keeps a bitmap of its non-empty buckets and advancing jumps the clock from one
+// non-empty bucket to the next, so it costs the number of passed non-empty buckets plus the number
+// of fired and moved timers, however far the clock moves.
+// Timers are nodes of doubly linked bucket lists, so a cancelled or rescheduled timer is unlinked
+// at once. The nodes are kept in a pool sized for all known ids and are reused, and an id keeps
+// its entry when its timer fires or is cancelled, so memory is allocated only when an id is
+// scheduled for the first time.
+template <typename Id>
+class TimerWheel {
+public:
+    explicit TimerWheel(double resolution = 1.)
+        : resolution_{resolution} {
+    }
+
+    // sets the timer of id to the deadline, an earlier timer of id is cancelled
+    void Schedule(Id id, double deadline) {
+        auto [it, inserted] = id_nodes_.try_emplace(id, NO_NODE);
+        if (inserted && nodes_.capacity() < id_nodes_.size()) {
+            // every id has at most one node, so the pool never grows beyond the number of ids
+            nodes_.reserve(std::max(id_nodes_.size(), 2 * nodes_.capacity()));
+        }
+        uint32_t& node = it->second;
+        if (node == NO_NODE) {
+            node = AllocateNode();
+            ++size_;
+        } else {
+            Unlink(node);
+        }
+        nodes_[node].timer = {id, deadline, ToSlot(deadline)};
+        Link(node);
+    }
+
+    // stops the timer of id if any, the id keeps its entry for the next Schedule
+    void Cancel(Id id) {
+        auto it = id_nodes_.find(id);
+        if (it == id_nodes_.end() || it->second == NO_NODE) {
+            return;
+        }
+        Unlink(it->second);
+        FreeNode(it->second);
+        it->second = NO_NODE;
+        --size_;
+    }
+
+    // forgets the id which won't be scheduled again, its timer if any won't fire
+    void Remove(Id id) {
+        Cancel(id);
+        id_nodes_.erase(id);
+    }
+
+    // allocates memory for count ids at once
+    void Reserve(size_t count) {
+        id_nodes_.reserve(count);
+        nodes_.reserve(count);
+    }
+
+    bool IsScheduled(Id id) const {
+        auto it = id_nodes_.find(id);
+        return it != id_nodes_.end() && it->second != NO_NODE;
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    // moves the clock to now and appends ids of the timers with deadline <= now to expired
+    void Advance(double now, std::vector<Id>& expired) {
+        const uint64_t target = ToSlot(now);
+        if (size_ == 0) {
+            current_slot_ = std::max(current_slot_, target);
+            return;
+        }
+        while (true) {
+            FireSlot(now, expired);
+            if (current_slot_ >= target) {
+                break;
+            }
+            // the slots before the next non-empty bucket have no timers to fire or move down
+            current_slot_ = std::min(FindNextEventSlot(), target);
+            Cascade();
+        }
+    }
+
+private:
+    static constexpr int LEVELS = 4;
+    static constexpr int SLOT_BITS = 8;
+    static constexpr size_t SLOTS = size_t{1} << SLOT_BITS;
+    // buckets of all levels one after another and the overflow bucket after them
+    static constexpr size_t OVERFLOW_BUCKET = LEVELS * SLOTS;
+    static constexpr uint64_t NEVER = std::numeric_limits<uint64_t>::max();
+    static constexpr uint32_t NO_NODE = std::numeric_limits<uint32_t>::max();
+    static constexpr size_t WORD_BITS = 64;
+    static constexpr size_t LEVEL_WORDS = SLOTS / WORD_BITS;
+
+    struct Timer {
+        Id id;
+        double deadline;
+        uint64_t slot;
+    };
+
+    // timers of a bucket are a doubly linked list of nodes in nodes_, the first one has no prev
+    struct Node {
+        Timer timer;
+        uint32_t next;
+        uint32_t prev;
+        uint32_t bucket;
+    };
+
+    uint64_t ToSlot(double time) const {
+        const double slot = std::floor(time / resolution_);
+        if (!(slot < static_cast<double>(NEVER))) {
+            return NEVER;
+        }
+        return slot > 0. ? static_cast<uint64_t>(slot) : 0;
+    }
+
+    void Fire(uint32_t node, std::vector<Id>& expired) {
+        const Id id = nodes_[node].timer.id;
+        id_nodes_.find(id)->second = NO_NODE;
+        --size_;
+        FreeNode(node);
+        expired.push_back(id);
+    }
+
+    uint32_t AllocateNode() {
+        if (free_nodes_ == NO_NODE) {
+            nodes_.emplace_back();
+            return static_cast<uint32_t>(nodes_.size() - 1);
+        }
+        const uint32_t node = free_nodes_;
+        free_nodes_ = nodes_[node].next;
+        return node;
+    }
+
+    void FreeNode(uint32_t node) {
+        nodes_[node].next = free_nodes_;
+        free_nodes_ = node;
+    }
+
+    size_t FindBucket(uint64_t slot) const {
+        for (int level = 0; level < LEVELS; ++level) {
+            const int shift = SLOT_BITS * (level + 1);
+            // the timer belongs to the level where its slot shares the higher bits with the clock
+            if ((slot >> shift) == (current_slot_ >> shift)) {
+                return level * SLOTS + ((slot >> (SLOT_BITS * level)) & (SLOTS - 1));
+            }
+        }
+        return OVERFLOW_BUCKET;
+    }
+
+    void PushFront(size_t bucket, uint32_t node) {
+        Node& linked = nodes_[node];
+        linked.bucket = static_cast<uint32_t>(bucket);
+        linked.prev = NO_NODE;
+        linked.next = buckets_[bucket];
+        if (linked.next != NO_NODE) {
+            nodes_[linked.next].prev = node;
+        }
+        buckets_[bucket] = node;
+        if (bucket != OVERFLOW_BUCKET) {
+            occupied_[bucket / WORD_BITS] |= uint64_t{1} << (bucket % WORD_BITS);
+        }
+    }
+
+    // takes the list of the timers out of the bucket
+    uint32_t TakeBucket(size_t bucket) {
+        MarkEmpty(bucket);
+        return std::exchange(buckets_[bucket], NO_NODE);
+    }
+
+    void MarkEmpty(size_t bucket) {
+        if (bucket != OVERFLOW_BUCKET) {
+            occupied_[bucket / WORD_BITS] &= ~(uint64_t{1} << (bucket % WORD_BITS));
+        }
+    }
+
+    void Link(uint32_t node) {
+        PushFront(FindBucket(std::max(nodes_[node].timer.slot, current_slot_)), node);
+    }
+
+    void Unlink(uint32_t node) {
+        const Node& linked = nodes_[node];
+        if (linked.prev != NO_NODE) {
+            nodes_[linked.prev].next = linked.next;
+        } else {
+            buckets_[linked.bucket] = linked.next;
+            if (linked.next == NO_NODE) {
+                MarkEmpty(linked.bucket);
+            }
+        }
+        if (linked.next != NO_NODE) {
+            nodes_[linked.next].prev = linked.prev;
+        }
+    }
+
+    // index of the first non-empty bucket of the level after the given index, SLOTS if there is none
+    size_t FindOccupiedBucket(int level, size_t after) const {
+        size_t index = after + 1;
+        while (index < SLOTS) {
+            const uint64_t word = occupied_[level * LEVEL_WORDS + index / WORD_BITS] >> (index % WORD_BITS);
+            if (word != 0) {
+                return index + std::countr_zero(word);
+            }
+            index = (index / WORD_BITS + 1) * WORD_BITS;
+        }
+        return SLOTS;
+    }
+
+    // the first slot after the current one where timers fire or move down, NEVER if there is none
+    uint64_t FindNextEventSlot() const {
+        for (int level = 0; level < LEVELS; ++level) {
+            // the buckets of a level split the current bucket of the level above, so the next
+            // non-empty bucket of a lower level starts before the ones of the higher levels
+            const int shift = SLOT_BITS * level;
+            const size_t bucket = FindOccupiedBucket(level, (current_slot_ >> shift) & (SLOTS - 1));
+            if (bucket != SLOTS) {
+                const uint64_t block = (current_slot_ >> (shift + SLOT_BITS)) << (shift + SLOT_BITS);
+                return block + (uint64_t{bucket} << shift);
+            }
+        }
+        constexpr int OVERFLOW_SHIFT = SLOT_BITS * LEVELS;
+        if (buckets_[OVERFLOW_BUCKET] != NO_NODE && (current_slot_ >> OVERFLOW_SHIFT) < (NEVER >> OVERFLOW_SHIFT)) {
+            return ((current_slot_ >> OVERFLOW_SHIFT) + 1) << OVERFLOW_SHIFT;
+        }
+        return NEVER;
+    }
+
+    void FireSlot(double now, std::vector<Id>& expired) {
+        const size_t bucket = current_slot_ & (SLOTS - 1);
+        uint32_t node = TakeBucket(bucket);
+        while (node != NO_NODE) {
+            const uint32_t next = nodes_[node].next;
+            if (nodes_[node].timer.deadline <= now) {
+                Fire(node, expired);
+            } else {
+                // the deadline is later within the current slot
+                PushFront(bucket, node);
+            }
+            node = next;
+        }
+    }
+
+    // moves the timers of the higher level buckets reached by the clock down
+    void Cascade() {
+        int top_level = 0;
+        while (top_level + 1 < LEVELS && (current_slot_ & ((uint64_t{1} << (SLOT_BITS * (top_level + 1))) - 1)) == 0) {
+            ++top_level;
+        }
+        if (top_level == 0) {
+            return;
+        }
+        if (top_level == LEVELS - 1 && (current_slot_ & ((uint64_t{1} << (SLOT_BITS * LEVELS)) - 1)) == 0) {
+            Reinsert(OVERFLOW_BUCKET);
+        }
+        for (int level = top_level; level > 0; --level) {
+            Reinsert(level * SLOTS + ((current_slot_ >> (SLOT_BITS * level)) & (SLOTS - 1)));
+        }
+    }
+
+    void Reinsert(size_t bucket) {
+        uint32_t node = TakeBucket(bucket);
+        while (node != NO_NODE) {
+            const uint32_t next = nodes_[node].next;
+            Link(node);
+            node = next;
+        }
+    }
+
+    static std::array<uint32_t, OVERFLOW_BUCKET + 1> MakeEmptyBuckets() {
+        std::array<uint32_t, OVERFLOW_BUCKET + 1> buckets;
+        buckets.fill(NO_NODE);
+        return buckets;
+    }
+
+    double resolution_;
+    uint64_t current_slot_ = 0;
+    size_t size_ = 0;
+    // the first node of every bucket
+    std::array<uint32_t, OVERFLOW_BUCKET + 1> buckets_ = MakeEmptyBuckets();
+    // a bit per bucket of the levels, set if the bucket has timers
+    std::array<uint64_t, LEVELS * LEVEL_WORDS> occupied_{};
+    // nodes of all buckets and the list of the free ones linked by next
+    std::vector<Node> nodes_;
+    uint32_t free_nodes_ = NO_NODE;
+    // node of the timer of every known id, NO_NODE if it isn't scheduled
+    std::unordered_map<Id, uint32_t> id_nodes_;
+};
+
+}  // namespace util
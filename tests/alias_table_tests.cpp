@@ -0,0 +1,60 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <vector>
+
+#include "../src/alias_table.h"
+#include "../src/fast_random.h"
+
+using namespace util;
+
+TEST_CASE("Alias table picks indices in proportion to their weights") {
+    const std::vector<double> weights{1., 0., 3., 6., 0.};
+    AliasTable table{weights};
+    REQUIRE(table.Size() == weights.size());
+
+    FastRandom random{42};
+    constexpr int SAMPLES = 200000;
+    std::vector<int> hits(weights.size());
+    for (int i = 0; i < SAMPLES; ++i) {
+        ++hits[table.Sample(random.NextDouble())];
+    }
+    CHECK(hits[1] == 0);
+    CHECK(hits[4] == 0);
+    for (size_t i = 0; i < weights.size(); ++i) {
+        const double expected = SAMPLES * weights[i] / 10.;
+        CHECK(hits[i] >= expected * 0.97);
+        CHECK(hits[i] <= expected * 1.03);
+    }
+
+    // the ends of [0, 1) stay within the table
+    CHECK(table.Sample(0.) < weights.size());
+    CHECK(table.Sample(0.9999999999999999) < weights.size());
+}
+
+TEST_CASE("Alias table with zero weights picks indices equally") {
+    AliasTable table{std::vector<double>{0., 0., 0., 0.}};
+    CHECK(table.Sample(0.1) == 0);
+    CHECK(table.Sample(0.3) == 1);
+    CHECK(table.Sample(0.6) == 2);
+    CHECK(table.Sample(0.9) == 3);
+    CHECK(AliasTable{}.Empty());
+}
+
+TEST_CASE("Fast random gives the same sequence for the same seed") {
+    FastRandom first{7};
+    FastRandom second{7};
+    FastRandom other{8};
+    bool differs = false;
+    for (int i = 0; i < 100; ++i) {
+        const auto value = first();
+        CHECK(value == second());
+        differs = differs || value != other();
+        const double fraction = first.NextDouble();
+        CHECK(fraction >= 0.);
+        CHECK(fraction < 1.);
+        CHECK(second.NextDouble() == fraction);
+        CHECK(first.NextIndex(3) < 3);
+        second.NextIndex(3);
+    }
+    CHECK(differs);
+}
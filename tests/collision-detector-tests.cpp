@@ -1,6 +1,7 @@
 #define _USE_MATH_DEFINES
 
 #include <catch2/catch_all.hpp> 
+#include <random>
 #include <sstream>
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
@@ -42,6 +43,14 @@ public:
     void AddGatherer(Gatherer gatherer) {
         gatherers_.push_back(std::move(gatherer));
     };
+
+    const std::vector<Item>& GetItems() const {
+        return items_;
+    }
+
+    const std::vector<Gatherer>& GetGatherers() const {
+        return gatherers_;
+    }
 private:
     std::vector<Item> items_;
     std::vector<Gatherer> gatherers_;
@@ -103,6 +112,13 @@ private:
     Range range_;
 }; 
 
+// runs the search through the virtual interface and on the arrays, both have to give the same events
+std::vector<GatheringEvent> FindGatherEventsBothWays(const ItemGathererProviderTester& provider) {
+    std::vector<GatheringEvent> events = FindGatherEvents(provider);
+    CHECK(FindGatherEvents(provider.GetItems(), provider.GetGatherers()) == events);
+    return events;
+}
+
 TEST_CASE("Gatherer should collect an item that is on their way", "[collision_detector]") {
     //initialize provider 
     Point2D item0_pos = {2.0, 0.8};
@@ -115,7 +131,7 @@ TEST_CASE("Gatherer should collect an item that is on their way", "[collision_de
     provider.AddGatherer(gatherer1);
 
     //call FindGatherEvents to get events to test
-    std::vector<GatheringEvent> events = FindGatherEvents(provider);
+    std::vector<GatheringEvent> events = FindGatherEventsBothWays(provider);
     REQUIRE(events.size() == 1);
 
     //compute expected results
@@ -143,7 +159,7 @@ TEST_CASE("Gatherer should not collect an item that is not on their way", "[coll
     provider.AddGatherer(gatherer1);
 
     //call FindGatherEvents to get events to test
-    std::vector<GatheringEvent> events = FindGatherEvents(provider);
+    std::vector<GatheringEvent> events = FindGatherEventsBothWays(provider);
     REQUIRE(events.size() == 0);
 } 
 
@@ -175,7 +191,7 @@ TEST_CASE("Events should be sorted by time", "[collision_detector]") {
     provider.AddGatherer(gatherer2); //id = 2
 
     //call FindGatherEvents to get events to test
-    std::vector<GatheringEvent> events = FindGatherEvents(provider);
+    std::vector<GatheringEvent> events = FindGatherEventsBothWays(provider);
     REQUIRE(events.size() == 3);
 
     //compute expected results
@@ -193,4 +209,40 @@ TEST_CASE("Events should be sorted by time", "[collision_detector]") {
     for (size_t i = 1; i < events.size(); i++) {
         CHECK(events[i-1] <= events[i]);
     }
-} 
\ No newline at end of file
+} 
+TEST_CASE("Grid broadphase should give the same events as the exhaustive search", "[collision_detector]") {
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> coordinate(0., 50.);
+    std::uniform_real_distribution<double> step(-3., 3.);
+    std::uniform_int_distribution<int> road_line(0, 50);
+
+    ItemGathererProviderTester provider;
+    //items on integer lines like loot on roads and random ones
+    for (int i = 0; i < 400; i++) {
+        provider.AddItem(Item({static_cast<double>(road_line(generator)), coordinate(generator)}, 0.));
+        provider.AddItem(Item({coordinate(generator), coordinate(generator)}, i % 10 == 0 ? 0.25 : 0.));
+    }
+    for (int i = 0; i < 300; i++) {
+        Point2D start = {coordinate(generator), static_cast<double>(road_line(generator))};
+        if (i % 3 == 0) {
+            //horizontal move
+            provider.AddGatherer(Gatherer(start, {start.x + step(generator), start.y}, 0.3));
+        } else if (i % 3 == 1) {
+            //vertical move
+            provider.AddGatherer(Gatherer(start, {start.x, start.y + step(generator)}, 0.3));
+        } else {
+            //long diagonal move
+            provider.AddGatherer(Gatherer(start, {coordinate(generator), coordinate(generator)}, 0.6));
+        }
+    }
+
+    const auto& items = provider.GetItems();
+    const auto& gatherers = provider.GetGatherers();
+    std::vector<GatheringEvent> exhaustive_events = FindGatherEventsExhaustive(items, gatherers);
+    REQUIRE(!exhaustive_events.empty());
+    CHECK(FindGatherEventsWithGrid(items, gatherers) == exhaustive_events);
+    CHECK(FindGatherEventsWithGrid(items, gatherers, 0.3) == exhaustive_events);
+    CHECK(FindGatherEventsWithGrid(items, gatherers, 7.) == exhaustive_events);
+    CHECK(FindGatherEvents(items, gatherers) == exhaustive_events);
+    CHECK(FindGatherEvents(provider) == exhaustive_events);
+}
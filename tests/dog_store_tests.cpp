@@ -0,0 +1,242 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../src/dog_store.h"
+#include "../src/model.h"
+
+using namespace model;
+using namespace std::literals;
+
+namespace {
+
+std::shared_ptr<app::Player> MakePlayer(int id) {
+    return std::make_shared<app::Player>("dog"s + std::to_string(id), id, "token"s + std::to_string(id));
+}
+
+void SetSpeed(DogStore& dogs, DogStore::Index index, app::Speed speed) {
+    dogs.Settle(index);
+    dogs.speed_x[index] = speed.x;
+    dogs.speed_y[index] = speed.y;
+    dogs.UpdateActivity(index);
+}
+
+}  // namespace
+
+TEST_CASE("Removed dog is replaced by the last one which keeps its own row") {
+    DogStore dogs;
+    auto first = MakePlayer(1);
+    auto middle = MakePlayer(2);
+    auto last = MakePlayer(3);
+    dogs.Add(first, {1., 0.});
+    dogs.Add(middle, {2., 0.});
+    dogs.Add(last, {3., 0.});
+    SetSpeed(dogs, 1, {0., 2.});
+    SetSpeed(dogs, 2, {0.5, 0.});
+    last->CollectItem(Item{7, 0, 10});
+    dogs.time = 10.;
+
+    dogs.Remove(1);
+
+    REQUIRE(dogs.Size() == 2);
+    CHECK(dogs.FindById(2) == std::nullopt);
+    CHECK(dogs.FindByToken("token2"s) == std::nullopt);
+    CHECK(dogs.FindById(3) == DogStore::Index{1});
+    CHECK(dogs.FindByToken("token3"s) == DogStore::Index{1});
+    CHECK(dogs.GetIndexById(1) == 0);
+
+    // the moved dog reads its state from the new row
+    CHECK(last->GetCoordinates() == app::Coordinates{8., 0.});
+    CHECK(last->GetSpeed().x == 0.5);
+    CHECK(last->GetBagSize() == 1);
+    CHECK(last->GetTotalTime() == 10.);
+    CHECK(dogs.active == std::vector<DogStore::Index>{1});
+    CHECK(dogs.active_slot[1] == 0);
+
+    // and writes its state to it
+    last->SetPosition({4., 0.});
+    CHECK(dogs.x[1] == 4.);
+    last->StopPlayer();
+    CHECK(dogs.speed_x[1] == 0.);
+    CHECK_FALSE(dogs.IsActive(1));
+    CHECK(dogs.active.empty());
+    CHECK(first->GetCoordinates() == app::Coordinates{1., 0.});
+
+    // the removed dog is detached from the store and keeps its play time
+    CHECK(middle->GetCoordinates() == app::Coordinates{});
+    CHECK(middle->GetTotalTime() == 10.);
+    middle->SetPosition({9., 9.});
+    CHECK(dogs.x[0] == 1.);
+}
+
+TEST_CASE("Removing dogs in any order keeps the ids, tokens and active set consistent") {
+    DogStore dogs;
+    std::vector<std::shared_ptr<app::Player>> players;
+    for (int id = 0; id < 20; ++id) {
+        players.push_back(MakePlayer(id));
+        const DogStore::Index index = dogs.Add(players.back(), {static_cast<double>(id), 0.});
+        if (id % 3 != 0) {
+            SetSpeed(dogs, index, {1., 0.});
+        }
+    }
+
+    for (int id : {5, 19, 0, 12, 7, 1, 18, 2}) {
+        dogs.Remove(dogs.GetIndexById(id));
+        players[id] = nullptr;
+
+        for (const auto& player : players) {
+            if (!player) {
+                continue;
+            }
+            const auto index = dogs.FindByToken(player->GetToken());
+            REQUIRE(index.has_value());
+            CHECK(dogs.FindById(player->GetId()) == index);
+            CHECK(dogs.players[*index] == player);
+            CHECK(player->GetCoordinates().x == player->GetId());
+            CHECK(dogs.IsActive(*index) == (player->GetId() % 3 != 0));
+        }
+        for (size_t slot = 0; slot < dogs.active.size(); ++slot) {
+            CHECK(dogs.active_slot[dogs.active[slot]] == slot);
+        }
+        const size_t active_count = std::count_if(dogs.active_slot.begin(), dogs.active_slot.end(), [](size_t slot) {
+            return slot != DogStore::NOT_ACTIVE;
+        });
+        CHECK(active_count == dogs.active.size());
+    }
+    CHECK(dogs.Size() == 12);
+}
+
+namespace {
+
+// idle and play time of a dog the way they were charged on every tick before the lazy charging
+struct TickedTimes {
+    double idle = 0.;
+    double play = 0.;
+    bool moving = false;
+};
+
+}  // namespace
+
+TEST_CASE("Lazily charged idle and play time equal the ones charged on every tick") {
+    DogStore dogs;
+    std::vector<std::shared_ptr<app::Player>> players;
+    std::vector<TickedTimes> times;
+    auto add = [&](int id) {
+        players.push_back(MakePlayer(id));
+        times.emplace_back();
+        dogs.Add(players.back(), {});
+    };
+    for (int id = 0; id < 10; ++id) {
+        add(id);
+    }
+
+    unsigned state = 3;
+    auto next = [&state](unsigned modulo) {
+        state = state * 1103515245u + 12345u;
+        return (state >> 16) % modulo;
+    };
+    int next_id = 10;
+    for (int step = 0; step < 2000; ++step) {
+        const size_t i = next(static_cast<unsigned>(players.size()));
+        switch (next(6)) {
+            case 0: {
+                // a move request resets the idle time like Player::Move
+                dogs.Settle(i);
+                dogs.idle_time[i] = 0.;
+                times[i].idle = 0.;
+                SetSpeed(dogs, i, {next(2) == 0 ? 1. : -1., 0.});
+                times[i].moving = true;
+                break;
+            }
+            case 1:
+                players[i]->StopPlayer();
+                times[i].moving = false;
+                break;
+            case 2:
+                if (players.size() > 1) {
+                    dogs.Remove(i);
+                    players[i] = std::move(players.back());
+                    players.pop_back();
+                    times[i] = times.back();
+                    times.pop_back();
+                } else {
+                    add(next_id++);
+                }
+                break;
+            case 3:
+                add(next_id++);
+                break;
+            default: {
+                // a tick
+                const double delta = 1. + next(100);
+                dogs.time += delta;
+                for (TickedTimes& ticked : times) {
+                    ticked.play += delta;
+                    if (!ticked.moving) {
+                        ticked.idle += delta;
+                    }
+                }
+            }
+        }
+
+        REQUIRE(dogs.Size() == players.size());
+        for (size_t index = 0; index < players.size(); ++index) {
+            REQUIRE(dogs.players[index] == players[index]);
+            CHECK(std::abs(players[index]->GetIdleTime() - times[index].idle) < 1e-6);
+            CHECK(std::abs(players[index]->GetTotalTime() - times[index].play) < 1e-6);
+            CHECK(dogs.IsActive(index) == times[index].moving);
+        }
+        for (size_t slot = 0; slot < dogs.active.size(); ++slot) {
+            REQUIRE(dogs.active_slot[dogs.active[slot]] == slot);
+        }
+        CHECK(dogs.active.size() == static_cast<size_t>(std::count_if(times.begin(), times.end(), [](const TickedTimes& ticked) {
+            return ticked.moving;
+        })));
+    }
+}
+
+TEST_CASE("Dog stopped by the road end in a tick is idle for the rest of the tick") {
+    Map map{Map::Id{"map"s}, "map"s};
+    map.AddRoad(Road{Road::HORIZONTAL, Point{0, 0}, 10});
+    map.SetDefaultSpeed(0.01);
+    map.SetDefaultBagCapacity(3);
+    map.SetIdleTimeLimit(1e9);
+    Game game;
+    game.AddMap(map);
+    game.SetLootGenerator({1000ms, 0.});
+    game.SetPlayersStartPointRandomizing(false);
+    auto player = game.JoinGame("dog"s, game.FindMap(Map::Id{"map"s}));
+    auto session = player->GetSession();
+    REQUIRE(player->GetCoordinates() == app::Coordinates{0., 0.});
+
+    // stopped dog gets idle time on every tick
+    for (int tick = 0; tick < 3; ++tick) {
+        session->UpdateTime(100.);
+    }
+    CHECK(player->GetIdleTime() == 300.);
+    CHECK(player->GetTotalTime() == 300.);
+
+    player->Move("R"s);
+    CHECK(player->GetIdleTime() == 0.);
+    session->UpdateTime(100.);
+    CHECK(player->GetIdleTime() == 0.);
+
+    player->Move(""s);
+    session->UpdateTime(50.);
+    session->UpdateTime(70.);
+    CHECK(player->GetIdleTime() == 120.);
+    CHECK(player->GetTotalTime() == 520.);
+
+    // from x = 1 the dog runs 9.4 to the road end in 940 ms of the 2000 ms tick
+    player->Move("R"s);
+    session->UpdateTime(2000.);
+    CHECK(player->GetCoordinates().x == 10.4);
+    CHECK(std::abs(player->GetIdleTime() - 1060.) < 1e-6);
+    CHECK(std::abs(player->GetTotalTime() - 2520.) < 1e-6);
+    session->UpdateTime(100.);
+    CHECK(std::abs(player->GetIdleTime() - 1160.) < 1e-6);
+}
@@ -0,0 +1,449 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cmath>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../src/alloc_counter.h"
+#include "../src/model.h"
+#include "../src/thread_pool.h"
+
+using namespace model;
+using namespace std::literals;
+
+namespace {
+
+struct SteadyTicks {
+    size_t allocations = 0;
+    size_t spawned_loot = 0;
+    int delivered_score = 0;
+};
+
+int GetSessionScore(const GameSession& session) {
+    int score = 0;
+    for (const auto& player : session.GetPlayers()) {
+        score += player->GetScore();
+    }
+    return score;
+}
+
+// the random stream of a session is keyed on its id, so the ids are fixed
+// to play the same games whatever sessions the other tests have made
+constexpr int STEADY_SESSION_ID = 1;
+
+int GetLastLootId(const GameSession& session) {
+    return session.GetLostObjects().empty() ? -1 : session.GetLostObjects().rbegin()->first;
+}
+
+// counts heap allocations of the steady ticks of a session where dogs run along a long street,
+// gather the loot spawned on it and bring it to the offices
+SteadyTicks CountSteadyTickAllocations(bool kinetic) {
+    Map map{Map::Id{"map"s}, "map"s};
+    map.AddRoad(Road{Road::HORIZONTAL, Point{0, 0}, 1000});
+    for (int x = 0; x <= 1000; x += 100) {
+        map.AddRoad(Road{Road::VERTICAL, Point{x, -1}, 1});
+    }
+    for (int x = 25; x < 1000; x += 50) {
+        map.AddOffice(Office{Office::Id{"office"s + std::to_string(x)}, Point{x, 0}, Offset{0, 0}});
+    }
+    map.SetLootNumber(1);
+    map.SetLootValues({1});
+    map.SetDefaultSpeed(0.001);
+    map.SetDefaultBagCapacity(3);
+    map.SetIdleTimeLimit(1e9);
+
+    Game game;
+    game.AddMap(map);
+    // every gathered item is replaced at the next tick
+    game.SetLootGenerator({1000ms, 1.});
+    game.SetPlayersStartPointRandomizing(true);
+    game.SetRandomSeed(13);
+    game.SetKineticMode(kinetic);
+
+    std::vector<std::shared_ptr<app::Player>> players;
+    for (int i = 0; i < 30; ++i) {
+        players.push_back(game.JoinGame("dog"s + std::to_string(i), game.FindMap(Map::Id{"map"s}), STEADY_SESSION_ID));
+        if (i % 3 != 0) {
+            players.back()->Move(i % 3 == 1 ? "R"s : "L"s);
+        }
+    }
+    std::shared_ptr<GameSession> session = players.front()->GetSession();
+
+    // the other dogs stop and start again and again, so their retirement timers
+    // and kinetic events are cancelled and scheduled
+    constexpr double TICK = 100.;
+    auto play = [&](int from_tick, int ticks_count) {
+        for (int tick = from_tick; tick < from_tick + ticks_count; ++tick) {
+            if (tick % 10 == 0) {
+                for (size_t i = 0; i < players.size(); i += 3) {
+                    players[i]->Move(tick % 20 == 0 ? (i % 2 == 0 ? "R"s : "L"s) : ""s);
+                }
+            }
+            session->UpdateTime(TICK);
+        }
+    };
+    play(0, 1000);
+    const int last_loot_id = GetLastLootId(*session);
+    const int score = GetSessionScore(*session);
+
+    util::StartCountingAllocations();
+    play(1000, 200);
+    const size_t allocations = util::StopCountingAllocations();
+
+    SteadyTicks result;
+    result.allocations = allocations;
+    result.spawned_loot = static_cast<size_t>(GetLastLootId(*session) - last_loot_id);
+    result.delivered_score = GetSessionScore(*session) - score;
+    return result;
+}
+
+}  // namespace
+
+TEST_CASE("Steady tick of a session makes no heap allocations") {
+    const SteadyTicks ticks = CountSteadyTickAllocations(false);
+    // loot is spawned, gathered and delivered during the counted ticks
+    REQUIRE(ticks.spawned_loot > 0);
+    REQUIRE(ticks.delivered_score > 0);
+    CHECK(ticks.allocations == 0);
+}
+
+TEST_CASE("Steady tick of a session in the kinetic mode makes no heap allocations") {
+    const SteadyTicks ticks = CountSteadyTickAllocations(true);
+    REQUIRE(ticks.spawned_loot > 0);
+    REQUIRE(ticks.delivered_score > 0);
+    CHECK(ticks.allocations == 0);
+}
+
+namespace {
+
+struct DogState {
+    app::Coordinates position;
+    app::Speed speed;
+    int score;
+    size_t bag_size;
+
+    bool operator==(const DogState& other) const {
+        return position.x == other.position.x && position.y == other.position.y && speed.x == other.speed.x &&
+               speed.y == other.speed.y && score == other.score && bag_size == other.bag_size;
+    }
+};
+
+struct CrowdedSessionResult {
+    std::vector<DogState> dogs;
+    size_t loot_left = 0;
+    size_t parallel_ticks = 0;
+};
+
+// plays the same crowded game on one session and returns the state of its dogs and the loot left
+CrowdedSessionResult PlayCrowdedSession(util::WorkStealingPool* pool) {
+    Map map{Map::Id{"map"s}, "map"s};
+    for (int i = 0; i <= 40; i += 4) {
+        map.AddRoad(Road{Road::HORIZONTAL, Point{0, i}, 40});
+        map.AddRoad(Road{Road::VERTICAL, Point{i, 0}, 40});
+    }
+    map.AddOffice(Office{Office::Id{"office"s}, Point{20, 20}, Offset{0, 0}});
+    map.SetLootNumber(1);
+    map.SetLootValues({1});
+    map.SetDefaultSpeed(0.003);
+    map.SetDefaultBagCapacity(3);
+    map.SetIdleTimeLimit(1e9);
+
+    Game game;
+    game.AddMap(map);
+    game.SetLootGenerator({1000ms, 0.});
+    game.SetPlayersStartPointRandomizing(false);
+
+    std::vector<std::shared_ptr<app::Player>> players;
+    for (int i = 0; i < 700; ++i) {
+        players.push_back(game.JoinGame("dog"s + std::to_string(i), game.FindMap(Map::Id{"map"s})));
+    }
+    std::shared_ptr<GameSession> session = players.front()->GetSession();
+    // small chunks, so that the moving dogs are split between the threads in most ticks
+    session->SetParallelTickChunk(32);
+
+    // many items on the roads, so that dogs compete for them
+    std::map<int, LostObject> loot;
+    for (int id = 0; id < 2000; ++id) {
+        const double line = 4. * (id % 11);
+        const double along = (id * 7919 % 4000) / 100.;
+        loot[id] = LostObject{Item{id, 0, 1}, id % 2 == 0 ? app::Coordinates{along, line} : app::Coordinates{line, along}};
+    }
+    session->RestoreLostObjects(loot);
+
+    const char* directions[] = {"U", "D", "L", "R", ""};
+    unsigned state = 17;
+    for (int tick = 0; tick < 300; ++tick) {
+        for (auto& player : players) {
+            state = state * 1103515245u + 12345u;
+            if ((state >> 16) % 10 == 0) {
+                player->Move(directions[(state >> 8) % 5]);
+            }
+        }
+        session->UpdateTime(tick % 2 == 0 ? 50. : 17., pool);
+    }
+
+    std::vector<DogState> dogs;
+    for (const auto& player : session->GetPlayers()) {
+        dogs.push_back({player->GetCoordinates(), player->GetSpeed(), player->GetScore(), player->GetBag().size()});
+    }
+    return {dogs, session->GetLostObjects().size(), session->GetParallelTicksCount()};
+}
+
+}  // namespace
+
+TEST_CASE("Session ticked on several threads gives the same result as the serial tick") {
+    const auto serial = PlayCrowdedSession(nullptr);
+    util::WorkStealingPool pool{4};
+    const auto parallel = PlayCrowdedSession(&pool);
+    // the game has to be eventful and the dogs have to be split between the threads
+    // for the check to mean something
+    REQUIRE(serial.loot_left < 2000);
+    REQUIRE(serial.parallel_ticks == 0);
+    REQUIRE(parallel.parallel_ticks > 0);
+    CHECK(parallel.loot_left == serial.loot_left);
+    CHECK(parallel.dogs == serial.dogs);
+}
+
+namespace {
+
+struct SeededRun {
+    std::vector<std::string> tokens;
+    std::vector<std::pair<double, double>> loot;
+    std::vector<int> loot_types;
+};
+
+SeededRun PlaySeededGame(uint64_t seed, int session_id) {
+    Map map{Map::Id{"map"s}, "map"s};
+    map.AddRoad(Road{Road::HORIZONTAL, Point{0, 0}, 30});
+    map.AddRoad(Road{Road::VERTICAL, Point{30, 0}, 10});
+    map.SetLootNumber(4);
+    map.SetLootValues({1, 2, 3, 4});
+    map.SetDefaultSpeed(0.001);
+    map.SetDefaultBagCapacity(3);
+    map.SetIdleTimeLimit(1e9);
+
+    Game game;
+    game.AddMap(map);
+    game.SetLootGenerator({1000ms, 1.});
+    game.SetPlayersStartPointRandomizing(true);
+    game.SetRandomSeed(seed);
+
+    SeededRun run;
+    std::shared_ptr<GameSession> session;
+    for (int i = 0; i < 10; ++i) {
+        auto player = game.JoinGame("dog"s + std::to_string(i), game.FindMap(Map::Id{"map"s}), session_id);
+        run.tokens.push_back(player->GetToken());
+        session = player->GetSession();
+    }
+    session->UpdateTime(2000.);
+    for (const auto& [id, object] : session->GetLostObjects()) {
+        run.loot.emplace_back(object.coordinates.x, object.coordinates.y);
+        run.loot_types.push_back(object.item.type);
+    }
+    return run;
+}
+
+}  // namespace
+
+TEST_CASE("Game with a random seed spawns the same loot and gives the same tokens") {
+    // the loot of a session is drawn from the stream keyed on the seed and the session id
+    const SeededRun first = PlaySeededGame(2024, 1);
+    const SeededRun second = PlaySeededGame(2024, 1);
+    REQUIRE(first.loot.size() == 10);
+    CHECK(first.tokens == second.tokens);
+    CHECK(first.loot == second.loot);
+    CHECK(first.loot_types == second.loot_types);
+
+    const SeededRun other = PlaySeededGame(2025, 1);
+    CHECK(other.tokens != first.tokens);
+    CHECK(other.loot != first.loot);
+
+    const SeededRun other_session = PlaySeededGame(2024, 2);
+    CHECK(other_session.tokens == first.tokens);
+    CHECK(other_session.loot != first.loot);
+}
+
+namespace {
+
+struct KineticRun {
+    std::vector<DogState> dogs;
+    std::vector<std::vector<int>> bags;
+    std::vector<int> loot_ids;
+    int score = 0;
+};
+
+// plays the same game with dogs starting at random points and loot spawned at random points,
+// so that no two dogs reach an item at the same instant and no item lies exactly at their reach
+KineticRun PlayRandomGame(bool kinetic) {
+    Map map{Map::Id{"map"s}, "map"s};
+    for (int i = 0; i <= 60; i += 10) {
+        map.AddRoad(Road{Road::HORIZONTAL, Point{0, i}, 60});
+        map.AddRoad(Road{Road::VERTICAL, Point{i, 0}, 60});
+    }
+    for (int i = 10; i < 60; i += 20) {
+        map.AddOffice(Office{Office::Id{"south"s + std::to_string(i)}, Point{i, 20}, Offset{0, 0}});
+        map.AddOffice(Office{Office::Id{"north"s + std::to_string(i)}, Point{i, 40}, Offset{0, 0}});
+    }
+    map.SetLootNumber(2);
+    map.SetLootValues({1, 5});
+    map.SetDefaultSpeed(0.0037);
+    map.SetDefaultBagCapacity(2);
+    map.SetIdleTimeLimit(1e9);
+
+    Game game;
+    game.AddMap(map);
+    game.SetLootGenerator({1000ms, 1.});
+    game.SetPlayersStartPointRandomizing(true);
+    game.SetRandomSeed(7);
+    game.SetKineticMode(kinetic);
+
+    std::vector<std::shared_ptr<app::Player>> players;
+    for (int i = 0; i < 60; ++i) {
+        players.push_back(game.JoinGame("dog"s + std::to_string(i), game.FindMap(Map::Id{"map"s}), STEADY_SESSION_ID));
+    }
+    std::shared_ptr<GameSession> session = players.front()->GetSession();
+    // items are spread over the map at once, the rest is spawned as the dogs gather it
+    session->UpdateTime(100000.);
+
+    const char* directions[] = {"U", "D", "L", "R", ""};
+    unsigned state = 5;
+    for (int tick = 0; tick < 1000; ++tick) {
+        for (auto& player : players) {
+            state = state * 1103515245u + 12345u;
+            if ((state >> 16) % 20 == 0) {
+                player->Move(directions[(state >> 8) % 5]);
+            }
+        }
+        session->UpdateTime(tick % 3 == 0 ? 100. : 37.);
+    }
+
+    KineticRun run;
+    for (const auto& player : session->GetPlayers()) {
+        run.dogs.push_back({player->GetCoordinates(), player->GetSpeed(), player->GetScore(), player->GetBagSize()});
+        std::vector<int>& bag = run.bags.emplace_back();
+        for (const Item& item : player->GetBag()) {
+            bag.push_back(item.id);
+        }
+    }
+    for (const auto& [id, object] : session->GetLostObjects()) {
+        run.loot_ids.push_back(id);
+    }
+    run.score = GetSessionScore(*session);
+    return run;
+}
+
+}  // namespace
+
+TEST_CASE("Session in the kinetic mode plays the same game as in the tick mode") {
+    const KineticRun ticked = PlayRandomGame(false);
+    const KineticRun kinetic = PlayRandomGame(true);
+    // the dogs have to gather and deliver loot for the check to mean something
+    REQUIRE(ticked.loot_ids.back() > 80);
+    REQUIRE(ticked.score > 20);
+    CHECK(kinetic.loot_ids == ticked.loot_ids);
+    CHECK(kinetic.bags == ticked.bags);
+    CHECK(kinetic.score == ticked.score);
+    // a kinetic dog is moved by its whole way at once, not tick by tick, so only the rounding differs
+    REQUIRE(kinetic.dogs.size() == ticked.dogs.size());
+    for (size_t i = 0; i < ticked.dogs.size(); ++i) {
+        CHECK(std::abs(kinetic.dogs[i].position.x - ticked.dogs[i].position.x) < 1e-9);
+        CHECK(std::abs(kinetic.dogs[i].position.y - ticked.dogs[i].position.y) < 1e-9);
+        CHECK(kinetic.dogs[i].speed.x == ticked.dogs[i].speed.x);
+        CHECK(kinetic.dogs[i].speed.y == ticked.dogs[i].speed.y);
+        CHECK(kinetic.dogs[i].score == ticked.dogs[i].score);
+    }
+}
+
+namespace {
+
+struct ShardedGameResult {
+    std::map<int, std::vector<DogState>> sessions;
+    std::map<int, size_t> loot_left;
+    // name and score of every player who has left, in the order of leaving
+    std::vector<std::pair<std::string, int>> retired;
+    size_t players_left = 0;
+    size_t parallel_ticks = 0;
+};
+
+// plays the same game on many small sessions and a large one
+ShardedGameResult PlayManySessions(unsigned tick_threads) {
+    Map map{Map::Id{"map"s}, "map"s};
+    for (int i = 0; i <= 40; i += 8) {
+        map.AddRoad(Road{Road::HORIZONTAL, Point{0, i}, 40});
+        map.AddRoad(Road{Road::VERTICAL, Point{i, 0}, 40});
+    }
+    map.AddOffice(Office{Office::Id{"office"s}, Point{16, 16}, Offset{0, 0}});
+    map.SetLootNumber(3);
+    map.SetLootValues({1, 2, 3});
+    map.SetDefaultSpeed(0.0043);
+    map.SetDefaultBagCapacity(3);
+    // stopped dogs retire during the game
+    map.SetIdleTimeLimit(3000.);
+
+    Game game;
+    game.AddMap(map);
+    game.SetLootGenerator({1000ms, 0.5});
+    game.SetPlayersStartPointRandomizing(true);
+    game.SetRandomSeed(31);
+    if (tick_threads > 1) {
+        game.SetTickThreads(tick_threads);
+        game.SetParallelSessionSize(100);
+    }
+    ShardedGameResult result;
+    game.SetOnLeaveHandler([&result](std::string name, int, int score) {
+        result.retired.emplace_back(std::move(name), score);
+    });
+
+    constexpr int LARGE_SESSION_ID = 9;
+    std::vector<std::shared_ptr<app::Player>> players;
+    for (int session_id = 1; session_id <= LARGE_SESSION_ID; ++session_id) {
+        const int players_count = session_id == LARGE_SESSION_ID ? 600 : 20;
+        for (int i = 0; i < players_count; ++i) {
+            players.push_back(game.JoinGame("dog"s + std::to_string(players.size()), game.FindMap(Map::Id{"map"s}), session_id));
+        }
+    }
+    std::shared_ptr<GameSession> large_session = players.back()->GetSession();
+    large_session->SetParallelTickChunk(32);
+
+    const char* directions[] = {"U", "D", "L", "R", ""};
+    unsigned state = 23;
+    for (int tick = 0; tick < 200; ++tick) {
+        for (auto& player : players) {
+            state = state * 1103515245u + 12345u;
+            if ((state >> 16) % 10 == 0) {
+                player->Move(directions[(state >> 8) % 5]);
+            }
+        }
+        game.UpdateTime(tick % 2 == 0 ? 100. : 23.);
+    }
+
+    for (const auto& [id, session] : game.GetSessions()) {
+        std::vector<DogState>& dogs = result.sessions[id];
+        for (const auto& player : session->GetPlayers()) {
+            dogs.push_back({player->GetCoordinates(), player->GetSpeed(), player->GetScore(), player->GetBagSize()});
+        }
+        result.loot_left[id] = session->GetLostObjects().size();
+    }
+    result.players_left = game.GetPlayers().size();
+    result.parallel_ticks = large_session->GetParallelTicksCount();
+    return result;
+}
+
+}  // namespace
+
+TEST_CASE("Sessions ticked on the pool give the same result as the serial tick") {
+    const auto serial = PlayManySessions(1);
+    const auto parallel = PlayManySessions(4);
+    // dogs have to retire and the large session has to be split between the threads
+    // for the check to mean something
+    REQUIRE(serial.sessions.size() == 9);
+    REQUIRE(serial.retired.size() > 100);
+    REQUIRE(serial.players_left > 0);
+    REQUIRE(parallel.parallel_ticks > 0);
+    CHECK(parallel.sessions == serial.sessions);
+    CHECK(parallel.loot_left == serial.loot_left);
+    CHECK(parallel.retired == serial.retired);
+    CHECK(parallel.players_left == serial.players_left);
+}
@@ -0,0 +1,130 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../src/input_log.h"
+
+using namespace model;
+using namespace replay;
+using namespace std::literals;
+
+namespace {
+
+Game MakeGame() {
+    Map map{Map::Id{"map"s}, "map"s};
+    for (int i = 0; i <= 20; i += 5) {
+        map.AddRoad(Road{Road::HORIZONTAL, Point{0, i}, 20});
+        map.AddRoad(Road{Road::VERTICAL, Point{i, 0}, 20});
+    }
+    map.AddOffice(Office{Office::Id{"office"s}, Point{10, 10}, Offset{0, 0}});
+    map.SetLootNumber(3);
+    map.SetLootValues({1, 5, 10});
+    map.SetDefaultSpeed(0.004);
+    map.SetDefaultBagCapacity(2);
+    map.SetIdleTimeLimit(5000.);
+
+    Game game;
+    game.AddMap(map);
+    game.SetLootGenerator({500ms, 0.7});
+    game.SetPlayersStartPointRandomizing(true);
+    return game;
+}
+
+// positions, scores and loot of the game as text, so that two games can be compared at once;
+// ids of players differ between games of one process and are left out
+std::string DescribeGame(Game& game) {
+    std::ostringstream out;
+    out << std::setprecision(17);
+    for (const auto& [id, player] : game.GetPlayers()) {
+        out << player->GetCoordinates().x << ' ' << player->GetCoordinates().y << ' '
+            << player->GetScore() << ' ' << player->GetBag().size() << '\n';
+    }
+    for (const auto& [session_id, loot] : game.RetrieveLootForBackup()) {
+        for (const auto& [id, object] : loot) {
+            out << id << ' ' << object.item.type << ' ' << object.coordinates.x << ' ' << object.coordinates.y << '\n';
+        }
+    }
+    return out.str();
+}
+
+}  // namespace
+
+TEST_CASE("Replay of an input log brings a game to the same state as the recorded one") {
+    std::stringstream log;
+    Game recorded = MakeGame();
+    {
+        InputRecorder recorder{log};
+        recorder.RecordSeed(77);
+        recorded.SetRandomSeed(77);
+        recorder.RecordSpawnSettings(true);
+
+        std::vector<std::shared_ptr<app::Player>> players;
+        const char* directions[] = {"U", "D", "L", "R", ""};
+        unsigned state = 5;
+        for (int tick = 0; tick < 400; ++tick) {
+            if (tick % 40 == 0) {
+                players.push_back(recorded.JoinGame("dog"s + std::to_string(tick), recorded.FindMap(Map::Id{"map"s})));
+                recorder.RecordJoin(players.back()->GetId(), players.back()->GetSession()->GetId(), "map"s,
+                                    "dog"s + std::to_string(tick));
+            }
+            for (auto& player : players) {
+                state = state * 1103515245u + 12345u;
+                if ((state >> 16) % 8 == 0) {
+                    const std::string direction = directions[(state >> 8) % 5];
+                    player->Move(direction);
+                    recorder.RecordMove(player->GetId(), direction);
+                }
+            }
+            const double time_delta = tick % 2 == 0 ? 50. : 17.;
+            recorder.RecordTick(time_delta);
+            recorded.UpdateTime(time_delta);
+        }
+    }
+
+    Game replayed = MakeGame();
+    replayed.SetPlayersStartPointRandomizing(false);
+    InputReader reader{log};
+    InputReplayer replayer{replayed};
+    const ReplayStats stats = replayer.Replay(reader);
+    CHECK(stats.joins == 10);
+    CHECK(stats.ticks == 400);
+    CHECK(stats.game_time == 200 * 67.);
+    CHECK(stats.moves > 0);
+
+    CHECK(DescribeGame(replayed) == DescribeGame(recorded));
+    // the random streams of the sessions are keyed on their ids
+    std::vector<int> recorded_sessions, replayed_sessions;
+    for (const auto& [id, session] : recorded.GetSessions()) {
+        recorded_sessions.push_back(id);
+    }
+    for (const auto& [id, session] : replayed.GetSessions()) {
+        replayed_sessions.push_back(id);
+    }
+    CHECK(replayed_sessions == recorded_sessions);
+}
+
+TEST_CASE("Input reader rejects broken logs") {
+    std::stringstream not_a_log{"hello"s};
+    CHECK_THROWS_AS(InputReader{not_a_log}, InputLogError);
+
+    std::stringstream log;
+    {
+        InputRecorder recorder{log};
+        recorder.RecordJoin(1, 2, "map"s, "dog"s);
+        recorder.RecordTick(10.);
+    }
+    std::string data = log.str();
+    std::stringstream cut{data.substr(0, data.size() - 3)};
+    InputReader reader{cut};
+    auto join = reader.Next();
+    REQUIRE(join);
+    CHECK(join->kind == InputKind::JOIN);
+    CHECK(join->player_id == 1);
+    CHECK(join->session_id == 2);
+    CHECK(join->map_id == "map"s);
+    CHECK(join->name == "dog"s);
+    CHECK_THROWS_AS(reader.Next(), InputLogError);
+}
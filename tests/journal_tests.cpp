@@ -0,0 +1,149 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "../src/journal.h"
+#include "../src/model_serialization.h"
+#include "../src/snapshot.h"
+
+using namespace model;
+using namespace std::literals;
+
+namespace {
+
+constexpr double TICK = 100.;
+
+Game MakeGame(bool kinetic) {
+    Map map{Map::Id{"map"s}, "map"s};
+    for (int i = 0; i <= 40; i += 10) {
+        map.AddRoad(Road{Road::HORIZONTAL, Point{0, i}, 40});
+        map.AddRoad(Road{Road::VERTICAL, Point{i, 0}, 40});
+    }
+    map.AddOffice(Office{Office::Id{"office"s}, Point{20, 20}, Offset{0, 0}});
+    map.SetLootNumber(3);
+    map.SetLootValues({1, 5, 10});
+    map.SetDefaultSpeed(0.003);
+    map.SetDefaultBagCapacity(2);
+    map.SetIdleTimeLimit(4000.);
+
+    Game game;
+    game.AddMap(map);
+    game.SetLootGenerator({500ms, 0.7});
+    game.SetPlayersStartPointRandomizing(true);
+    game.SetSessionSharding({5});
+    game.SetKineticMode(kinetic);
+    return game;
+}
+
+void RemoveStateFiles(const std::string& path) {
+    serialization::RemoveJournalSegmentsBefore(path, std::numeric_limits<uint64_t>::max());
+    std::filesystem::remove(path);
+}
+
+// players join, turn and stop now and then, the ones standing too long retire
+void Play(Game& game, serialization::Journal& journal, int ticks, int& step) {
+    const std::vector<std::string> moves = {"U"s, "R"s, "D"s, "L"s, ""s};
+    for (int i = 0; i < ticks; ++i, ++step) {
+        if (step % 7 == 0) {
+            game.JoinGame("dog"s + std::to_string(step), game.FindMap(Map::Id{"map"s}));
+        }
+        for (const auto& [id, player] : game.GetPlayers()) {
+            if ((id + step) % 11 == 0) {
+                player->Move(moves[(id + step) % moves.size()]);
+            }
+        }
+        game.UpdateTime(TICK);
+        journal.RecordTick(game, TICK);
+    }
+}
+
+void CheckSameState(Game& restored, Game& expected) {
+    auto restored_players = restored.GetPlayers();
+    auto expected_players = expected.GetPlayers();
+    REQUIRE(restored_players.size() == expected_players.size());
+    for (const auto& [id, player] : expected_players) {
+        REQUIRE(restored_players.contains(id));
+        const auto& other = restored_players.at(id);
+        CHECK(other->GetToken() == player->GetToken());
+        CHECK(other->GetSession()->GetId() == player->GetSession()->GetId());
+        CHECK(other->GetScore() == player->GetScore());
+        CHECK(other->GetBag().size() == player->GetBag().size());
+        CHECK(other->GetSpeed().x == player->GetSpeed().x);
+        CHECK(other->GetSpeed().y == player->GetSpeed().y);
+        CHECK(other->GetDirection() == player->GetDirection());
+        // dogs going straight are moved in one step on restore, so the sums may differ in the last digits
+        CHECK(std::abs(other->GetCoordinates().x - player->GetCoordinates().x) < 1e-6);
+        CHECK(std::abs(other->GetCoordinates().y - player->GetCoordinates().y) < 1e-6);
+        CHECK(std::abs(other->GetIdleTime() - player->GetIdleTime()) < 1e-6);
+        CHECK(std::abs(other->GetTotalTime() - player->GetTotalTime()) < 1e-6);
+    }
+    auto restored_loot = restored.RetrieveLootForBackup();
+    for (const auto& [session_id, loot] : expected.RetrieveLootForBackup()) {
+        if (expected.GetSessions().at(session_id)->GetPlayersCount() == 0) {
+            continue;
+        }
+        REQUIRE(restored_loot.contains(session_id));
+        REQUIRE(restored_loot.at(session_id).size() == loot.size());
+        for (const auto& [item_id, object] : loot) {
+            REQUIRE(restored_loot.at(session_id).contains(item_id));
+            CHECK(restored_loot.at(session_id).at(item_id).coordinates == object.coordinates);
+        }
+    }
+}
+
+}  // namespace
+
+TEST_CASE("State is restored from the snapshot and the journal after it") {
+    for (bool kinetic : {false, true}) {
+        const std::string path = (std::filesystem::temp_directory_path() / "game_journal_test"s).string();
+        RemoveStateFiles(path);
+
+        Game game = MakeGame(kinetic);
+        game.SetChangeTracking(true);
+        serialization::Journal journal{path};
+        int step = 0;
+        const uint64_t first_generation = journal.StartSegment();
+        Play(game, journal, 30, step);
+
+        // the snapshot starts the next segment, the journal goes on in it
+        const uint64_t generation = journal.StartSegment();
+        CHECK(generation > first_generation);
+        serialization::WriteSnapshotFile(path, serialization::EncodeSnapshot(game, generation));
+        serialization::RemoveJournalSegmentsBefore(path, generation);
+        CHECK(serialization::FindJournalSegments(path) == std::vector<uint64_t>{generation});
+        Play(game, journal, 120, step);
+
+        Game restored = MakeGame(kinetic);
+        serialization::RestoreGameState(path, restored);
+        CheckSameState(restored, game);
+
+        // an entry cut short by a crash is left out
+        {
+            std::ofstream segment{serialization::GetJournalSegmentPath(path, generation), std::ios::binary | std::ios::app};
+            segment.write("\x01\xff\x00\x00\x00\x00", 6);
+        }
+        Game after_crash = MakeGame(kinetic);
+        serialization::RestoreGameState(path, after_crash);
+        CheckSameState(after_crash, game);
+
+        RemoveStateFiles(path);
+    }
+}
+
+TEST_CASE("Journal replay keeps the state of a snapshot without the journal") {
+    Game game = MakeGame(false);
+    for (int i = 0; i < 3; ++i) {
+        game.JoinGame("dog"s, game.FindMap(Map::Id{"map"s}))->Move("R"s);
+    }
+    game.UpdateTime(TICK);
+    serialization::GameState state = serialization::DecodeSnapshot(serialization::EncodeSnapshot(game));
+    CHECK(state.journal_generation == 0);
+    const serialization::JournalReplayStats stats = serialization::ReplayJournal("/nonexistent/state"s, state);
+    CHECK(stats.segments == 0);
+    CHECK(state.sessions.begin()->second.players.size() == 3);
+}
@@ -52,7 +52,7 @@ SCENARIO("Loot generation", "[loot]") {
         WHEN("time is less than base interval") {
             THEN("number of generated loot is decreased") {
                 const auto time_interval
-                    = std::chrono::duration_cast<TimeInterval>(std::chrono::duration<double>{
+                    = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::duration<double>{
                         1.0 / (std::log(1 - 0.5) / std::log(1.0 - 0.25))});
                 CHECK(gen.Generate(time_interval, 0, 4) == 1);
             }
@@ -66,11 +66,33 @@ SCENARIO("Loot generation", "[loot]") {
         WHEN("loot is generated") {
             THEN("number of loot is proportional to random generated values") {
                 const auto time_interval
-                    = std::chrono::duration_cast<TimeInterval>(std::chrono::duration<double>{
+                    = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::duration<double>{
                         1.0 / (std::log(1 - 0.5) / std::log(1.0 - 0.25))});
                 CHECK(gen.Generate(time_interval, 0, 4) == 0);
                 CHECK(gen.Generate(time_interval, 0, 4) == 1);
             }
         }
     }
+
+    GIVEN("a loot generator ticked in fixed steps") {
+        // one loot a second for a looter, loot appears as soon as a second has passed
+        auto steps_to_loot = [](double step) {
+            LootGenerator gen{1s, 0.5};
+            int steps = 1;
+            while (gen.Generate(TimeInterval{step}, 0, 1) == 0) {
+                ++steps;
+            }
+            return steps;
+        };
+        WHEN("steps are fractions of a millisecond") {
+            THEN("the fractions add up to the same time") {
+                // steps rounded to whole milliseconds would be 59 steps of 17 ms
+                CHECK(steps_to_loot(16.6) == 61);
+                // and steps shorter than half a millisecond would never bring loot
+                const int steps = steps_to_loot(0.4);
+                CHECK(steps >= 2500);
+                CHECK(steps <= 2501);
+            }
+        }
+    }
 }
@@ -0,0 +1,128 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "../src/loot_index.h"
+#include "../src/model.h"
+
+using namespace model;
+
+namespace {
+
+std::vector<int> FindIds(const LootIndex& index, double min_x, double max_x, double min_y, double max_y) {
+    std::vector<LootIndex::Entry> entries;
+    index.FindInRect(min_x, max_x, min_y, max_y, entries);
+    std::vector<int> ids;
+    for (const auto& entry : entries) {
+        ids.push_back(entry.id);
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+}  // namespace
+
+TEST_CASE("Loot index finds objects on vertical and horizontal lines") {
+    LootIndex index;
+    // on the vertical line x = 2
+    index.Add(1, {2., 0.5});
+    index.Add(2, {2., 3.25});
+    // on the horizontal line y = 1
+    index.Add(3, {0.75, 1.});
+    index.Add(4, {5.5, 1.});
+    // at a crossing of the lines, found once
+    index.Add(5, {4., 1.});
+
+    CHECK(FindIds(index, 0., 10., 0., 10.) == std::vector<int>{1, 2, 3, 4, 5});
+    // a thin rectangle along the vertical line
+    CHECK(FindIds(index, 1.8, 2.2, 0., 3.) == std::vector<int>{1});
+    // a thin rectangle along the horizontal line
+    CHECK(FindIds(index, 0., 5., 0.8, 1.2) == std::vector<int>{3, 5});
+    // the bounds are inclusive
+    CHECK(FindIds(index, 2., 2., 3.25, 3.25) == std::vector<int>{2});
+    CHECK(FindIds(index, 4., 5.5, 1., 1.) == std::vector<int>{4, 5});
+    CHECK(FindIds(index, 2.1, 3.9, 0., 10.).empty());
+
+    std::vector<LootIndex::Entry> entries;
+    index.FindInRect(1.9, 2.1, 3., 4., entries);
+    REQUIRE(entries.size() == 1);
+    CHECK(entries.front().id == 2);
+    CHECK(entries.front().coordinates == app::Coordinates{2., 3.25});
+}
+
+TEST_CASE("Loot index finds objects which are on no line") {
+    LootIndex index;
+    index.Add(1, {0.5, 0.5});
+    index.Add(2, {3.3, 7.7});
+    index.Add(3, {3., 7.7});
+
+    CHECK(FindIds(index, 0., 1., 0., 1.) == std::vector<int>{1});
+    CHECK(FindIds(index, 3., 4., 7., 8.) == std::vector<int>{2, 3});
+    CHECK(FindIds(index, 0.6, 3.2, 0., 10.) == std::vector<int>{3});
+
+    index.Remove(1, {0.5, 0.5});
+    CHECK(FindIds(index, 0., 10., 0., 10.) == std::vector<int>{2, 3});
+    index.Clear();
+    CHECK(FindIds(index, 0., 10., 0., 10.).empty());
+}
+
+TEST_CASE("Loot index forgets removed objects") {
+    LootIndex index;
+    index.Add(1, {2., 0.5});
+    index.Add(2, {2., 0.5});
+    index.Add(3, {0.5, 4.});
+    index.Remove(1, {2., 0.5});
+    index.Remove(3, {0.5, 4.});
+    // unknown objects are ignored
+    index.Remove(7, {2., 0.5});
+    index.Remove(8, {9., 9.5});
+    CHECK(FindIds(index, 0., 10., 0., 10.) == std::vector<int>{2});
+
+    // a line emptied by removals takes new objects
+    index.Remove(2, {2., 0.5});
+    CHECK(FindIds(index, 0., 10., 0., 10.).empty());
+    index.Add(4, {2., 6.});
+    CHECK(FindIds(index, 1., 3., 0., 10.) == std::vector<int>{4});
+}
+
+TEST_CASE("Loot index finds the same objects as a plain search") {
+    LootIndex index;
+    std::map<int, app::Coordinates> objects;
+    std::mt19937 generator{5};
+    std::uniform_int_distribution<int> line_distribution{0, 20};
+    std::uniform_real_distribution<double> position_distribution{0., 20.};
+    std::uniform_int_distribution<int> kind_distribution{0, 9};
+
+    for (int step = 0; step < 3000; ++step) {
+        if (!objects.empty() && kind_distribution(generator) < 4) {
+            auto it = std::next(objects.begin(), generator() % objects.size());
+            index.Remove(it->first, it->second);
+            objects.erase(it);
+        } else {
+            app::Coordinates coordinates{position_distribution(generator), position_distribution(generator)};
+            const int kind = kind_distribution(generator);
+            if (kind < 4) {
+                coordinates.x = line_distribution(generator);
+            } else if (kind < 8) {
+                coordinates.y = line_distribution(generator);
+            }
+            index.Add(step, coordinates);
+            objects[step] = coordinates;
+        }
+
+        const double min_x = position_distribution(generator) - 1.;
+        const double min_y = position_distribution(generator) - 1.;
+        const double max_x = min_x + position_distribution(generator) / 4.;
+        const double max_y = min_y + position_distribution(generator) / 4.;
+        std::vector<int> expected;
+        for (const auto& [id, coordinates] : objects) {
+            if (coordinates.x >= min_x && coordinates.x <= max_x && coordinates.y >= min_y && coordinates.y <= max_y) {
+                expected.push_back(id);
+            }
+        }
+        REQUIRE(FindIds(index, min_x, max_x, min_y, max_y) == expected);
+    }
+}
@@ -0,0 +1,45 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/json_loader.h"
+#include "../src/map_generator.h"
+
+using namespace map_gen;
+using namespace std::literals;
+
+TEST_CASE("Generated maps are loaded by json_loader with all their roads and offices") {
+    for (Layout layout : {Layout::GRID, Layout::STREETS, Layout::CITY}) {
+        MapOptions options;
+        options.layout = layout;
+        options.offices_count = 30;
+        options.loot_types_count = 6;
+        const GeneratedMap generated = GenerateMap(options);
+        CHECK(generated.roads.size() >= 100);
+        CHECK(generated.offices.size() == 30);
+
+        model::Game game = json_loader::LoadGameFromJson(MakeConfigJson({options}));
+        const model::Map* map = game.FindMap(model::Map::Id{options.id});
+        REQUIRE(map);
+        CHECK(map->GetRoads().size() == generated.roads.size());
+        CHECK(map->GetBuildings().size() == generated.buildings.size());
+        CHECK(map->GetOffices().size() == generated.offices.size());
+        CHECK(game.GetLootInfo(options.id).properties.as_array().size() == 6);
+        for (const model::Office& office : map->GetOffices()) {
+            const model::PositionOnRoads position = map->GetRoadsByCoordinates(
+                {static_cast<double>(office.GetPosition().x), static_cast<double>(office.GetPosition().y)});
+            CHECK((position.horizontal != model::NO_ROAD || position.vertical != model::NO_ROAD));
+        }
+    }
+}
+
+TEST_CASE("Map generator gives the same map for the same seed") {
+    MapOptions options;
+    options.layout = Layout::STREETS;
+    options.streets_count = 3000;
+    const std::string first = boost::json::serialize(MakeConfigJson({options}));
+    CHECK(boost::json::serialize(MakeConfigJson({options})) == first);
+    CHECK(GenerateMap(options).roads.size() == 3000);
+
+    options.seed = 2;
+    CHECK(boost::json::serialize(MakeConfigJson({options})) != first);
+    CHECK_THROWS_AS(ParseLayout("maze"sv), std::invalid_argument);
+}
@@ -0,0 +1,175 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <boost/asio/io_context.hpp>
+#include <boost/log/core.hpp>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "../src/request_handler.h"
+
+using namespace std::literals;
+namespace net = boost::asio;
+namespace http = boost::beast::http;
+
+namespace {
+
+model::Game MakeGame() {
+    model::Map map{model::Map::Id{"map"s}, "map"s};
+    map.AddRoad(model::Road{model::Road::HORIZONTAL, model::Point{0, 0}, 40});
+    map.AddRoad(model::Road{model::Road::VERTICAL, model::Point{0, 0}, 40});
+    map.SetLootNumber(1);
+    map.SetLootValues({1});
+    map.SetDefaultSpeed(0.001);
+    map.SetDefaultBagCapacity(3);
+    map.SetIdleTimeLimit(1e9);
+
+    model::Game game;
+    game.AddMap(map);
+    game.SetLootGenerator({1000ms, 0.});
+    game.SetPlayersStartPointRandomizing(false);
+    game.SetSessionSharding({2});
+    return game;
+}
+
+http_handler::StringRequest MakeRequest(http::verb method, std::string target, std::string token = {}, std::string body = {}) {
+    http_handler::StringRequest req{method, target, 11};
+    if (!token.empty()) {
+        req.set(http::field::authorization, "Bearer "s + token);
+    }
+    if (!body.empty()) {
+        req.set(http::field::content_type, "application/json"s);
+        req.body() = std::move(body);
+        req.prepare_payload();
+    }
+    return req;
+}
+
+struct Client {
+    std::string token;
+    int session_id = 0;
+};
+
+// Responses of the requests of every session: the handlers of a session must not overlap
+// and must run in the order the requests came in.
+struct SessionLog {
+    std::mutex mutex;
+    std::map<int, int> running;
+    std::map<int, std::vector<int>> finished;
+    std::atomic<size_t> overlaps{0};
+    std::atomic<size_t> failures{0};
+};
+
+}  // namespace
+
+TEST_CASE("Requests of a session are handled one at a time in order while other sessions, ticks and joins go on") {
+    boost::log::core::get()->set_logging_enabled(false);
+
+    model::Game game = MakeGame();
+    auto application = std::make_shared<app::Application>(game, std::nullopt, nullptr);
+    auto api_handler = std::make_shared<http_handler::APIHandler>(application, true);
+
+    net::io_context ioc;
+    auto handler = std::make_shared<http_handler::RequestHandler>(api_handler, "."s, net::make_strand(ioc));
+
+    // two full sessions of two players
+    std::vector<Client> clients;
+    for (int i = 0; i < 4; ++i) {
+        std::string body;
+        (*handler)(MakeRequest(http::verb::post, "/api/v1/game/join"s, {},
+                               R"({"userName": "dog)"s + std::to_string(i) + R"(", "mapId": "map"})"s),
+                   [&body](auto& response) {
+                       if constexpr (std::is_same_v<std::decay_t<decltype(response)>, http_handler::StringResponse>) {
+                           body = response.body();
+                       }
+                   });
+        ioc.run();
+        ioc.restart();
+        const std::string token = boost::json::parse(body).as_object().at("authToken").as_string().c_str();
+        clients.push_back({token, application->GetPlayerByToken(token)->GetSession()->GetId()});
+    }
+    REQUIRE(clients[0].session_id == clients[1].session_id);
+    REQUIRE(clients[2].session_id == clients[3].session_id);
+    REQUIRE(clients[0].session_id != clients[2].session_id);
+
+    SessionLog log;
+    auto send_to = [&log](int session_id, int request) {
+        return [&log, session_id, request](auto& response) {
+            if (response.result() != http::status::ok) {
+                ++log.failures;
+            }
+            {
+                std::lock_guard lock{log.mutex};
+                if (log.running[session_id]++ != 0) {
+                    ++log.overlaps;
+                }
+            }
+            // leaves room for another handler of the session to run into this one
+            std::this_thread::sleep_for(50us);
+            std::lock_guard lock{log.mutex};
+            --log.running[session_id];
+            log.finished[session_id].push_back(request);
+        };
+    };
+
+    auto work = net::make_work_guard(ioc);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&ioc] {
+            ioc.run();
+        });
+    }
+
+    const std::vector<std::string> moves = {"R"s, "D"s, ""s, "L"s, "U"s};
+    constexpr int REQUESTS = 200;
+    for (int request = 0; request < REQUESTS; ++request) {
+        for (size_t i = 0; i < clients.size(); ++i) {
+            const Client& client = clients[i];
+            if ((request + i) % 3 == 0) {
+                (*handler)(MakeRequest(http::verb::get, "/api/v1/game/state"s, client.token), send_to(client.session_id, request));
+            } else {
+                (*handler)(MakeRequest(http::verb::post, "/api/v1/game/player/action"s, client.token,
+                                       R"({"move": ")"s + moves[(request + i) % moves.size()] + R"("})"s),
+                           send_to(client.session_id, request));
+            }
+        }
+        if (request % 10 == 0) {
+            (*handler)(MakeRequest(http::verb::post, "/api/v1/game/tick"s, {}, R"({"timeDelta": 10})"s), [](auto&) {});
+        }
+        if (request % 50 == 0) {
+            (*handler)(MakeRequest(http::verb::post, "/api/v1/game/join"s, {}, R"({"userName": "newcomer", "mapId": "map"})"s),
+                       [](auto&) {});
+        }
+    }
+    work.reset();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    CHECK(log.overlaps == 0);
+    CHECK(log.failures == 0);
+    for (const Client& client : {clients[0], clients[2]}) {
+        const std::vector<int>& finished = log.finished[client.session_id];
+        // every request of the session's two players
+        REQUIRE(finished.size() == 2 * REQUESTS);
+        CHECK(std::is_sorted(finished.begin(), finished.end()));
+    }
+    // every player has the direction of its last move, a stop turns the dog to the north
+    for (size_t i = 0; i < clients.size(); ++i) {
+        int last_move = REQUESTS - 1;
+        while ((last_move + i) % 3 == 0) {
+            --last_move;
+        }
+        const std::string& move = moves[(last_move + i) % moves.size()];
+        const auto player = application->GetPlayerByToken(clients[i].token);
+        CHECK(app::dir_to_letter.at(player->GetDirection()) == (move.empty() ? "U"s : move));
+    }
+    CHECK(game.GetPlayers().size() == clients.size() + REQUESTS / 50);
+
+    boost::log::core::get()->set_logging_enabled(true);
+}
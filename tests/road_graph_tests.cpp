@@ -0,0 +1,108 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "../src/model.h"
+
+using namespace model;
+using namespace std::literals;
+
+namespace {
+
+// lookup over all roads the way the map did it before the road graph
+PositionOnRoads FindByScan(const Map::Roads& roads, app::Coordinates coordinates) {
+    PositionOnRoads result;
+    const int x = std::round(coordinates.x);
+    const int y = std::round(coordinates.y);
+    for (size_t i = 0; i < roads.size(); ++i) {
+        const Road& road = roads[i];
+        if (road.IsVertical() && road.GetStart().x == x && !isFractionInRange(coordinates.x) && result.vertical == NO_ROAD &&
+            y >= std::min(road.GetStart().y, road.GetEnd().y) && y <= std::max(road.GetStart().y, road.GetEnd().y)) {
+            result.vertical = i;
+        }
+        if (road.IsHorizontal() && road.GetStart().y == y && !isFractionInRange(coordinates.y) && result.horizontal == NO_ROAD &&
+            x >= std::min(road.GetStart().x, road.GetEnd().x) && x <= std::max(road.GetStart().x, road.GetEnd().x)) {
+            result.horizontal = i;
+        }
+    }
+    return result;
+}
+
+}  // namespace
+
+TEST_CASE("Road graph finds the same roads as the scan over all roads") {
+    Map map{Map::Id{"map"s}, "map"s};
+    std::mt19937 generator{7};
+    std::uniform_int_distribution<int> coord{0, 30};
+    for (int i = 0; i < 60; ++i) {
+        Point start{coord(generator), coord(generator)};
+        // overlapping collinear roads and roads given from the end to the start are included
+        if (i % 2 == 0) {
+            map.AddRoad(Road{Road::HORIZONTAL, start, coord(generator)});
+        } else {
+            map.AddRoad(Road{Road::VERTICAL, start, coord(generator)});
+        }
+    }
+    map.BuildRoadJunctions();
+
+    std::uniform_real_distribution<double> position{-1., 32.};
+    for (int i = 0; i < 20000; ++i) {
+        app::Coordinates coordinates{position(generator), position(generator)};
+        if (i % 3 == 0) {
+            coordinates.x = std::round(coordinates.x);
+        }
+        PositionOnRoads expected = FindByScan(map.GetRoads(), coordinates);
+        PositionOnRoads found = map.GetRoadsByCoordinates(coordinates);
+        INFO("x = " << coordinates.x << ", y = " << coordinates.y);
+        CHECK(found.vertical == expected.vertical);
+        CHECK(found.horizontal == expected.horizontal);
+    }
+}
+
+TEST_CASE("Road graph lists junctions of every segment in order") {
+    Map map{Map::Id{"map"s}, "map"s};
+    map.AddRoad(Road{Road::HORIZONTAL, Point{0, 0}, 10});
+    map.AddRoad(Road{Road::VERTICAL, Point{4, -5}, 5});
+    map.AddRoad(Road{Road::VERTICAL, Point{10, 0}, 8});
+    map.BuildRoadJunctions();
+
+    const RoadGraph& graph = map.GetRoadGraph();
+    REQUIRE(graph.GetSegments().size() == 3);
+
+    auto get_points = [&graph](size_t segment) {
+        std::vector<std::pair<int, int>> points;
+        for (size_t junction : graph.GetSegmentJunctions(segment)) {
+            points.emplace_back(graph.GetJunctions()[junction].x, graph.GetJunctions()[junction].y);
+        }
+        return points;
+    };
+    CHECK(get_points(0) == std::vector<std::pair<int, int>>{{0, 0}, {4, 0}, {10, 0}});
+    CHECK(get_points(1) == std::vector<std::pair<int, int>>{{4, -5}, {4, 0}, {4, 5}});
+    CHECK(get_points(2) == std::vector<std::pair<int, int>>{{10, 0}, {10, 8}});
+    CHECK(graph.GetJunctions().size() == 6);
+}
+
+TEST_CASE("Road graph gives the nearest cell border next to a junction") {
+    Map map{Map::Id{"map"s}, "map"s};
+    map.AddRoad(Road{Road::HORIZONTAL, Point{0, 0}, 10});
+    map.AddRoad(Road{Road::VERTICAL, Point{4, -5}, 5});
+    map.BuildRoadJunctions();
+
+    const RoadGraph& graph = map.GetRoadGraph();
+    constexpr double INF = std::numeric_limits<double>::infinity();
+    CHECK(graph.FindNextJunctionBorder(0, -0.4, true) == 0.5);
+    CHECK(graph.FindNextJunctionBorder(0, 0.5, true) == 3.5);
+    CHECK(graph.FindNextJunctionBorder(0, 3.7, true) == 4.5);
+    CHECK(graph.FindNextJunctionBorder(0, 9.5, true) == 10.5);
+    CHECK(graph.FindNextJunctionBorder(0, 10.4, true) == 10.5);
+    CHECK(graph.FindNextJunctionBorder(0, 10.5, true) == INF);
+    CHECK(graph.FindNextJunctionBorder(0, 10.4, false) == 9.5);
+    CHECK(graph.FindNextJunctionBorder(0, 4.5, false) == 3.5);
+    CHECK(graph.FindNextJunctionBorder(0, 3.5, false) == 0.5);
+    CHECK(graph.FindNextJunctionBorder(0, -0.5, false) == -INF);
+    CHECK(graph.FindNextJunctionBorder(1, -5.4, true) == -4.5);
+    CHECK(graph.FindNextJunctionBorder(1, -4.5, true) == -0.5);
+}
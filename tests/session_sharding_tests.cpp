@@ -0,0 +1,144 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../src/json_loader.h"
+#include "../src/model.h"
+
+using namespace model;
+using namespace std::literals;
+
+namespace {
+
+constexpr double IDLE_TIME_LIMIT = 1000.;
+
+Game MakeGame(SessionShardingConfig sharding) {
+    Map map{Map::Id{"map"s}, "map"s};
+    map.AddRoad(Road{Road::HORIZONTAL, Point{0, 0}, 1000});
+    map.SetLootNumber(1);
+    map.SetLootValues({1});
+    map.SetDefaultSpeed(0.001);
+    map.SetDefaultBagCapacity(3);
+    map.SetIdleTimeLimit(IDLE_TIME_LIMIT);
+
+    Game game;
+    game.AddMap(map);
+    game.SetLootGenerator({1000ms, 0.});
+    game.SetPlayersStartPointRandomizing(false);
+    game.SetSessionSharding(sharding);
+    return game;
+}
+
+int JoinSession(Game& game) {
+    return game.JoinGame("dog"s, game.FindMap(Map::Id{"map"s}))->GetSession()->GetId();
+}
+
+size_t CountPlayers(const Game& game, int session_id) {
+    return game.GetSessions().at(session_id)->GetPlayersCount();
+}
+
+// the first players of the session keep going, the others stop and retire at the next RetireStoppedPlayers
+void KeepPlayers(const Game& game, int session_id, size_t count) {
+    const auto players = game.GetSessions().at(session_id)->GetPlayers();
+    for (size_t i = 0; i < players.size(); ++i) {
+        players[i]->Move(i < count ? "R"s : ""s);
+    }
+}
+
+void RetireStoppedPlayers(Game& game) {
+    game.UpdateTime(IDLE_TIME_LIMIT + 1.);
+}
+
+boost::json::value MakeConfig(const std::string& session_config) {
+    return boost::json::parse(R"({
+        "lootGeneratorConfig": {"period": 5.0, "probability": 0.5},
+        "sessionConfig": )"s + session_config + R"(,
+        "maps": [{
+            "id": "map", "name": "map",
+            "lootTypes": [{"name": "key", "value": 10}],
+            "roads": [{"x0": 0, "y0": 0, "x1": 40}]
+        }]
+    })"s);
+}
+
+}  // namespace
+
+TEST_CASE("Players of a map are split between sessions of at most max players") {
+    Game game = MakeGame({3});
+    std::vector<int> sessions;
+    for (int i = 0; i < 7; ++i) {
+        sessions.push_back(JoinSession(game));
+    }
+    CHECK(sessions == std::vector<int>{sessions[0], sessions[0], sessions[0],
+                                       sessions[3], sessions[3], sessions[3], sessions[6]});
+    CHECK(sessions[0] != sessions[3]);
+    CHECK(sessions[3] != sessions[6]);
+    CHECK(game.GetSessions().size() == 3);
+}
+
+TEST_CASE("Fill first places players in the oldest session with room, least loaded in the emptiest one") {
+    for (SessionPlacement placement : {SessionPlacement::FILL_FIRST, SessionPlacement::LEAST_LOADED}) {
+        Game game = MakeGame({4, 0, placement});
+        const int first = JoinSession(game);
+        for (int i = 0; i < 3; ++i) {
+            JoinSession(game);
+        }
+        const int second = JoinSession(game);
+        REQUIRE(first != second);
+
+        // the first session has 2 players and room for more, the second one has 1
+        KeepPlayers(game, first, 2);
+        KeepPlayers(game, second, 1);
+        RetireStoppedPlayers(game);
+        REQUIRE(CountPlayers(game, first) == 2);
+        REQUIRE(CountPlayers(game, second) == 1);
+
+        CHECK(JoinSession(game) == (placement == SessionPlacement::FILL_FIRST ? first : second));
+    }
+}
+
+TEST_CASE("Full session takes players again only when refill margin places are free") {
+    Game game = MakeGame({4, 2});
+    const int first = JoinSession(game);
+    for (int i = 0; i < 3; ++i) {
+        JoinSession(game);
+    }
+    const int second = JoinSession(game);
+    REQUIRE(first != second);
+
+    // one place is free, less than the margin
+    KeepPlayers(game, first, 3);
+    KeepPlayers(game, second, 1);
+    RetireStoppedPlayers(game);
+    REQUIRE(CountPlayers(game, first) == 3);
+    CHECK(JoinSession(game) == second);
+    CHECK(CountPlayers(game, first) == 3);
+
+    // two places are free, the session is refilled up to the limit
+    KeepPlayers(game, first, 2);
+    KeepPlayers(game, second, 2);
+    RetireStoppedPlayers(game);
+    REQUIRE(CountPlayers(game, first) == 2);
+    CHECK(JoinSession(game) == first);
+    CHECK(JoinSession(game) == first);
+    CHECK(CountPlayers(game, first) == 4);
+    CHECK(JoinSession(game) == second);
+}
+
+TEST_CASE("Session config is read from the game config") {
+    Game game = json_loader::LoadGameFromJson(MakeConfig(R"({"maxPlayers": 2, "refillMargin": 1, "placement": "leastLoaded"})"s));
+    const Map* map = game.FindMap(Map::Id{"map"s});
+    const int first = game.JoinGame("dog1"s, map)->GetSession()->GetId();
+    CHECK(game.JoinGame("dog2"s, map)->GetSession()->GetId() == first);
+    CHECK(game.JoinGame("dog3"s, map)->GetSession()->GetId() != first);
+
+    CHECK_THROWS_AS(json_loader::LoadGameFromJson(MakeConfig(R"({"maxPlayers": 0})"s)), json_loader::InvalidConfigureFile);
+    CHECK_THROWS_AS(json_loader::LoadGameFromJson(MakeConfig(R"({"maxPlayers": -3})"s)), json_loader::InvalidConfigureFile);
+    CHECK_THROWS_AS(json_loader::LoadGameFromJson(MakeConfig(R"({"maxPlayers": 4, "refillMargin": -1})"s)),
+                    json_loader::InvalidConfigureFile);
+    CHECK_THROWS_AS(json_loader::LoadGameFromJson(MakeConfig(R"({"maxPlayers": 4, "refillMargin": 4})"s)),
+                    json_loader::InvalidConfigureFile);
+    CHECK_THROWS_AS(json_loader::LoadGameFromJson(MakeConfig(R"({"placement": "random"})"s)), json_loader::InvalidConfigureFile);
+}
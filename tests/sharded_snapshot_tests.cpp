@@ -0,0 +1,149 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cmath>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "../src/model_serialization.h"
+#include "../src/sharded_snapshot.h"
+
+using namespace model;
+using namespace std::literals;
+
+namespace {
+
+Game MakeGame() {
+    Map map{Map::Id{"map"s}, "map"s};
+    for (int i = 0; i <= 20; i += 5) {
+        map.AddRoad(Road{Road::HORIZONTAL, Point{0, i}, 20});
+        map.AddRoad(Road{Road::VERTICAL, Point{i, 0}, 20});
+    }
+    map.SetLootNumber(3);
+    map.SetLootValues({1, 5, 10});
+    map.SetDefaultSpeed(0.001);
+    map.SetDefaultBagCapacity(3);
+    map.SetIdleTimeLimit(1e9);
+
+    Game game;
+    game.AddMap(map);
+    // no loot appears, so only the players change the sessions
+    game.SetLootGenerator({500ms, 0.});
+    // the dogs start at the crossing at the map corner, where they can go right or down
+    game.SetPlayersStartPointRandomizing(false);
+    game.SetSessionSharding({3});
+    return game;
+}
+
+void RemoveStateFiles(const std::string& path) {
+    const std::filesystem::path state{path};
+    for (const auto& file : std::filesystem::directory_iterator{state.parent_path()}) {
+        if (file.path().filename().string().starts_with(state.filename().string())) {
+            std::filesystem::remove(file.path());
+        }
+    }
+}
+
+size_t CountWrittenSessions(const serialization::ShardedSnapshot& snapshot) {
+    size_t count = 0;
+    for (const auto& session : snapshot.sessions) {
+        count += session.data.empty() ? 0 : 1;
+    }
+    return count;
+}
+
+void CheckSameState(Game& restored, Game& expected) {
+    auto restored_players = restored.GetPlayers();
+    REQUIRE(restored_players.size() == expected.GetPlayers().size());
+    for (const auto& [id, player] : expected.GetPlayers()) {
+        REQUIRE(restored_players.contains(id));
+        const auto& other = restored_players.at(id);
+        CHECK(other->GetSession()->GetId() == player->GetSession()->GetId());
+        CHECK(other->GetSpeed().x == player->GetSpeed().x);
+        CHECK(other->GetSpeed().y == player->GetSpeed().y);
+        // the dogs of the sessions kept from an earlier save are moved in one step
+        CHECK(std::abs(other->GetCoordinates().x - player->GetCoordinates().x) < 1e-6);
+        CHECK(std::abs(other->GetCoordinates().y - player->GetCoordinates().y) < 1e-6);
+        CHECK(std::abs(other->GetIdleTime() - player->GetIdleTime()) < 1e-6);
+        CHECK(std::abs(other->GetTotalTime() - player->GetTotalTime()) < 1e-6);
+    }
+}
+
+}  // namespace
+
+TEST_CASE("Sessions not changed since the previous save keep their files") {
+    const std::string path = (std::filesystem::temp_directory_path() / "game_sharded_test"s).string();
+    RemoveStateFiles(path);
+
+    Game game = MakeGame();
+    std::vector<std::shared_ptr<app::Player>> players;
+    for (int i = 0; i < 9; ++i) {
+        players.push_back(game.JoinGame("dog"s + std::to_string(i), game.FindMap(Map::Id{"map"s})));
+    }
+    players[4]->Move("R"s);
+    REQUIRE(game.GetSessions().size() == 3);
+
+    serialization::ShardedSnapshotWriter writer{path, 2};
+    const serialization::ShardedSnapshot first = writer.Capture(game);
+    CHECK(CountWrittenSessions(first) == 3);
+    writer.Write(first);
+    CHECK(serialization::IsManifestFile(path));
+
+    // the dog going right and the ones standing still don't change their sessions
+    game.UpdateTime(700.);
+    const int changed_session = players[0]->GetSession()->GetId();
+    players[0]->Move("D"s);
+    game.UpdateTime(300.);
+
+    const serialization::ShardedSnapshot second = writer.Capture(game);
+    CHECK(CountWrittenSessions(second) == 1);
+    writer.Write(second);
+    CHECK(writer.GetStats().sessions_written == 4);
+    CHECK(writer.GetStats().sessions_kept == 2);
+    for (const auto& [id, session] : game.GetSessions()) {
+        const bool replaced = id == changed_session;
+        CHECK(std::filesystem::exists(serialization::GetSessionFilePath(path, id, first.save)) != replaced);
+        CHECK(std::filesystem::exists(serialization::GetSessionFilePath(path, id, second.save)) == replaced);
+    }
+
+    Game restored = MakeGame();
+    serialization::RestoreGameState(path, restored);
+    CheckSameState(restored, game);
+
+    // the saves go on after the one found on disk, the files of the restored state aren't overwritten
+    serialization::ShardedSnapshotWriter next_writer{path, 1};
+    CHECK(next_writer.Capture(restored).save == second.save + 1);
+
+    RemoveStateFiles(path);
+}
+
+TEST_CASE("Snapshot captured after one that wasn't written writes all changes since the written one") {
+    const std::string path = (std::filesystem::temp_directory_path() / "game_sharded_lost_test"s).string();
+    RemoveStateFiles(path);
+
+    Game game = MakeGame();
+    std::vector<std::shared_ptr<app::Player>> players;
+    for (int i = 0; i < 6; ++i) {
+        players.push_back(game.JoinGame("dog"s + std::to_string(i), game.FindMap(Map::Id{"map"s})));
+    }
+    serialization::ShardedSnapshotWriter writer{path, 2};
+    writer.Write(writer.Capture(game));
+
+    players[0]->Move("R"s);
+    game.UpdateTime(200.);
+    // replaced by a newer snapshot before it was written
+    const serialization::ShardedSnapshot lost = writer.Capture(game);
+    CHECK(CountWrittenSessions(lost) == 1);
+
+    players[5]->Move("L"s);
+    game.UpdateTime(200.);
+    const serialization::ShardedSnapshot written = writer.Capture(game);
+    CHECK(CountWrittenSessions(written) == 2);
+    writer.Write(written);
+
+    Game restored = MakeGame();
+    serialization::RestoreGameState(path, restored);
+    CheckSameState(restored, game);
+
+    RemoveStateFiles(path);
+}
@@ -0,0 +1,132 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "../src/collision_detector.h"
+#include "../src/simd_kernels.h"
+
+using namespace simd;
+
+namespace {
+
+constexpr double EPSILON = 1e-6;
+
+// bitwise comparison, so that -0.0 and 0.0 or different NaNs are told apart
+bool SameBits(const std::vector<double>& lhs, const std::vector<double>& rhs) {
+    return lhs.size() == rhs.size() && std::memcmp(lhs.data(), rhs.data(), lhs.size() * sizeof(double)) == 0;
+}
+
+struct MoveArrays {
+    explicit MoveArrays(size_t count)
+        : x(count), y(count), speed_x(count), speed_y(count)
+        , min_x(count), max_x(count), min_y(count), max_y(count)
+        , end_x(count), end_y(count), duration(count), road_end_met(count) {
+    }
+
+    MoveBatch GetBatch() {
+        MoveBatch batch;
+        batch.count = x.size();
+        batch.x = x.data();
+        batch.y = y.data();
+        batch.speed_x = speed_x.data();
+        batch.speed_y = speed_y.data();
+        batch.min_x = min_x.data();
+        batch.max_x = max_x.data();
+        batch.min_y = min_y.data();
+        batch.max_y = max_y.data();
+        batch.end_x = end_x.data();
+        batch.end_y = end_y.data();
+        batch.movement_duration = duration.data();
+        batch.road_end_met = road_end_met.data();
+        return batch;
+    }
+
+    std::vector<double> x, y, speed_x, speed_y, min_x, max_x, min_y, max_y;
+    std::vector<double> end_x, end_y, duration;
+    std::vector<uint8_t> road_end_met;
+};
+
+}  // namespace
+
+TEST_CASE("Vector movement kernels should give the same bits as the scalar one", "[simd]") {
+    std::mt19937 generator(7);
+    std::uniform_int_distribution<int> road_coordinate(0, 30);
+    std::uniform_int_distribution<int> road_length(0, 10);
+    std::uniform_real_distribution<double> fraction(0., 1.);
+    std::uniform_int_distribution<int> direction(0, 4);
+
+    //odd size checks the scalar tail after the vector loop
+    const size_t count = 1003;
+    MoveArrays arrays(count);
+    for (size_t i = 0; i < count; ++i) {
+        const double start = road_coordinate(generator);
+        const double end = start + road_length(generator);
+        const double line = road_coordinate(generator);
+        const double speed = i % 7 == 0 ? 0. : 0.001 * road_length(generator);
+        if (i % 2 == 0) {
+            //horizontal road
+            arrays.min_x[i] = start - 0.4;
+            arrays.max_x[i] = end + 0.4;
+            arrays.min_y[i] = line - 0.4;
+            arrays.max_y[i] = line + 0.4;
+            arrays.x[i] = start + fraction(generator) * (end - start);
+            arrays.y[i] = line;
+        } else {
+            //vertical road
+            arrays.min_x[i] = line - 0.4;
+            arrays.max_x[i] = line + 0.4;
+            arrays.min_y[i] = start - 0.4;
+            arrays.max_y[i] = end + 0.4;
+            arrays.x[i] = line;
+            arrays.y[i] = start + fraction(generator) * (end - start);
+        }
+        switch (direction(generator)) {
+            case 0: arrays.speed_x[i] = speed; break;
+            case 1: arrays.speed_x[i] = -speed; break;
+            case 2: arrays.speed_y[i] = speed; break;
+            case 3: arrays.speed_y[i] = -speed; break;
+            default: break;
+        }
+    }
+
+    MoveArrays scalar = arrays;
+    CalculateNewPositions(scalar.GetBatch(), 1000., EPSILON, InstructionSet::SCALAR);
+    for (auto instruction_set : {InstructionSet::SSE2, InstructionSet::AVX2}) {
+        MoveArrays vector = arrays;
+        CalculateNewPositions(vector.GetBatch(), 1000., EPSILON, instruction_set);
+        CHECK(SameBits(vector.end_x, scalar.end_x));
+        CHECK(SameBits(vector.end_y, scalar.end_y));
+        CHECK(SameBits(vector.duration, scalar.duration));
+        CHECK(vector.road_end_met == scalar.road_end_met);
+    }
+}
+
+TEST_CASE("Vector collection kernels should give the same bits as TryCollectPoint", "[simd]") {
+    std::mt19937 generator(11);
+    std::uniform_real_distribution<double> coordinate(-20., 20.);
+
+    const size_t count = 515;
+    std::vector<double> x(count), y(count);
+    for (size_t i = 0; i < count; ++i) {
+        x[i] = coordinate(generator);
+        y[i] = coordinate(generator);
+    }
+    const geom::Point2D a{1.5, -3.};
+    const geom::Point2D b{7.25, 4.};
+
+    std::vector<double> expected_sq_distance(count), expected_proj_ratio(count);
+    for (size_t i = 0; i < count; ++i) {
+        auto result = collision_detector::TryCollectPoint(a, b, {x[i], y[i]});
+        expected_sq_distance[i] = result.sq_distance;
+        expected_proj_ratio[i] = result.proj_ratio;
+    }
+
+    for (auto instruction_set : {InstructionSet::SCALAR, InstructionSet::SSE2, InstructionSet::AVX2}) {
+        std::vector<double> sq_distance(count), proj_ratio(count);
+        TryCollectPoints(a, b, count, x.data(), y.data(), sq_distance.data(), proj_ratio.data(), instruction_set);
+        CHECK(SameBits(sq_distance, expected_sq_distance));
+        CHECK(SameBits(proj_ratio, expected_proj_ratio));
+    }
+}
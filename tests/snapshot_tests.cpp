@@ -0,0 +1,185 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../src/model_serialization.h"
+#include "../src/snapshot.h"
+#include "../src/snapshot_saver.h"
+
+using namespace model;
+using namespace std::literals;
+
+namespace {
+
+Game MakeGame() {
+    Map map{Map::Id{"map"s}, "map"s};
+    for (int i = 0; i <= 20; i += 5) {
+        map.AddRoad(Road{Road::HORIZONTAL, Point{0, i}, 20});
+        map.AddRoad(Road{Road::VERTICAL, Point{i, 0}, 20});
+    }
+    map.SetLootNumber(3);
+    map.SetLootValues({1, 5, 10});
+    map.SetDefaultSpeed(0.004);
+    map.SetDefaultBagCapacity(3);
+    map.SetIdleTimeLimit(1e9);
+
+    Game game;
+    game.AddMap(map);
+    game.SetLootGenerator({500ms, 0.7});
+    game.SetPlayersStartPointRandomizing(true);
+    game.SetSessionSharding({4});
+    return game;
+}
+
+std::string DescribeGame(Game& game) {
+    std::ostringstream out;
+    out << std::setprecision(17);
+    for (const auto& [id, player] : game.GetPlayers()) {
+        out << id << ' ' << player->GetName() << ' ' << player->GetToken() << ' ' << player->GetSession()->GetId() << ' '
+            << player->GetCoordinates().x << ' ' << player->GetCoordinates().y << ' ' << player->GetSpeed().x << ' '
+            << player->GetSpeed().y << ' ' << static_cast<int>(player->GetDirection()) << ' ' << player->GetScore() << ' '
+            << player->GetIdleTime() << ' ' << player->GetTotalTime();
+        for (const Item& item : player->GetBag()) {
+            out << ' ' << item.id << ':' << item.type << ':' << item.value;
+        }
+        out << '\n';
+    }
+    for (const auto& [session_id, loot] : game.RetrieveLootForBackup()) {
+        for (const auto& [id, object] : loot) {
+            out << session_id << ' ' << id << ' ' << object.item.type << ' ' << object.coordinates.x << ' '
+                << object.coordinates.y << '\n';
+        }
+    }
+    return out.str();
+}
+
+Game MakePlayedGame() {
+    Game game = MakeGame();
+    const std::vector<std::string> moves = {"U"s, "R"s, "D"s, "L"s, ""s};
+    for (int i = 0; i < 10; ++i) {
+        auto player = game.JoinGame("dog"s + std::to_string(i % 3), game.FindMap(Map::Id{"map"s}));
+        player->Move(moves[i % moves.size()]);
+    }
+    for (int i = 0; i < 50; ++i) {
+        game.UpdateTime(100.);
+    }
+    return game;
+}
+
+}  // namespace
+
+TEST_CASE("Game restored from a snapshot is the same as the saved one") {
+    Game saved = MakePlayedGame();
+    const std::vector<char> snapshot = serialization::EncodeSnapshot(saved);
+    CHECK(serialization::IsSnapshot(snapshot));
+
+    Game restored = MakeGame();
+    serialization::DecodeSnapshot(snapshot, restored);
+    CHECK(DescribeGame(restored) == DescribeGame(saved));
+    CHECK(serialization::EncodeSnapshot(restored) == snapshot);
+
+    // a new player doesn't take the id of a restored one
+    auto player = restored.JoinGame("new"s, restored.FindMap(Map::Id{"map"s}));
+    CHECK(player->GetId() > saved.GetPlayers().rbegin()->first);
+}
+
+TEST_CASE("Sessions of a snapshot restored in parallel are the same as restored one by one") {
+    Game saved = MakePlayedGame();
+    const std::vector<char> snapshot = serialization::EncodeSnapshot(saved);
+
+    util::WorkStealingPool pool{4};
+    Game in_parallel = MakeGame();
+    in_parallel.SetRandomSeed(1);
+    serialization::RestoreState(serialization::DecodeSnapshot(snapshot, &pool), in_parallel, &pool);
+    CHECK(DescribeGame(in_parallel) == DescribeGame(saved));
+    CHECK(serialization::EncodeSnapshot(in_parallel) == snapshot);
+
+    // the roads under the dogs are found for all of them at once, the games go on the same way
+    Game one_by_one = MakeGame();
+    one_by_one.SetRandomSeed(1);
+    serialization::RestoreState(serialization::DecodeSnapshot(snapshot), one_by_one);
+    for (int i = 0; i < 30; ++i) {
+        in_parallel.UpdateTime(100.);
+        one_by_one.UpdateTime(100.);
+    }
+    CHECK(DescribeGame(in_parallel) == DescribeGame(one_by_one));
+}
+
+TEST_CASE("RestoreGameState reads both the snapshot file and the text archive") {
+    const std::string path = (std::filesystem::temp_directory_path() / "game_snapshot_test"s).string();
+    Game saved = MakePlayedGame();
+    const std::string expected = DescribeGame(saved);
+
+    serialization::SaveGameStateInFile(path, saved);
+    CHECK(serialization::IsSnapshotFile(path));
+    Game from_snapshot = MakeGame();
+    const serialization::RestoreStats stats = serialization::RestoreGameState(path, from_snapshot);
+    CHECK(DescribeGame(from_snapshot) == expected);
+    CHECK(stats.players == saved.GetPlayers().size());
+    CHECK(stats.sessions == saved.GetSessions().size());
+
+    serialization::SaveGameStateInTextFile(path, saved);
+    CHECK_FALSE(serialization::IsSnapshotFile(path));
+    Game from_text = MakeGame();
+    serialization::RestoreGameState(path, from_text);
+    CHECK(DescribeGame(from_text) == expected);
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Broken snapshots are rejected") {
+    Game saved = MakePlayedGame();
+    std::vector<char> snapshot = serialization::EncodeSnapshot(saved);
+
+    Game game = MakeGame();
+    CHECK_THROWS_AS(serialization::DecodeSnapshot(std::span{snapshot}.first(snapshot.size() - 1), game),
+                    serialization::SnapshotError);
+
+    snapshot[4] = 99;
+    CHECK_THROWS_AS(serialization::DecodeSnapshot(snapshot, game), serialization::SnapshotError);
+    CHECK(game.GetPlayers().empty());
+}
+
+TEST_CASE("Snapshot saver writes the newest of the snapshots queued while it was busy") {
+    const std::string path = (std::filesystem::temp_directory_path() / "game_snapshot_saver_test"s).string();
+    Game game = MakePlayedGame();
+    const std::vector<char> snapshot = serialization::EncodeSnapshot(game);
+
+    constexpr size_t SAVES = 20;
+    {
+        serialization::SnapshotSaver saver{path};
+        for (size_t i = 0; i < SAVES; ++i) {
+            saver.Save(snapshot);
+        }
+        game.UpdateTime(100.);
+        saver.Save(serialization::EncodeSnapshot(game));
+        saver.Wait();
+        CHECK_FALSE(saver.IsBusy());
+        const serialization::SnapshotSaver::Stats stats = saver.GetStats();
+        CHECK(stats.written + stats.coalesced == SAVES + 1);
+        CHECK(stats.written >= 1);
+        CHECK(stats.failed == 0);
+    }
+
+    std::ifstream file{path, std::ios::binary};
+    const std::vector<char> written{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    CHECK(written == serialization::EncodeSnapshot(game));
+    std::filesystem::remove(path);
+
+    size_t errors = 0;
+    {
+        serialization::SnapshotSaver saver{"/nonexistent/dir/state"s, [&errors](const std::exception&) {
+            ++errors;
+        }};
+        saver.Save(snapshot);
+        saver.Wait();
+        CHECK(saver.GetStats().failed == 1);
+    }
+    CHECK(errors == 1);
+}
@@ -0,0 +1,53 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "../src/thread_pool.h"
+
+using namespace util;
+
+TEST_CASE("ParallelFor runs every task exactly once") {
+    WorkStealingPool pool{4};
+    CHECK(pool.GetThreadsCount() == 4);
+
+    // several rounds reuse the same threads
+    for (size_t tasks_count : {0, 1, 3, 4, 17, 1000}) {
+        std::vector<std::atomic<int>> runs(tasks_count);
+        pool.ParallelFor(tasks_count, [&runs](size_t i) {
+            ++runs[i];
+        });
+        for (size_t i = 0; i < tasks_count; ++i) {
+            CHECK(runs[i] == 1);
+        }
+    }
+}
+
+TEST_CASE("ParallelFor works without extra threads") {
+    WorkStealingPool pool{1};
+    std::vector<int> runs(10);
+    pool.ParallelFor(runs.size(), [&runs](size_t i) {
+        ++runs[i];
+    });
+    CHECK(runs == std::vector<int>(10, 1));
+}
+
+TEST_CASE("ParallelFor rethrows an exception of a task after all tasks finish") {
+    WorkStealingPool pool{3};
+    std::atomic<int> finished = 0;
+    CHECK_THROWS_AS(pool.ParallelFor(20, [&finished](size_t i) {
+        if (i == 7) {
+            throw std::runtime_error("task failed");
+        }
+        ++finished;
+    }), std::runtime_error);
+    CHECK(finished == 19);
+
+    // the pool is still usable
+    finished = 0;
+    pool.ParallelFor(5, [&finished](size_t) {
+        ++finished;
+    });
+    CHECK(finished == 5);
+}
@@ -0,0 +1,80 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <iterator>
+#include <optional>
+
+#include "../src/ticker.h"
+
+using namespace std::literals;
+
+namespace {
+
+constexpr FixedSteps::Clock::duration STEP = 16600us;
+
+}  // namespace
+
+TEST_CASE("Fixed steps accumulate the time shorter than a step") {
+    FixedSteps steps{STEP, 5};
+    std::optional<FixedSteps::Overrun> overrun;
+
+    CHECK(steps.Advance(10ms, overrun) == 0);
+    CHECK(steps.Advance(10ms, overrun) == 1);
+    CHECK(steps.GetAccumulated() == 3400us);
+    // 3.4 + 29.8 = 33.2 ms is two steps exactly
+    CHECK(steps.Advance(29800us, overrun) == 2);
+    CHECK(steps.GetAccumulated() == 0us);
+    CHECK_FALSE(overrun);
+
+    // the time is spent in steps of the same length however it comes
+    int made = 0;
+    for (int i = 0; i < 1660; ++i) {
+        made += steps.Advance(1ms, overrun);
+        CHECK_FALSE(overrun);
+    }
+    CHECK(made == 100);
+}
+
+TEST_CASE("Fixed steps make at most max substeps and report the dropped steps") {
+    FixedSteps steps{STEP, 3};
+    std::optional<FixedSteps::Overrun> overrun;
+
+    // 6 whole steps and 5 ms: 3 are made, 3 are dropped, the 5 ms are kept
+    CHECK(steps.Advance(6 * STEP + 5ms, overrun) == 3);
+    REQUIRE(overrun);
+    CHECK(overrun->substeps == 3);
+    CHECK(overrun->dropped_steps == 3);
+    CHECK(std::abs(overrun->dropped_time - 49.8) < 1e-9);
+    CHECK(steps.GetAccumulated() == 5ms);
+
+    // the steps go on in phase with the kept time
+    CHECK(steps.Advance(STEP - 5ms, overrun) == 1);
+    CHECK_FALSE(overrun);
+    CHECK(steps.Advance(3 * STEP, overrun) == 3);
+    CHECK_FALSE(overrun);
+}
+
+TEST_CASE("Fixed steps make at least one substep") {
+    FixedSteps steps{STEP, 0};
+    std::optional<FixedSteps::Overrun> overrun;
+    CHECK(steps.Advance(2 * STEP, overrun) == 1);
+    REQUIRE(overrun);
+    CHECK(overrun->dropped_steps == 1);
+}
+
+TEST_CASE("Max substeps and fixed step are read from the command line") {
+    const char* argv[] = {"game_server", "-c", "config.json", "-w", "static", "-t", "50",
+                          "--fixed-step", "16.6", "--max-substeps", "3"};
+    const auto args = ParseCommandLine(static_cast<int>(std::size(argv)), argv);
+    REQUIRE(args);
+    CHECK(args->fixed_step_specified);
+    CHECK(args->fixed_step == 16.6);
+    CHECK(args->max_substeps == 3);
+
+    const char* without_period[] = {"game_server", "-c", "config.json", "-w", "static", "--fixed-step", "16.6"};
+    CHECK_THROWS(ParseCommandLine(static_cast<int>(std::size(without_period)), without_period));
+}
@@ -0,0 +1,142 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "../src/timer_wheel.h"
+
+using namespace util;
+using namespace std::literals;
+
+TEST_CASE("Timer wheel fires timers when the clock passes their deadlines") {
+    TimerWheel<int> wheel;
+    std::vector<int> expired;
+
+    wheel.Schedule(1, 10.5);
+    wheel.Schedule(2, 300.);
+    wheel.Schedule(3, 70000.);
+    wheel.Schedule(4, 5.);
+    wheel.Cancel(4);
+    CHECK(wheel.Size() == 3);
+
+    wheel.Advance(10., expired);
+    CHECK(expired.empty());
+    wheel.Advance(10.5, expired);
+    CHECK(expired == std::vector<int>{1});
+
+    // a new deadline replaces the old one
+    wheel.Schedule(2, 20.);
+    expired.clear();
+    wheel.Advance(299., expired);
+    CHECK(expired == std::vector<int>{2});
+
+    expired.clear();
+    wheel.Advance(69999.9, expired);
+    CHECK(expired.empty());
+    wheel.Advance(1e6, expired);
+    CHECK(expired == std::vector<int>{3});
+    CHECK(wheel.Size() == 0);
+}
+
+TEST_CASE("Timer wheel keeps cancelled ids until they are removed") {
+    TimerWheel<int> wheel;
+    std::vector<int> expired;
+
+    wheel.Schedule(1, 5.);
+    wheel.Schedule(2, 5.);
+    wheel.Cancel(1);
+    wheel.Cancel(1);
+    CHECK_FALSE(wheel.IsScheduled(1));
+    CHECK(wheel.Size() == 1);
+
+    // a cancelled id is scheduled again, the removed one is forgotten
+    wheel.Schedule(1, 7.);
+    wheel.Remove(2);
+    wheel.Remove(3);
+    CHECK(wheel.IsScheduled(1));
+    CHECK_FALSE(wheel.IsScheduled(2));
+    CHECK(wheel.Size() == 1);
+
+    wheel.Advance(6., expired);
+    CHECK(expired.empty());
+    wheel.Advance(7., expired);
+    CHECK(expired == std::vector<int>{1});
+    CHECK(wheel.Size() == 0);
+}
+
+TEST_CASE("Timer wheel skips the empty slots when the clock moves far") {
+    TimerWheel<int> wheel;
+    std::vector<int> expired;
+
+    // a step through every slot would take hours for these deltas
+    const auto start = std::chrono::steady_clock::now();
+    wheel.Schedule(1, 5e11);
+    wheel.Schedule(2, 1e14);
+    wheel.Schedule(3, 1e14 + 0.5);
+    wheel.Advance(1e11, expired);
+    CHECK(expired.empty());
+    wheel.Advance(1e12, expired);
+    CHECK(expired == std::vector<int>{1});
+
+    // a timer of the current slot and one far ahead
+    wheel.Schedule(4, 1e12);
+    wheel.Schedule(5, 1e12 + 300.);
+    expired.clear();
+    wheel.Advance(1e14, expired);
+    std::sort(expired.begin(), expired.end());
+    CHECK(expired == std::vector<int>{2, 4, 5});
+    expired.clear();
+    wheel.Advance(1e15, expired);
+    CHECK(expired == std::vector<int>{3});
+    CHECK(wheel.Size() == 0);
+    CHECK(std::chrono::steady_clock::now() - start < 1s);
+}
+
+TEST_CASE("Timer wheel gives the same timers as a plain search") {
+    TimerWheel<int> wheel{1.};
+    std::map<int, double> deadlines;
+    std::mt19937 generator{11};
+    std::uniform_int_distribution<int> id_distribution{0, 300};
+    // deadlines up to far beyond the range of the levels
+    std::uniform_real_distribution<double> delay_distribution{0., 1.};
+    std::uniform_int_distribution<int> scale_distribution{0, 5};
+    const double scales[] = {1., 100., 1e4, 1e6, 1e8, 1e10};
+
+    double now = 0.;
+    for (int step = 0; step < 20000; ++step) {
+        const int id = id_distribution(generator);
+        if (step % 5 == 0) {
+            if (step % 10 == 0) {
+                wheel.Cancel(id);
+            } else {
+                wheel.Remove(id);
+            }
+            deadlines.erase(id);
+        } else {
+            const double deadline = now + delay_distribution(generator) * scales[scale_distribution(generator)];
+            wheel.Schedule(id, deadline);
+            deadlines[id] = deadline;
+        }
+
+        if (step % 3 == 0) {
+            now += delay_distribution(generator) * scales[scale_distribution(generator) / 2] * 3.;
+            std::vector<int> expired;
+            wheel.Advance(now, expired);
+            std::vector<int> expected;
+            for (auto it = deadlines.begin(); it != deadlines.end();) {
+                if (it->second <= now) {
+                    expected.push_back(it->first);
+                    it = deadlines.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            std::sort(expired.begin(), expired.end());
+            REQUIRE(expired == expected);
+            REQUIRE(wheel.Size() == deadlines.size());
+        }
+    }
+}